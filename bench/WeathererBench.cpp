@@ -0,0 +1,719 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "api/CropDataProcessor.hpp"
+#include "api/CropDatabase.hpp"
+#include "api/Endpoints.hpp"
+#include "api/EnsembleProcessor.hpp"
+#include "api/FlatWeatherReader.hpp"
+#include "api/PvDataProcessor.hpp"
+#include "api/PvHandler.hpp"
+#include "api/PvMetrics.hpp"
+#include "api/models/PvDayRecord.hpp"
+#include "tools/ReplayServer.hpp"
+#include "tools/SyntheticResponses.hpp"
+#include "util/ChunkOperator.hpp"
+#include "util/Date.hpp"
+#include "util/Geolocation.hpp"
+#include "util/QuantileSketch.hpp"
+#include "util/RequestArena.hpp"
+#include "util/SeriesCodec.hpp"
+#include "util/Statistics.hpp"
+
+namespace {
+// Bytes currently allocated through the global operator new.
+std::atomic<std::int64_t> live_heap_bytes{0};
+// Calls made to the global operator new.
+std::atomic<std::int64_t> heap_allocations{0};
+
+// Prefixed to every allocation to remember its size; keeps the default alignment.
+constexpr std::size_t kAllocationHeader = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* TrackedAllocate(const std::size_t size) {
+  auto* block = static_cast<std::byte*>(std::malloc(size + kAllocationHeader));
+  if (block == nullptr) {
+    throw std::bad_alloc{};
+  }
+  *reinterpret_cast<std::size_t*>(block) = size;
+  live_heap_bytes.fetch_add(static_cast<std::int64_t>(size),
+                            std::memory_order_relaxed);
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return block + kAllocationHeader;
+}
+
+void TrackedFree(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* block = static_cast<std::byte*>(ptr) - kAllocationHeader;
+  live_heap_bytes.fetch_sub(
+      static_cast<std::int64_t>(*reinterpret_cast<std::size_t*>(block)),
+      std::memory_order_relaxed);
+  std::free(block);
+}
+}  // namespace
+
+void* operator new(const std::size_t size) { return TrackedAllocate(size); }
+void* operator new[](const std::size_t size) { return TrackedAllocate(size); }
+void operator delete(void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { TrackedFree(ptr); }
+
+namespace {
+using Json = nlohmann::json;
+using weatherer::util::Date;
+using weatherer::util::TimeFrame;
+
+// 2013-01-01T00:00:00Z, the first day of every synthetic series.
+constexpr std::time_t kSeriesStart = 1356998400;
+
+/**
+ * @brief A synthetic Open-Meteo PV response covering a number of days.
+ */
+struct WeatherSample {
+  std::string body;
+  Json json;
+  // The same response requested with format=flatbuffers.
+  std::string flat_body;
+  TimeFrame time_frame;
+};
+
+WeatherSample const& GetWeatherSample(const std::int64_t days) {
+  static std::map<std::int64_t, std::unique_ptr<WeatherSample>> samples{};
+  auto& sample = samples[days];
+  if (!sample) {
+    const Date start{kSeriesStart};
+    const Date end = start + (days - 1) * Date::kSecondsPerDay;
+    weatherer::tools::QueryParams params{
+        {"latitude", "34.050000"},
+        {"longitude", "-118.250000"},
+        {"daily", "sunrise"},
+        {"daily", "sunset"},
+        {"hourly", "temperature_2m"},
+        {"hourly", "cloud_cover"},
+        {"hourly", "wind_speed_10m"},
+        {"hourly", "shortwave_radiation"},
+        {"start_date", start.StripTime()},
+        {"end_date", end.StripTime()}};
+    std::string body =
+        weatherer::tools::SyntheticResponses::MakeWeatherResponse(params);
+    Json json = Json::parse(body);
+    params.emplace("format", "flatbuffers");
+    std::string flat_body =
+        weatherer::tools::SyntheticResponses::MakeWeatherResponse(params);
+    sample = std::make_unique<WeatherSample>(
+        WeatherSample{std::move(body), std::move(json), std::move(flat_body),
+                      TimeFrame{start, end}});
+  }
+  return *sample;
+}
+
+/**
+ * @brief Serves synthetic responses locally and points Weatherer at them.
+ */
+void UseOfflineEndpoints() {
+  static const auto server = [] {
+    weatherer::tools::ReplayServer::Options options{};
+    options.mode = weatherer::tools::ReplayServer::Mode::kSynthesize;
+    options.fixtures_dir = "bench_fixtures";
+    auto replay = std::make_unique<weatherer::tools::ReplayServer>(options);
+    replay->Start();
+    weatherer::Endpoints::SetBaseUrl(replay->GetBaseUrl());
+    return replay;
+  }();
+  benchmark::DoNotOptimize(server.get());
+}
+
+// Slices an hourly series into days, as OrganizeWeatherData does per series.
+void BM_SliceDays(benchmark::State& state) {
+  const auto days = static_cast<std::size_t>(state.range(0));
+  std::vector<std::int64_t> hourly_times(days * 24);
+  std::vector<std::int64_t> day_starts(days);
+  for (std::size_t i = 0; i < hourly_times.size(); ++i) {
+    hourly_times[i] = kSeriesStart + static_cast<std::int64_t>(i) * 3600;
+  }
+  for (std::size_t i = 0; i < days; ++i) {
+    day_starts[i] = kSeriesStart + static_cast<std::int64_t>(i) * 86400;
+  }
+  const std::vector<double> hourly(days * 24, 21.5);
+  for (auto _ : state) {
+    const auto boundaries = weatherer::util::DayBoundaries::FromTimestamps(
+        hourly_times, day_starts);
+    for (const auto day : boundaries.SliceAll<double>(hourly)) {
+      benchmark::DoNotOptimize(day.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * hourly.size());
+}
+BENCHMARK(BM_SliceDays)->Arg(1)->Arg(365)->Arg(3650);
+
+// Reductions over a multi-year hourly series (arg: samples).
+std::vector<double> const& GetSeries(const std::size_t size) {
+  static std::map<std::size_t, std::vector<double>> series{};
+  auto& values = series[size];
+  if (values.empty()) {
+    values.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      values[i] = 15.0 + 10.0 * std::sin(static_cast<double>(i) * 0.2618);
+    }
+  }
+  return values;
+}
+
+void BM_StatisticsSum(benchmark::State& state) {
+  const std::span<const double> values =
+      GetSeries(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(weatherer::util::Statistics::Sum(values));
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_StatisticsSum)->Arg(24)->Arg(24 * 365)->Arg(24 * 3650);
+
+void BM_StatisticsMin(benchmark::State& state) {
+  const std::span<const double> values =
+      GetSeries(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(weatherer::util::Statistics::Min(values));
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_StatisticsMin)->Arg(24)->Arg(24 * 365)->Arg(24 * 3650);
+
+void BM_RunningMoments(benchmark::State& state) {
+  const std::span<const double> values =
+      GetSeries(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    weatherer::util::RunningMoments moments{};
+    moments.Add(values);
+    benchmark::DoNotOptimize(moments.GetVariance());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_RunningMoments)->Arg(24 * 3650);
+
+void BM_QuantileSketch(benchmark::State& state) {
+  const std::span<const double> values =
+      GetSeries(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    weatherer::util::QuantileSketch sketch{};
+    sketch.Add(values);
+    benchmark::DoNotOptimize(sketch.GetQuantile(0.9));
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_QuantileSketch)->Arg(24 * 3650);
+
+// Decoding of a multi-year temperature series stored at 0.1 degree precision.
+void BM_SeriesCodecDecode(benchmark::State& state) {
+  const std::span<const double> values =
+      GetSeries(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::byte> encoded{};
+  weatherer::util::SeriesCodec::Encode(values, 10.0, encoded);
+  std::vector<double> decoded(values.size());
+  for (auto _ : state) {
+    weatherer::util::SeriesCodec::Decode(encoded, 10.0, decoded);
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  state.SetBytesProcessed(state.iterations() * decoded.size() * sizeof(double));
+  state.counters["encoded_bytes"] = static_cast<double>(encoded.size());
+}
+BENCHMARK(BM_SeriesCodecDecode)->Arg(24)->Arg(24 * 3650);
+
+void BM_SplitString(benchmark::State& state) {
+  std::string plants{};
+  for (int i = 0; i < state.range(0); ++i) {
+    plants += (i == 0 ? "" : ";") + std::string{"Plant "} + std::to_string(i);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(weatherer::util::SplitString(plants, ";"));
+  }
+}
+BENCHMARK(BM_SplitString)->Arg(4)->Arg(64);
+
+void BM_DateParse(benchmark::State& state) {
+  const std::string date{"2023-07-01T12:30"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Date{date});
+  }
+}
+BENCHMARK(BM_DateParse);
+
+void BM_DateToString(benchmark::State& state) {
+  const Date date{kSeriesStart};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(date.ToString());
+  }
+}
+BENCHMARK(BM_DateToString);
+
+void BM_DateStripTime(benchmark::State& state) {
+  const Date date{kSeriesStart};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(date.StripTime());
+  }
+}
+BENCHMARK(BM_DateStripTime);
+
+void BM_ParseWeatherResponse(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Json::parse(sample.body));
+  }
+  state.SetBytesProcessed(state.iterations() * sample.body.size());
+}
+BENCHMARK(BM_ParseWeatherResponse)
+    ->Arg(1)->Arg(7)->Arg(31)->Arg(365)->Arg(3650)
+    ->Unit(benchmark::kMicrosecond);
+
+// Organizes a response as one request would, optionally inside a request arena.
+void BM_OrganizeWeatherData(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(state.range(0));
+  const bool use_arena = state.range(1) != 0;
+  const std::int64_t allocations_before = heap_allocations.load();
+  for (auto _ : state) {
+    std::optional<weatherer::util::RequestArena> arena{};
+    if (use_arena) {
+      arena.emplace();
+    }
+    benchmark::DoNotOptimize(weatherer::PvDataProcessor::OrganizeWeatherData(
+        sample.json, sample.time_frame));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["allocations_per_day"] = benchmark::Counter(
+      static_cast<double>(heap_allocations.load() - allocations_before) /
+      static_cast<double>(state.iterations() * state.range(0)));
+}
+BENCHMARK(BM_OrganizeWeatherData)
+    ->ArgNames({"days", "arena"})
+    ->ArgsProduct({{1, 7, 31, 365, 3650}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Turns a response body into a collection, as CollectBatchData does. Format 0
+// parses the JSON body; format 1 reads the FlatBuffers body in place.
+void BM_IngestWeatherBody(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(state.range(0));
+  const bool flat = state.range(1) != 0;
+  const std::string& body = flat ? sample.flat_body : sample.body;
+  for (auto _ : state) {
+    const weatherer::util::RequestArena arena{};
+    if (flat) {
+      const auto locations =
+          weatherer::FlatWeatherReader::Parse(std::as_bytes(std::span{body}));
+      benchmark::DoNotOptimize(weatherer::PvDataProcessor::OrganizeWeatherData(
+          locations.front(), sample.time_frame));
+    } else {
+      benchmark::DoNotOptimize(weatherer::PvDataProcessor::OrganizeWeatherData(
+          Json::parse(body), sample.time_frame));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(body.size()));
+}
+BENCHMARK(BM_IngestWeatherBody)
+    ->ArgNames({"days", "format"})
+    ->ArgsProduct({{1, 31, 365, 3650}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_CalculateDailyEnergyYeild(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(31);
+  const auto collection = weatherer::PvDataProcessor::OrganizeWeatherData(
+      sample.json, sample.time_frame);
+  const weatherer::Coordinates coords{34.05, -118.25};
+  for (auto _ : state) {
+    double total = 0;
+    for (const auto& [date, pv_data] : *collection) {
+      total += weatherer::PvMetrics::CalculateDailyEnergyYeild(
+          *pv_data, coords, date, 0.2, 10.0);
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * collection->size());
+}
+BENCHMARK(BM_CalculateDailyEnergyYeild);
+
+// A month's yield out of ten years of days. Arg 0 sums the days of the month
+// from the collection; arg 1 asks the handler's yield rollup.
+void BM_QueryEnergyYeild(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(3650);
+  const weatherer::Coordinates coords{34.05, -118.25};
+  const weatherer::PvHandler handler{
+      coords, sample.time_frame,
+      weatherer::PvDataProcessor::OrganizeWeatherData(sample.json,
+                                                      sample.time_frame)};
+  const Date month_start = sample.time_frame.GetStartDate() +
+                           1800 * Date::kSecondsPerDay;
+  const TimeFrame month{month_start, month_start + 30 * Date::kSecondsPerDay};
+  const std::string first_day = month.GetStartDate().StripTime();
+  const std::string end_day = month.GetEndDate().StripTime();
+  const bool use_rollup = state.range(0) != 0;
+  if (use_rollup) {
+    benchmark::DoNotOptimize(handler.GetYieldRollup(0.2, 10.0));
+  }
+  for (auto _ : state) {
+    if (use_rollup) {
+      benchmark::DoNotOptimize(handler.QueryEnergyYeild(month, 0.2, 10.0));
+      continue;
+    }
+    double total = 0;
+    for (const auto& [date, pv_data] : *handler.GetPvCollection()) {
+      if (date >= first_day && date < end_day) {
+        total += weatherer::PvMetrics::CalculateDailyEnergyYeild(
+            *pv_data, coords, date, 0.2, 10.0);
+      }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_QueryEnergyYeild)->ArgName("rollup")->Arg(0)->Arg(1);
+
+void BM_CalculateDailyEnergyYeildRecord(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(31);
+  const auto collection = weatherer::PvDataProcessor::OrganizeWeatherData(
+      sample.json, sample.time_frame);
+  std::vector<weatherer::PvDayRecord> records{};
+  for (const auto& pv_data : *collection | std::views::values) {
+    records.push_back(weatherer::PvDayRecord::FromPvData(*pv_data));
+  }
+  const weatherer::Coordinates coords{34.05, -118.25};
+  for (auto _ : state) {
+    double total = 0;
+    for (const auto& record : records) {
+      total += weatherer::PvMetrics::CalculateDailyEnergyYeild(record, coords,
+                                                               0.2, 10.0);
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+}
+BENCHMARK(BM_CalculateDailyEnergyYeildRecord);
+
+// A month of ensemble forecast with the given number of members, drawn from
+// the synthetic ensemble and repeating its members past its own count.
+weatherer::EnsembleForecast const& GetEnsembleSample(const std::int64_t members) {
+  static std::map<std::int64_t, std::unique_ptr<weatherer::EnsembleForecast>>
+      samples{};
+  auto& sample = samples[members];
+  if (!sample) {
+    WeatherSample const& weather = GetWeatherSample(31);
+    const weatherer::tools::QueryParams params{
+        {"latitude", "34.050000"},
+        {"longitude", "-118.250000"},
+        {"hourly", "temperature_2m"},
+        {"hourly", "cloud_cover"},
+        {"hourly", "shortwave_radiation"},
+        {"start_date", weather.time_frame.GetStartDate().StripTime()},
+        {"end_date", weather.time_frame.GetEndDate().StripTime()}};
+    Json json = Json::parse(
+        weatherer::tools::SyntheticResponses::MakeEnsembleResponse(params));
+    const auto member_key = [](std::string const& variable,
+                               const std::int64_t member) {
+      char suffix[16];
+      std::snprintf(suffix, sizeof(suffix), "_member%02lld",
+                    static_cast<long long>(member));
+      return member == 0 ? variable : variable + suffix;
+    };
+    Json& hourly = json["hourly"];
+    constexpr auto kSynthetic = static_cast<std::int64_t>(
+        weatherer::tools::SyntheticResponses::kEnsembleMembers);
+    for (const std::string variable :
+         {"temperature_2m", "cloud_cover", "shortwave_radiation"}) {
+      for (std::int64_t m = 1; m < std::max(members, kSynthetic); ++m) {
+        if (m >= members) {
+          hourly.erase(member_key(variable, m));
+        } else if (m >= kSynthetic) {
+          hourly[member_key(variable, m)] =
+              hourly[member_key(variable, m % kSynthetic)];
+        }
+      }
+    }
+    const auto sun_times = weatherer::PvDataProcessor::OrganizeWeatherData(
+        weather.json, weather.time_frame);
+    sample = std::make_unique<weatherer::EnsembleForecast>(
+        *weatherer::EnsembleProcessor::OrganizeEnsembleData(
+            json, *sun_times, weather.time_frame));
+  }
+  return *sample;
+}
+
+// Yield distributions of a month of ensemble forecast. Arg shared 0 computes
+// every member as its own PvData day; 1 shares the per-day work between
+// members. Time should grow far slower than the member count with sharing.
+void BM_EnsembleYield(benchmark::State& state) {
+  weatherer::EnsembleForecast const& forecast =
+      GetEnsembleSample(state.range(0));
+  const bool shared = state.range(1) != 0;
+  const weatherer::Coordinates coords{34.05, -118.25};
+
+  std::vector<weatherer::PvData> days{};
+  if (!shared) {
+    for (std::size_t member = 0; member < forecast.GetMemberCount(); ++member) {
+      for (std::size_t day = 0; day < forecast.GetDayCount(); ++day) {
+        const auto hours = [&](std::span<const double> series) {
+          std::array<double, 24> values{};
+          std::ranges::copy(series.subspan(day * 24, 24), values.begin());
+          return values;
+        };
+        const auto& [date, sunrise, sunset] = forecast.GetDays()[day];
+        days.emplace_back(date, sunrise, sunset,
+                          hours(forecast.GetShortwaveRadiation(member)),
+                          hours(forecast.GetTemperature(member)),
+                          hours(forecast.GetCloudCoverTotal(member)),
+                          std::array<double, 24>{});
+      }
+    }
+  }
+
+  for (auto _ : state) {
+    if (shared) {
+      benchmark::DoNotOptimize(
+          weatherer::PvMetrics::CalculateEnsembleYeildDistribution(
+              forecast, coords, 0.2, 10.0));
+      continue;
+    }
+    std::vector<double> yields{};
+    yields.reserve(days.size());
+    for (const auto& pv_data : days) {
+      yields.push_back(weatherer::PvMetrics::CalculateDailyEnergyYeild(
+          pv_data, coords, pv_data.GetDate(), 0.2, 10.0));
+    }
+    benchmark::DoNotOptimize(yields);
+  }
+  state.SetItemsProcessed(state.iterations() * forecast.GetMemberCount() *
+                          forecast.GetDayCount());
+}
+BENCHMARK(BM_EnsembleYield)
+    ->ArgNames({"members", "shared"})
+    ->ArgsProduct({{1, 10, 50}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Heap held by ten years of organized days, as PvData collections (0) or
+// contiguous PvDayRecords (1).
+void BM_DayFootprint(benchmark::State& state) {
+  WeatherSample const& sample = GetWeatherSample(3650);
+  const bool compact = state.range(0) != 0;
+  std::int64_t footprint = 0;
+  std::size_t days = 0;
+  for (auto _ : state) {
+    const std::int64_t before = live_heap_bytes.load();
+    auto collection = weatherer::PvDataProcessor::OrganizeWeatherData(
+        sample.json, sample.time_frame);
+    days = collection->size();
+    if (!compact) {
+      footprint = live_heap_bytes.load() - before;
+      benchmark::DoNotOptimize(collection.get());
+      continue;
+    }
+
+    std::vector<weatherer::PvDayRecord> records{};
+    records.reserve(days);
+    for (const auto& pv_data : *collection | std::views::values) {
+      records.push_back(weatherer::PvDayRecord::FromPvData(*pv_data));
+    }
+    collection.reset();
+    footprint = live_heap_bytes.load() - before;
+    benchmark::DoNotOptimize(records.data());
+  }
+  state.counters["days"] = static_cast<double>(days);
+  state.counters["bytes_per_day"] =
+      days > 0 ? static_cast<double>(footprint) / static_cast<double>(days) : 0;
+}
+BENCHMARK(BM_DayFootprint)->ArgName("compact")->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CropDatabaseLoad(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(weatherer::CropDatabase::LoadDefault());
+  }
+}
+BENCHMARK(BM_CropDatabaseLoad)->Unit(benchmark::kMillisecond);
+
+// Collects and prints every crop, as a crop query does for its zone.
+void BM_CropCollection(benchmark::State& state) {
+  const auto database = weatherer::CropDatabase::GetDefault();
+  const std::vector<std::string> names = database->GetPlantsByZone(7);
+  std::ostringstream out{};
+  const std::int64_t allocations_before = heap_allocations.load();
+  for (auto _ : state) {
+    out.str({});
+    for (auto const& crop : *database->CollectData(names) | std::views::values) {
+      out << *crop;
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+  state.counters["allocations_per_crop"] = benchmark::Counter(
+      static_cast<double>(heap_allocations.load() - allocations_before) /
+      static_cast<double>(state.iterations() * names.size()));
+}
+BENCHMARK(BM_CropCollection)->Unit(benchmark::kMicrosecond);
+
+void BM_CropDataProcessorConstruction(benchmark::State& state) {
+  UseOfflineEndpoints();
+  const weatherer::util::LocationData location{
+      weatherer::Coordinates{40.75068, -73.99676}, "10001"};
+  for (auto _ : state) {
+    state.PauseTiming();
+    weatherer::CropDataProcessor::ClearWeatherCache();
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(weatherer::CropDataProcessor{location});
+  }
+}
+BENCHMARK(BM_CropDataProcessorConstruction)->Unit(benchmark::kMillisecond);
+
+// Address lookup, crop plantability and a month of PV yield, all served locally.
+// Arg 0 fetches the weather on every iteration, arg 1 answers from the caches,
+// as a long-running server does for repeated queries.
+void BM_EndToEndOffline(benchmark::State& state) {
+  UseOfflineEndpoints();
+  const bool warm = state.range(0) != 0;
+  Date end{};
+  end.ResetToMidnight();
+  const TimeFrame time_frame{end - 30 * Date::kSecondsPerDay, end};
+  for (auto _ : state) {
+    if (!warm) {
+      state.PauseTiming();
+      weatherer::CropDataProcessor::ClearWeatherCache();
+      weatherer::PvDataProcessor::ClearWeatherCache();
+      state.ResumeTiming();
+    }
+    const auto location = weatherer::util::Geolocation::GetLocationData(
+        "20 W 34th St, New York, NY 10001");
+    const weatherer::CropDataProcessor crops{location};
+    const weatherer::PvHandler pv{location.first, time_frame};
+    std::ostringstream output{};
+    pv.OutputDailyEnergyYeild(output, 0.2, 10.0);
+    benchmark::DoNotOptimize(crops.GetData());
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK(BM_EndToEndOffline)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Console reporter that also records the time per iteration of every run.
+ */
+class BaselineReporter : public benchmark::ConsoleReporter {
+ private:
+  std::map<std::string, double> nanoseconds_{};
+
+ public:
+  void ReportRuns(const std::vector<Run>& runs) override {
+    ConsoleReporter::ReportRuns(runs);
+    for (const Run& run : runs) {
+      if (run.run_type != Run::RT_Iteration) {
+        continue;
+      }
+      nanoseconds_[run.benchmark_name()] =
+          run.GetAdjustedRealTime() /
+          benchmark::GetTimeUnitMultiplier(run.time_unit) * 1e9;
+    }
+  }
+
+  [[nodiscard]] std::map<std::string, double> const& GetResults() const {
+    return nanoseconds_;
+  }
+};
+
+/**
+ * @brief Compares results against a stored baseline.
+ * @return The number of benchmarks slower than the baseline by more than threshold.
+ */
+int CompareWithBaseline(std::map<std::string, double> const& results,
+                        std::string const& baseline_path,
+                        const double threshold) {
+  std::ifstream file{baseline_path};
+  [[unlikely]] if (!file) {
+    std::cerr << "Cannot open baseline " << baseline_path << "\n";
+    return 1;
+  }
+  const Json baseline = Json::parse(file).at("benchmarks");
+
+  int regressions = 0;
+  std::cout << "\nComparison against " << baseline_path << " (threshold "
+            << threshold * 100 << "%)\n";
+  for (const auto& [name, nanoseconds] : results) {
+    if (!baseline.contains(name)) {
+      std::cout << "  NEW        " << name << "\n";
+      continue;
+    }
+    const double reference = baseline.at(name).get<double>();
+    const double change = (nanoseconds - reference) / reference;
+    const bool regressed = change > threshold;
+    regressions += regressed;
+    std::cout << (regressed ? "  REGRESSED  " : "  ok         ") << name << " "
+              << std::showpos << std::round(change * 1000) / 10 << "%"
+              << std::noshowpos << "\n";
+  }
+  return regressions;
+}
+
+void SaveBaseline(std::map<std::string, double> const& results,
+                  std::string const& baseline_path) {
+  std::ofstream{baseline_path} << Json{{"unit", "ns"}, {"benchmarks", results}}
+                                      .dump(2)
+                               << "\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string baseline_path{};
+  std::string save_path{};
+  double threshold = 0.10;
+
+  // Strip our own flags before handing the rest to Google Benchmark.
+  std::vector<char*> args{argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg.starts_with("--baseline=")) {
+      baseline_path = arg.substr(arg.find('=') + 1);
+    } else if (arg.starts_with("--save-baseline=")) {
+      save_path = arg.substr(arg.find('=') + 1);
+    } else if (arg.starts_with("--regression-threshold=")) {
+      threshold = std::stod(std::string{arg.substr(arg.find('=') + 1)});
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+
+  int bench_argc = static_cast<int>(args.size());
+  benchmark::Initialize(&bench_argc, args.data());
+  if (benchmark::ReportUnrecognizedArguments(bench_argc, args.data())) {
+    return 1;
+  }
+
+  BaselineReporter reporter{};
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+  benchmark::Shutdown();
+
+  if (!save_path.empty()) {
+    SaveBaseline(reporter.GetResults(), save_path);
+  }
+  if (!baseline_path.empty()) {
+    return CompareWithBaseline(reporter.GetResults(), baseline_path,
+                               threshold) > 0
+               ? 1
+               : 0;
+  }
+  return 0;
+}
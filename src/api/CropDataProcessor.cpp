@@ -1,81 +1,269 @@
 #include "CropDataProcessor.hpp"
 
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
 #include <nlohmann/json.hpp>
 #include <span>
 #include <unordered_map>
 
+#include "api/Endpoints.hpp"
 #include "util/ChunkOperator.hpp"
+#include "util/Date.hpp"
+#include "util/Http.hpp"
+#include "util/Metrics.hpp"
+#include "util/Statistics.hpp"
+#include "util/Trace.hpp"
 
-//TODO: Place with command line argument
-#ifndef WEATHERER_PLANT_JSON_DATABASE_
-#define WEATHERER_PLANT_JSON_DATABASE_
-#define CROP_DATABASE_PATH \
-  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\crop_database.json"
-#define PLANT_HARDNESS_DATABASE_PATH \
-  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\plant_zones.json"
-#define ZIPCODE_DATABASE_PATH \
-  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\zipcodes.json"
-#endif
+weatherer::util::SingleFlight<std::string, weatherer::CropWeatherJsonPtr>
+    weatherer::CropDataProcessor::weather_flights_{};
+
+weatherer::util::ExpiringCache<std::string, weatherer::CropWeatherJsonPtr>
+    weatherer::CropDataProcessor::weather_cache_{kWeatherCacheTtl_,
+                                                 kWeatherCacheCapacity_};
+
+const weatherer::util::SpatialGrid weatherer::CropDataProcessor::grid_{};
 
 weatherer::CropDataProcessor::CropDataProcessor(
-    util::LocationData const& location)
-    : crop_data_(std::make_unique<nlohmann::json>(
-          nlohmann::json::parse(std::ifstream{CROP_DATABASE_PATH}))),
-      zipcode_databse_(std::make_unique<nlohmann::json>(
-          nlohmann::json::parse(std::ifstream{ZIPCODE_DATABASE_PATH}))),
-      plant_zones_(std::make_unique<nlohmann::json>(
-          nlohmann::json::parse(std::ifstream{PLANT_HARDNESS_DATABASE_PATH}))) {
+    util::LocationData const& location,
+    std::shared_ptr<const CropDatabase> database)
+    : coordinates_(location.first), database_(std::move(database)) {
+  [[unlikely]] if (!database_) {
+    throw std::invalid_argument("Crop database must not be null");
+  }
 
   auto plants = GetPlantsByZone(GetHardnessZone(location.second));
-  const auto data = CollectData(plants);
-  this->data_ = data;
-  plantability_ = std::make_unique<std::unordered_map<std::string, bool>>(
-      IsWeatherSuitable(GetWeatherData(location.first), data));
+  auto evaluation = std::make_shared<Evaluation>();
+  evaluation->crops = std::move(*CollectData(plants));
+  Evaluate(*evaluation, *GetWeatherData(location.first));
+  evaluation_.Publish(std::move(evaluation));
+}
+
+void weatherer::CropDataProcessor::Refresh() {
+  // Fetch outside the update, which may run more than once.
+  const CropWeatherJsonPtr weather = GetWeatherData(coordinates_);
+  evaluation_.Update(
+      [&weather](Evaluation& evaluation) { Evaluate(evaluation, *weather); });
 }
 
-cpr::Response weatherer::CropDataProcessor::GetWeatherData(
-    Coordinates const& coords) {
-  cpr::Response response;
-  cpr::Parameters prams{};
-  prams.Add(cpr::Parameter{"longitude", std::to_string(coords.GetLongitude())});
-  prams.Add(cpr::Parameter{"latitude", std::to_string(coords.GetLatitude())});
-  prams.Add(cpr::Parameter{"hourly", "soil_temperature_18cm"});
-  prams.Add(cpr::Parameter{"daily", "temperature_2m_min"});
-  prams.Add(cpr::Parameter{"temperature_unit", "celsius"});
-  prams.Add(cpr::Parameter{"timeformat", "unixtime"});
-  prams.Add(cpr::Parameter{"timezone", "auto"});
-  prams.Add(cpr::Parameter{"forecast_days", "1"});
-
-  cpr::Response res = cpr::Get(cpr::Url{kApiUrl_}, prams);
-
-  if (res.status_code != 200) {
-    throw std::runtime_error("Failed to get weather data");
+void weatherer::CropDataProcessor::Evaluate(Evaluation& evaluation,
+                                            nlohmann::json const& json) {
+  evaluation.plantability = IsWeatherSuitable(json, evaluation.crops);
+  for (auto const& [crop_name, plantable] : evaluation.plantability) {
+    CropDataPtr& crop = evaluation.crops.at(crop_name);
+    if (crop->IsPlantable() != plantable) {
+      auto marked = std::make_shared<CropData>(*crop);
+      marked->SetPlantable(plantable);
+      crop = std::move(marked);
+    }
   }
+}
 
-  return res;
+weatherer::CropWeatherJsonPtr weatherer::CropDataProcessor::GetWeatherData(
+    Coordinates const& coords, const std::size_t forecast_days) {
+  return GetBatchWeatherData(std::span{&coords, 1}, kDefaultBatchSize,
+                             forecast_days)
+      .front();
 }
 
-std::unordered_map<std::string, bool>
-weatherer::CropDataProcessor::IsWeatherSuitable(cpr::Response const& res,
-                                                CropCollectionPtr const& data) {
-  using Json = nlohmann::json;
+std::vector<weatherer::CropWeatherJsonPtr>
+weatherer::CropDataProcessor::FetchWeatherData(
+    std::span<const Coordinates> coords, const std::size_t forecast_days) {
+  // Sites within the same grid cell share the request made at its center.
+  std::vector<Coordinates> snapped{};
+  snapped.reserve(coords.size());
+  for (auto const& coord : coords) {
+    snapped.push_back(grid_.SnapToCenter(coord));
+  }
+  const util::CoordinateList locations = util::JoinCoordinates(snapped);
+  // Every request differs only by location and horizon, so these identify it.
+  const std::string key = Endpoints::GetForecastUrl() + "|" +
+                          locations.latitudes + ";" + locations.longitudes +
+                          "|" + std::to_string(forecast_days);
+
+  // Requests beyond the executed fetches were coalesced into one in flight.
+  static util::Counter& requests = util::Metrics::GetCounter(
+      "weatherer_weather_requests_total",
+      "Weather data requests, including coalesced ones.", {{"source", "crop"}});
+  static util::Counter& fetches = util::Metrics::GetCounter(
+      "weatherer_weather_fetches_total",
+      "Weather data requests that reached the API.", {{"source", "crop"}});
+  static util::Counter& cache_hits = util::Metrics::GetCounter(
+      "weatherer_weather_cache_hits_total",
+      "Weather data requests answered from the response cache.",
+      {{"source", "crop"}});
+  requests.Increment();
+
+  CropWeatherJsonPtr response{};
+  if (auto cached = weather_cache_.Get(key)) {
+    cache_hits.Increment();
+    response = std::move(*cached);
+  } else {
+    response = weather_flights_.Do(key, [&] {
+      fetches.Increment();
+      util::TraceSpan span{"CropDataProcessor::FetchWeatherData"};
+      if (span.IsActive()) {
+        span.AddTag("locations", std::to_string(coords.size()));
+        span.AddTag("latitudes", locations.latitudes);
+        span.AddTag("longitudes", locations.longitudes);
+      }
+      cpr::Parameters prams{};
+      prams.Add(cpr::Parameter{"longitude", locations.longitudes});
+      prams.Add(cpr::Parameter{"latitude", locations.latitudes});
+      prams.Add(cpr::Parameter{"hourly", "soil_temperature_18cm"});
+      prams.Add(cpr::Parameter{"daily", "temperature_2m_min"});
+      prams.Add(cpr::Parameter{"temperature_unit", "celsius"});
+      prams.Add(cpr::Parameter{"timeformat", "unixtime"});
+      prams.Add(cpr::Parameter{"timezone", "auto"});
+      prams.Add(
+          cpr::Parameter{"forecast_days", std::to_string(forecast_days)});
+
+      const cpr::Response res =
+          util::Http::Get(Endpoints::GetForecastUrl(), prams);
+
+      if (res.status_code != 200) {
+        throw std::runtime_error("Failed to get weather data");
+      }
+
+      static util::Histogram& parse_duration = util::Metrics::GetHistogram(
+          "weatherer_weather_parse_duration_seconds",
+          "Time spent parsing weather API responses.", {{"source", "crop"}});
+      const util::ScopedTimer timer{parse_duration};
+      auto parsed = std::make_shared<const nlohmann::json>(
+          nlohmann::json::parse(res.text));
+      weather_cache_.Put(key, parsed);
+      return parsed;
+    });
+  }
+
+  // A single location yields an object, multiple locations an array of them.
+  const std::size_t location_count = response->is_array() ? response->size() : 1;
+  [[unlikely]] if (location_count != coords.size()) {
+    throw std::runtime_error(
+        "Expected " + std::to_string(coords.size()) +
+        " locations in the batched response, got " +
+        std::to_string(location_count));
+  }
+  if (!response->is_array()) {
+    return {response};
+  }
+  std::vector<CropWeatherJsonPtr> results{};
+  results.reserve(response->size());
+  for (auto const& location : *response) {
+    results.emplace_back(response, &location);
+  }
+  return results;
+}
+
+std::vector<weatherer::CropWeatherJsonPtr>
+weatherer::CropDataProcessor::GetBatchWeatherData(
+    std::span<const Coordinates> coords, const std::size_t max_batch_size,
+    const std::size_t forecast_days) {
+  std::vector<CropWeatherJsonPtr> results{};
+  results.reserve(coords.size());
+  for (const auto batch : util::ChunkCoordinates(coords, max_batch_size)) {
+    std::ranges::move(FetchWeatherData(batch, forecast_days),
+                      std::back_inserter(results));
+  }
+  return results;
+}
+
+weatherer::PlantingWindows weatherer::CropDataProcessor::GetPlantingWindows(
+    const std::size_t window_days) const {
+  util::TraceSpan span{"CropDataProcessor::GetPlantingWindows"};
+  return EvaluatePlantingWindows(
+      *GetWeatherData(coordinates_, kForecastHorizonDays),
+      evaluation_.Load()->crops, window_days);
+}
+
+weatherer::PlantingWindows weatherer::CropDataProcessor::EvaluatePlantingWindows(
+    nlohmann::json const& json, CropCollection const& data,
+    const std::size_t window_days) {
+  const auto& daily = json.at("daily");
+  const auto& hourly = json.at("hourly");
+  const auto day_starts = daily.at("time").get<std::vector<std::int64_t>>();
+  const auto air_temps =
+      daily.at("temperature_2m_min").get<std::vector<double>>();
+  const auto hourly_times = hourly.at("time").get<std::vector<std::int64_t>>();
+  const auto soil_temps =
+      hourly.at("soil_temperature_18cm").get<std::vector<double>>();
+  const auto boundaries =
+      util::DayBoundaries::FromTimestamps(hourly_times, day_starts);
+
+  // Reduce the hourly soil temperatures to one minimum per day. A day without
+  // samples can never qualify.
+  const std::size_t day_count =
+      std::min(boundaries.GetDayCount(), air_temps.size());
+  std::vector<double> soil_mins(day_count);
+  for (std::size_t day = 0; day < day_count; ++day) {
+    const std::span<const double> hours = boundaries.Slice<double>(soil_temps, day);
+    soil_mins[day] = hours.empty() ? -std::numeric_limits<double>::infinity()
+                                   : util::Statistics::Min(hours);
+  }
+
+  // Day i can be planted if the coldest soil and air of days [i, i + window)
+  // clear the thresholds, so only the rolling minima matter.
+  const std::vector<double> soil_window =
+      util::Statistics::SlidingMin(std::span<const double>{soil_mins}, window_days);
+  const std::vector<double> air_window = util::Statistics::SlidingMin(
+      std::span<const double>{air_temps}.first(day_count), window_days);
+  const std::size_t candidate_days = soil_window.size();
+
+  PlantingWindows windows{};
+  windows.reserve(data.size());
+  std::vector<std::uint8_t> suitable(candidate_days);
+  for (auto const& [crop_name, crop_data] : data) {
+    const double pref_soil_temp = crop_data->GetPrefSoilTemp();
+    const double pref_air_temp = crop_data->GetPrefAirTemp();
+    // Branch free, so the pass over the days vectorizes.
+    for (std::size_t day = 0; day < candidate_days; ++day) {
+      suitable[day] = static_cast<std::uint8_t>(
+          (pref_soil_temp < soil_window[day]) & (pref_air_temp < air_window[day]));
+    }
+
+    const auto first = std::ranges::find(suitable, 1);
+    if (first == suitable.end()) {
+      windows.emplace(crop_name, std::nullopt);
+      continue;
+    }
+    const auto last = std::find(first, suitable.end(), 0);
+    const auto start = static_cast<std::size_t>(first - suitable.begin());
+    windows.emplace(
+        crop_name,
+        PlantingWindow{
+            util::Date{static_cast<std::time_t>(day_starts[start])}.StripTime(),
+            static_cast<std::size_t>(last - first)});
+  }
+  return windows;
+}
 
-  auto json = Json::parse(res.text);
+std::unordered_map<std::string, bool>
+weatherer::CropDataProcessor::IsWeatherSuitable(nlohmann::json const& json,
+                                                CropCollection const& data) {
   double min_air_tmep =
       json.at("daily").at("temperature_2m_min").at(0).get<double>();
-  const std::array<double, 23> soil_temps = json.at("hourly")
-                                                .at("soil_temperature_18cm")
-                                                .get<std::array<double, 23>>();
-  auto min_soil_temp_index = std::ranges::distance(
-      soil_temps.begin(),
-      std::ranges::min_element(soil_temps.begin(), soil_temps.end()));
+  // Today has 23, 24 or 25 hours depending on daylight saving transitions.
+  const auto& hourly = json.at("hourly");
+  const auto hourly_times = hourly.at("time").get<std::vector<std::int64_t>>();
+  const auto soil_temps =
+      hourly.at("soil_temperature_18cm").get<std::vector<double>>();
+  const auto boundaries = util::DayBoundaries::FromTimestamps(
+      hourly_times, json.at("daily").at("time").get<std::vector<std::int64_t>>());
+  [[unlikely]] if (boundaries.GetDayCount() == 0) {
+    throw std::runtime_error("Weather data has no days");
+  }
+  const std::span<const double> today =
+      boundaries.Slice<double>(soil_temps, 0);
+  [[unlikely]] if (today.empty()) {
+    throw std::runtime_error("Weather data has no soil temperatures");
+  }
+  const double min_soil_temp = util::Statistics::Min(today);
 
   std::unordered_map<std::string, bool> plantability = {};
-  for (auto const& [crop_name, crop_data] : *data) {
+  for (auto const& [crop_name, crop_data] : data) {
     const bool is_soil_temp_suitable =
-        crop_data->GetPrefSoilTemp() < soil_temps.at(min_soil_temp_index);
+        crop_data->GetPrefSoilTemp() < min_soil_temp;
     const bool is_air_temp_suitable =
         crop_data->GetPrefAirTemp() < min_air_tmep;
     plantability.emplace(crop_name,
@@ -86,87 +274,15 @@ weatherer::CropDataProcessor::IsWeatherSuitable(cpr::Response const& res,
 
 int weatherer::CropDataProcessor::GetHardnessZone(
     std::string const& zipcode) const {
-  [[unlikely]] if (zipcode_databse_->empty()) {
-    throw std::runtime_error("Zipcode database is empty");
-  }
-  std::cout << std::boolalpha;
-
-  auto& zone = zipcode_databse_->at(zipcode).at("zone");
-  [[unlikely]] if (zone.empty() || zone.is_null() ||
-                   !zone.is_number_integer()) {
-    throw std::runtime_error("Zipcode not found");
-  }
-
-  return zone.get<int>();
+  return database_->GetHardnessZone(zipcode);
 }
 
 std::vector<std::string> weatherer::CropDataProcessor::GetPlantsByZone(
     const int zone) const {
-  [[unlikely]] if (plant_zones_->empty()) {
-    throw std::runtime_error("Plant zone database is empty");
-  }
-
-  auto const& plants = plant_zones_->at(std::to_string(zone)).at("plants");
-
-  [[unlikely]] if (plants.empty() || plants.is_null() || !plants.is_string()) {
-    throw std::runtime_error("Plants not found");
-  }
-
-  return util::SplitString(plants.get<std::string>(), std::string_view{";"});
+  return database_->GetPlantsByZone(zone);
 }
 
 weatherer::CropCollectionPtr weatherer::CropDataProcessor::CollectData(
     std::span<std::string> data) const {
-  using namespace util;
-  using Json = nlohmann::json;
-
-  auto collection =
-      std::make_shared<std::unordered_map<std::string, CropDataPtr>>();
-
-  auto JsonIsNull = [](Json const& json) -> bool {
-    return json.empty() || json.is_null();
-  };
-
-  for (std::string const& crop : data) {
-    const CropDataPtr crop_data = std::make_shared<CropData>();
-    const auto json = crop_data_->at(crop);
-    auto const& species_name = json.at("Species Name");
-    auto const& pref_light_level = json.at("Pref. Light Exposure");
-    auto const& pref_soil_temp = json.at("Pref. Soil Temp C");
-    auto const& pref_air_temp = json.at("Pref. Air Temp C");
-    auto const& pref_soil_ph = json.at("Pref. Soil pH");
-    auto const& fun_facts = json.at("Fun Facts");
-
-    crop_data->SetName(crop);
-
-    if (!JsonIsNull(species_name)) {
-      crop_data->SetSpeciesName(species_name.get<std::string>());
-    }
-    if (!JsonIsNull(pref_light_level)) {
-      crop_data->SetPrefLightLevel(pref_light_level.get<std::string>());
-    }
-
-    if (!JsonIsNull(pref_soil_temp) && pref_soil_temp.is_number_integer()) {
-      crop_data->SetPrefSoilTemp(pref_soil_temp.get<int>());
-    }
-
-    if (!JsonIsNull(pref_air_temp) && pref_air_temp.is_number_integer()) {
-      crop_data->SetPrefAirTemp(pref_air_temp.get<int>());
-    }
-
-    if (!JsonIsNull(pref_soil_ph) && pref_soil_ph.is_string()) {
-      auto nums =
-          SplitString(pref_soil_ph.get<std::string>(), std::string_view{"-"});
-      crop_data->SetPrefSoilPh(
-          NumericRange{std::stod(nums.at(0)), std::stod(nums.at(1))});
-    }
-
-    if (!JsonIsNull(fun_facts)) {
-      crop_data->SetFunFacts(fun_facts.get<std::string>());
-    }
-
-    collection->emplace(crop, crop_data);
-  }
-
-  return collection;
+  return database_->CollectData(data);
 }
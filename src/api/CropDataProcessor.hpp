@@ -1,39 +1,117 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
 
 #include <cpr/cpr.h>
 
+#include "CropDatabase.hpp"
 #include "models/Coordinates.hpp"
 #include "models/CropData.hpp"
+#include "util/ExpiringCache.hpp"
 #include "util/Geolocation.hpp"
+#include "util/SingleFlight.hpp"
+#include "util/Snapshot.hpp"
+#include "util/SpatialGrid.hpp"
 
 namespace weatherer {
-using CropDataPtr = std::shared_ptr<CropData>;
-using CropCollectionPtr =
-    std::shared_ptr<std::unordered_map<std::string, CropDataPtr>>;
+using CropWeatherJsonPtr = std::shared_ptr<const nlohmann::json>;
 
+// The first forecast day from which a crop can be planted, and for how many
+// consecutive days that remains the case.
+struct PlantingWindow {
+  std::string start_date;
+  std::size_t days;
+};
+
+using PlantingWindows =
+    std::unordered_map<std::string, std::optional<PlantingWindow>>;
+
+// The crops of a location are published as immutable snapshots, so GetData
+// and GetPlantability may be called from any thread, also while Refresh runs.
 class CropDataProcessor {
  private:
-  std::unique_ptr<nlohmann::json> crop_data_;
-  std::unique_ptr<nlohmann::json> zipcode_databse_;
-  std::unique_ptr<nlohmann::json> plant_zones_;
-  CropCollectionPtr data_;
-  std::unique_ptr<std::unordered_map<std::string, bool>> plantability_;
+  // The crops, marked with their plantability, published together with it.
+  struct Evaluation {
+    CropCollection crops;
+    std::unordered_map<std::string, bool> plantability;
+  };
+
+  Coordinates coordinates_;
+  std::shared_ptr<const CropDatabase> database_;
+  util::Snapshot<Evaluation> evaluation_;
+
+  // Plantability follows today's forecast; a quarter of an hour keeps it close
+  // to the latest model run while zipcodes of one grid cell share a response.
+  static constexpr std::chrono::minutes kWeatherCacheTtl_{15};
+  static constexpr std::size_t kWeatherCacheCapacity_ = 4096;
 
-  static constexpr std::string_view kApiUrl_{
-      "https://api.open-meteo.com/v1/forecast"};
+  // Shares identical in-flight weather requests between concurrent processors.
+  static util::SingleFlight<std::string, CropWeatherJsonPtr> weather_flights_;
+  // Parsed short-range forecasts by request key, shared by every processor
+  // whose location snaps to the same grid cell until the entry expires.
+  static util::ExpiringCache<std::string, CropWeatherJsonPtr> weather_cache_;
+  // Snaps request locations onto the weather model grid.
+  static const util::SpatialGrid grid_;
 
  private:
-  [[nodiscard]] static cpr::Response GetWeatherData(Coordinates const& coords);
+  [[nodiscard]] static CropWeatherJsonPtr GetWeatherData(
+      Coordinates const& coords, std::size_t forecast_days = 1);
 
-  [[nodiscard]] static std::unordered_map<std::string, bool> IsWeatherSuitable(
-      cpr::Response const& res, CropCollectionPtr const& data);
+  // Issues a single multi-location request and splits the response per location.
+  [[nodiscard]] static std::vector<CropWeatherJsonPtr> FetchWeatherData(
+      std::span<const Coordinates> coords, std::size_t forecast_days);
+
+  // Marks each forecast day on which the minimum daily soil and air
+  // temperatures over the following window_days days clear a crop's
+  // thresholds, then reports the first such run per crop.
+  [[nodiscard]] static PlantingWindows EvaluatePlantingWindows(
+      nlohmann::json const& json, CropCollection const& data,
+      std::size_t window_days);
+
+  // Evaluates the crops against the first day of a crop weather response and
+  // replaces each with a copy marked with the result.
+  static void Evaluate(Evaluation& evaluation, nlohmann::json const& json);
 
  public:
-  explicit CropDataProcessor(util::LocationData const& location);
+  // Default number of locations packed into a single batched request.
+  static constexpr std::size_t kDefaultBatchSize = 50;
+  // The longest forecast Open-Meteo serves.
+  static constexpr std::size_t kForecastHorizonDays = 16;
+  // Days the temperatures must stay above a crop's thresholds after planting.
+  static constexpr std::size_t kDefaultPlantingWindowDays = 3;
+
+  // Evaluates the crops of the location's hardiness zone against today's
+  // weather. The databases are shared, so only the first processor loads them.
+  explicit CropDataProcessor(
+      util::LocationData const& location,
+      std::shared_ptr<const CropDatabase> database = CropDatabase::GetDefault());
+
+  // Fetches today's crop weather for many locations, packing up to
+  // max_batch_size of them into each Open-Meteo request. Returns one response
+  // per location, in the same order as coords.
+  [[nodiscard]] static std::vector<CropWeatherJsonPtr> GetBatchWeatherData(
+      std::span<const Coordinates> coords,
+      std::size_t max_batch_size = kDefaultBatchSize,
+      std::size_t forecast_days = 1);
+
+  // Evaluates crops against the first day of a crop weather response, as
+  // returned by GetBatchWeatherData.
+  [[nodiscard]] static std::unordered_map<std::string, bool> IsWeatherSuitable(
+      nlohmann::json const& json, CropCollection const& data);
+
+  // Re-evaluates the crops against the latest weather and publishes the result.
+  void Refresh();
+
+  // Finds, for every crop, when in the next kForecastHorizonDays days it
+  // becomes plantable: the first day whose following window_days days all
+  // keep the soil and air above its preferred temperatures, and how many
+  // consecutive days qualify. Crops that never qualify map to std::nullopt.
+  [[nodiscard]] PlantingWindows GetPlantingWindows(
+      std::size_t window_days = kDefaultPlantingWindowDays) const;
 
   [[nodiscard]] int GetHardnessZone(std::string const& zipcode) const;
   [[nodiscard]] std::vector<std::string> GetPlantsByZone(const int zone) const;
@@ -41,6 +119,27 @@ class CropDataProcessor {
       std::span<std::string> data) const;
 
 
-  [[nodiscard]] CropCollectionPtr GetData() const { return data_; }
+  // The current crops; a refresh publishes new ones instead of modifying them.
+  [[nodiscard]] CropSnapshot GetData() const {
+    const auto evaluation = evaluation_.Load();
+    return {evaluation, &evaluation->crops};
+  }
+
+  [[nodiscard]] std::shared_ptr<const std::unordered_map<std::string, bool>>
+  GetPlantability() const {
+    const auto evaluation = evaluation_.Load();
+    return {evaluation, &evaluation->plantability};
+  }
+
+  [[nodiscard]] static std::size_t GetFetchCount() {
+    return weather_flights_.GetExecutedCount();
+  }
+
+  [[nodiscard]] static std::size_t GetDeduplicatedFetchCount() {
+    return weather_flights_.GetDeduplicatedCount();
+  }
+
+  // Drops every cached weather response, forcing the next request to fetch.
+  static void ClearWeatherCache() { weather_cache_.Clear(); }
 };
 }  // namespace weatherer
\ No newline at end of file
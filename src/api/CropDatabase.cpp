@@ -0,0 +1,172 @@
+#include "CropDatabase.hpp"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+#include "util/ChunkOperator.hpp"
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+
+//TODO: Place with command line argument
+// The build defines these to the databases in the source tree.
+#ifndef CROP_DATABASE_PATH
+#define CROP_DATABASE_PATH \
+  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\crop_database.json"
+#endif
+#ifndef PLANT_HARDNESS_DATABASE_PATH
+#define PLANT_HARDNESS_DATABASE_PATH \
+  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\plant_zones.json"
+#endif
+#ifndef ZIPCODE_DATABASE_PATH
+#define ZIPCODE_DATABASE_PATH \
+  "C:\\Users\\OneCheetah\\VisualStudio\\Weatherer-2.0\\zipcodes.json"
+#endif
+
+namespace {
+std::unique_ptr<nlohmann::json> ParseDatabase(const char* span_name,
+                                              const char* database,
+                                              std::string const& path) {
+  weatherer::util::TraceSpan span{span_name};
+  const weatherer::util::ScopedTimer timer{
+      weatherer::util::Metrics::GetHistogram(
+          "weatherer_database_load_duration_seconds",
+          "Time spent loading and parsing a JSON database.",
+          {{"database", database}})};
+  if (span.IsActive()) {
+    span.AddTag("path", path);
+  }
+  return std::make_unique<nlohmann::json>(
+      nlohmann::json::parse(std::ifstream{path}));
+}
+}  // namespace
+
+weatherer::CropDatabase::CropDatabase(std::string const& crop_database_path,
+                                      std::string const& zipcode_database_path,
+                                      std::string const& plant_zones_path)
+    : crop_data_(ParseDatabase("CropDatabase::ParseCropDatabase", "crops",
+                               crop_database_path)),
+      zipcode_databse_(ParseDatabase("CropDatabase::ParseZipcodeDatabase",
+                                     "zipcodes", zipcode_database_path)),
+      plant_zones_(ParseDatabase("CropDatabase::ParsePlantZones",
+                                 "plant_zones", plant_zones_path)) {}
+
+weatherer::CropDatabase::~CropDatabase() = default;
+
+std::unique_ptr<weatherer::CropDatabase>
+weatherer::CropDatabase::LoadDefault() {
+  return std::make_unique<CropDatabase>(
+      CROP_DATABASE_PATH, ZIPCODE_DATABASE_PATH, PLANT_HARDNESS_DATABASE_PATH);
+}
+
+std::shared_ptr<const weatherer::CropDatabase>
+weatherer::CropDatabase::GetDefault() {
+  static const std::shared_ptr<const CropDatabase> database = LoadDefault();
+  return database;
+}
+
+int weatherer::CropDatabase::GetHardnessZone(std::string const& zipcode) const {
+  [[unlikely]] if (zipcode_databse_->empty()) {
+    throw std::runtime_error("Zipcode database is empty");
+  }
+
+  auto const& zone = zipcode_databse_->at(zipcode).at("zone");
+  [[unlikely]] if (zone.empty() || zone.is_null() ||
+                   !zone.is_number_integer()) {
+    throw std::runtime_error("Zipcode not found");
+  }
+
+  return zone.get<int>();
+}
+
+std::vector<std::string> weatherer::CropDatabase::GetPlantsByZone(
+    const int zone) const {
+  [[unlikely]] if (plant_zones_->empty()) {
+    throw std::runtime_error("Plant zone database is empty");
+  }
+
+  auto const& plants = plant_zones_->at(std::to_string(zone)).at("plants");
+
+  [[unlikely]] if (plants.empty() || plants.is_null() || !plants.is_string()) {
+    throw std::runtime_error("Plants not found");
+  }
+
+  return util::SplitString(plants.get<std::string>(), std::string_view{";"});
+}
+
+weatherer::CropCollectionPtr weatherer::CropDatabase::CollectData(
+    std::span<const std::string> data) const {
+  using namespace util;
+  using Json = nlohmann::json;
+
+  auto collection = std::make_shared<CropCollection>();
+
+  auto JsonIsNull = [](Json const& json) -> bool {
+    return json.empty() || json.is_null();
+  };
+
+  for (std::string const& crop : data) {
+    const auto crop_data = std::make_shared<CropData>();
+    auto const& json = crop_data_->at(crop);
+    auto const& species_name = json.at("Species Name");
+    auto const& pref_light_level = json.at("Pref. Light Exposure");
+    auto const& pref_soil_temp = json.at("Pref. Soil Temp C");
+    auto const& pref_air_temp = json.at("Pref. Air Temp C");
+    auto const& pref_soil_ph = json.at("Pref. Soil pH");
+    auto const& fun_facts = json.at("Fun Facts");
+
+    crop_data->SetName(crop);
+
+    if (!JsonIsNull(species_name)) {
+      crop_data->SetSpeciesName(species_name.get_ref<std::string const&>());
+    }
+    if (!JsonIsNull(pref_light_level)) {
+      crop_data->SetPrefLightLevel(
+          ParseLightLevel(pref_light_level.get_ref<std::string const&>()));
+    }
+
+    if (!JsonIsNull(pref_soil_temp) && pref_soil_temp.is_number_integer()) {
+      crop_data->SetPrefSoilTemp(pref_soil_temp.get<int>());
+    }
+
+    if (!JsonIsNull(pref_air_temp) && pref_air_temp.is_number_integer()) {
+      crop_data->SetPrefAirTemp(pref_air_temp.get<int>());
+    }
+
+    if (!JsonIsNull(pref_soil_ph) && pref_soil_ph.is_string()) {
+      auto nums =
+          SplitString(pref_soil_ph.get<std::string>(), std::string_view{"-"});
+      crop_data->SetPrefSoilPh(
+          NumericRange{std::stod(nums.at(0)), std::stod(nums.at(1))});
+    }
+
+    if (!JsonIsNull(fun_facts) && fun_facts.is_string()) {
+      // Share the text with the database instead of copying it.
+      crop_data->SetFunFacts(std::shared_ptr<const std::string>{
+          crop_data_, &fun_facts.get_ref<std::string const&>()});
+    }
+
+    collection->emplace(crop, crop_data);
+  }
+
+  return collection;
+}
+
+std::vector<std::string> weatherer::CropDatabase::GetZipcodes() const {
+  std::vector<std::string> zipcodes{};
+  zipcodes.reserve(zipcode_databse_->size());
+  // JSON objects keep their keys sorted.
+  for (auto const& [zipcode, entry] : zipcode_databse_->items()) {
+    zipcodes.push_back(zipcode);
+  }
+  return zipcodes;
+}
+
+std::vector<std::string> weatherer::CropDatabase::GetCropNames() const {
+  std::vector<std::string> names{};
+  names.reserve(crop_data_->size());
+  for (auto const& [name, entry] : crop_data_->items()) {
+    names.push_back(name);
+  }
+  return names;
+}
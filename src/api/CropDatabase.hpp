@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "models/CropData.hpp"
+
+namespace weatherer {
+using CropDataPtr = std::shared_ptr<const CropData>;
+using CropCollection = std::unordered_map<std::string, CropDataPtr>;
+using CropCollectionPtr = std::shared_ptr<CropCollection>;
+// A published collection, never modified again; see util::Snapshot.
+using CropSnapshot = std::shared_ptr<const CropCollection>;
+
+/**
+ * @brief The crop, plant hardiness zone and zipcode databases.
+ *
+ * Parsing the databases dominates the start-up cost of a crop query, so they are
+ * loaded once and shared, read-only, by every CropDataProcessor. All member
+ * functions are safe to call concurrently.
+ */
+class CropDatabase {
+ private:
+  // Shared with the crops collected from it, which view their fun facts in it.
+  std::shared_ptr<const nlohmann::json> crop_data_;
+  std::unique_ptr<nlohmann::json> zipcode_databse_;
+  std::unique_ptr<nlohmann::json> plant_zones_;
+
+ public:
+  /**
+   * @brief Loads the databases from disk.
+   * @param crop_database_path The path of crop_database.json.
+   * @param zipcode_database_path The path of zipcodes.json.
+   * @param plant_zones_path The path of plant_zones.json.
+   * @throws nlohmann::json::parse_error if a database cannot be read.
+   */
+  explicit CropDatabase(std::string const& crop_database_path,
+                        std::string const& zipcode_database_path,
+                        std::string const& plant_zones_path);
+  ~CropDatabase();
+  CropDatabase(const CropDatabase& other) = delete;
+  CropDatabase& operator=(const CropDatabase& other) = delete;
+
+  /**
+   * @brief Loads a fresh copy of the databases shipped with Weatherer.
+   * @return The loaded databases.
+   */
+  [[nodiscard]] static std::unique_ptr<CropDatabase> LoadDefault();
+
+  /**
+   * @brief Gets the databases shipped with Weatherer, loading them on first use.
+   * @return The shared databases.
+   */
+  [[nodiscard]] static std::shared_ptr<const CropDatabase> GetDefault();
+
+  [[nodiscard]] int GetHardnessZone(std::string const& zipcode) const;
+  [[nodiscard]] std::vector<std::string> GetPlantsByZone(const int zone) const;
+  [[nodiscard]] CropCollectionPtr CollectData(
+      std::span<const std::string> data) const;
+
+  /**
+   * @return Every zipcode of the zipcode database, in ascending order.
+   */
+  [[nodiscard]] std::vector<std::string> GetZipcodes() const;
+
+  /**
+   * @return The name of every crop of the crop database, in ascending order.
+   */
+  [[nodiscard]] std::vector<std::string> GetCropNames() const;
+};
+}  // namespace weatherer
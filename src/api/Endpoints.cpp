@@ -0,0 +1,104 @@
+#include "Endpoints.hpp"
+
+#include <cstdlib>
+
+std::mutex weatherer::Endpoints::mutex_{};
+bool weatherer::Endpoints::initialized_ = false;
+std::string weatherer::Endpoints::forecast_url_ =
+    std::string{kDefaultForecastHost} + std::string{kForecastPath};
+std::string weatherer::Endpoints::historical_url_ =
+    std::string{kDefaultHistoricalHost} + std::string{kHistoricalPath};
+std::string weatherer::Endpoints::ensemble_url_ =
+    std::string{kDefaultEnsembleHost} + std::string{kEnsemblePath};
+std::string weatherer::Endpoints::geocoder_url_ =
+    std::string{kDefaultGeocoderHost} + std::string{kGeocoderPath};
+
+void weatherer::Endpoints::InitializeFromEnvironment() {
+  if (initialized_) {
+    return;
+  }
+  initialized_ = true;
+
+  const auto read_env = [](const char* name) -> std::string {
+    const char* value = std::getenv(name);
+    return value != nullptr ? std::string{value} : std::string{};
+  };
+
+  if (const std::string base = read_env("WEATHERER_API_BASE_URL");
+      !base.empty()) {
+    forecast_url_ = base + std::string{kForecastPath};
+    historical_url_ = base + std::string{kHistoricalPath};
+    ensemble_url_ = base + std::string{kEnsemblePath};
+    geocoder_url_ = base + std::string{kGeocoderPath};
+  }
+  if (std::string url = read_env("WEATHERER_FORECAST_URL"); !url.empty()) {
+    forecast_url_ = std::move(url);
+  }
+  if (std::string url = read_env("WEATHERER_HISTORICAL_URL"); !url.empty()) {
+    historical_url_ = std::move(url);
+  }
+  if (std::string url = read_env("WEATHERER_ENSEMBLE_URL"); !url.empty()) {
+    ensemble_url_ = std::move(url);
+  }
+  if (std::string url = read_env("WEATHERER_GEOCODER_URL"); !url.empty()) {
+    geocoder_url_ = std::move(url);
+  }
+}
+
+std::string weatherer::Endpoints::GetForecastUrl() {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  return forecast_url_;
+}
+
+std::string weatherer::Endpoints::GetHistoricalUrl() {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  return historical_url_;
+}
+
+std::string weatherer::Endpoints::GetEnsembleUrl() {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  return ensemble_url_;
+}
+
+std::string weatherer::Endpoints::GetGeocoderUrl() {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  return geocoder_url_;
+}
+
+void weatherer::Endpoints::SetForecastUrl(std::string url) {
+  std::lock_guard lock{mutex_};
+  // Explicit settings win over the environment.
+  InitializeFromEnvironment();
+  forecast_url_ = std::move(url);
+}
+
+void weatherer::Endpoints::SetHistoricalUrl(std::string url) {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  historical_url_ = std::move(url);
+}
+
+void weatherer::Endpoints::SetEnsembleUrl(std::string url) {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  ensemble_url_ = std::move(url);
+}
+
+void weatherer::Endpoints::SetGeocoderUrl(std::string url) {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  geocoder_url_ = std::move(url);
+}
+
+void weatherer::Endpoints::SetBaseUrl(const std::string_view base_url) {
+  std::lock_guard lock{mutex_};
+  InitializeFromEnvironment();
+  forecast_url_ = std::string{base_url} + std::string{kForecastPath};
+  historical_url_ = std::string{base_url} + std::string{kHistoricalPath};
+  ensemble_url_ = std::string{base_url} + std::string{kEnsemblePath};
+  geocoder_url_ = std::string{base_url} + std::string{kGeocoderPath};
+}
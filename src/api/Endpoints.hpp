@@ -0,0 +1,83 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace weatherer {
+/**
+ * @brief Process-wide configuration of the remote services Weatherer talks to.
+ *
+ * Every endpoint defaults to the public service. The defaults can be replaced at
+ * runtime, or through environment variables read on first use:
+ * - WEATHERER_API_BASE_URL points every endpoint at a single host (for example a
+ *   local replay server), keeping the public services' paths.
+ * - WEATHERER_FORECAST_URL, WEATHERER_HISTORICAL_URL, WEATHERER_ENSEMBLE_URL and
+ *   WEATHERER_GEOCODER_URL override a single endpoint and take precedence over the
+ *   base URL.
+ */
+class Endpoints {
+ private:
+  static std::mutex mutex_;
+  static bool initialized_;
+  static std::string forecast_url_;
+  static std::string historical_url_;
+  static std::string ensemble_url_;
+  static std::string geocoder_url_;
+
+  /**
+   * @brief Applies the environment overrides once. Expects mutex_ to be held.
+   */
+  static void InitializeFromEnvironment();
+
+ public:
+  static constexpr std::string_view kForecastPath{"/v1/forecast"};
+  static constexpr std::string_view kHistoricalPath{"/v1/archive"};
+  static constexpr std::string_view kEnsemblePath{"/v1/ensemble"};
+  static constexpr std::string_view kGeocoderPath{
+      "/geocoder/locations/onelineaddress"};
+
+  static constexpr std::string_view kDefaultForecastHost{
+      "https://api.open-meteo.com"};
+  static constexpr std::string_view kDefaultHistoricalHost{
+      "https://archive-api.open-meteo.com"};
+  static constexpr std::string_view kDefaultEnsembleHost{
+      "https://ensemble-api.open-meteo.com"};
+  static constexpr std::string_view kDefaultGeocoderHost{
+      "https://geocoding.geo.census.gov"};
+
+  // Prevent instantiation of the Endpoints class.
+  Endpoints() = delete;
+  ~Endpoints() = delete;
+
+  /**
+   * @return The URL of the Open-Meteo forecast API.
+   */
+  [[nodiscard]] static std::string GetForecastUrl();
+
+  /**
+   * @return The URL of the Open-Meteo historical archive API.
+   */
+  [[nodiscard]] static std::string GetHistoricalUrl();
+
+  /**
+   * @return The URL of the Open-Meteo ensemble forecast API.
+   */
+  [[nodiscard]] static std::string GetEnsembleUrl();
+
+  /**
+   * @return The URL of the Census one-line address geocoder.
+   */
+  [[nodiscard]] static std::string GetGeocoderUrl();
+
+  static void SetForecastUrl(std::string url);
+  static void SetHistoricalUrl(std::string url);
+  static void SetEnsembleUrl(std::string url);
+  static void SetGeocoderUrl(std::string url);
+
+  /**
+   * @brief Points every endpoint at the same host, keeping the services' paths.
+   * @param base_url The scheme, host and optional port (e.g. http://127.0.0.1:8080).
+   */
+  static void SetBaseUrl(std::string_view base_url);
+};
+}  // namespace weatherer
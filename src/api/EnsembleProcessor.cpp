@@ -0,0 +1,330 @@
+#include "EnsembleProcessor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <ranges>
+
+#include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
+
+#include "api/Endpoints.hpp"
+#include "util/ChunkOperator.hpp"
+#include "util/Http.hpp"
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+
+weatherer::util::SingleFlight<std::string, weatherer::WeatherJsonPtr>
+    weatherer::EnsembleProcessor::ensemble_flights_{};
+
+weatherer::util::ExpiringCache<std::string, weatherer::WeatherJsonPtr>
+    weatherer::EnsembleProcessor::ensemble_cache_{kEnsembleCacheTtl_,
+                                                  kEnsembleCacheCapacity_};
+
+const weatherer::util::SpatialGrid weatherer::EnsembleProcessor::grid_{};
+
+namespace {
+constexpr std::array<const char*, 3> kHourlyVariables{
+    "temperature_2m", "cloud_cover", "shortwave_radiation"};
+// Positions in kHourlyVariables.
+constexpr std::size_t kTemperature = 0;
+constexpr std::size_t kCloudCover = 1;
+constexpr std::size_t kShortwaveRadiation = 2;
+
+// The key of a member's series; the control run keeps the plain name.
+std::string GetMemberKey(const char* variable, const std::size_t member) {
+  if (member == 0) {
+    return variable;
+  }
+  char key[64];
+  std::snprintf(key, sizeof(key), "%s_member%02zu", variable, member);
+  return key;
+}
+
+// Appends a JSON array to a column; missing values (null) become NaN.
+void AppendSeries(nlohmann::json const& array, std::vector<double>& column) {
+  for (const auto& value : array) {
+    column.push_back(value.is_null() ? std::numeric_limits<double>::quiet_NaN()
+                                     : value.get<double>());
+  }
+}
+}  // namespace
+
+cpr::Response weatherer::EnsembleProcessor::IngestData(
+    std::span<const Coordinates> coords, util::TimeFrame const& time_frame,
+    const std::string_view model) {
+  const util::CoordinateList locations = util::JoinCoordinates(coords);
+  util::TraceSpan span{"EnsembleProcessor::IngestData"};
+  if (span.IsActive()) {
+    span.AddTag("locations", std::to_string(coords.size()));
+    span.AddTag("time_frame", time_frame.GetStartDate().StripTime() + "/" +
+                                  time_frame.GetEndDate().StripTime());
+    span.AddTag("model", std::string{model});
+  }
+
+  cpr::Parameters prams{};
+  prams.Add(cpr::Parameter{"longitude", locations.longitudes});
+  prams.Add(cpr::Parameter{"latitude", locations.latitudes});
+  for (const char* variable : kHourlyVariables) {
+    prams.Add(cpr::Parameter{"hourly", variable});
+  }
+  prams.Add(cpr::Parameter{"models", std::string{model}});
+  prams.Add(
+      cpr::Parameter{"start_date", time_frame.GetStartDate().StripTime()});
+  prams.Add(cpr::Parameter{"end_date", time_frame.GetEndDate().StripTime()});
+  prams.Add(cpr::Parameter{"temperature_unit", "celsius"});
+  prams.Add(cpr::Parameter{"timeformat", "unixtime"});
+  prams.Add(cpr::Parameter{"timezone", "auto"});
+
+  cpr::Response res = util::Http::Get(Endpoints::GetEnsembleUrl(), prams);
+  if (res.status_code != 200) {
+    throw std::runtime_error(
+        "An error has occurred whilst fetching HTTP data. Status code: " +
+        std::to_string(res.status_code));
+  }
+  return res;
+}
+
+std::string weatherer::EnsembleProcessor::MakeRequestKey(
+    std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+    const std::string_view model) {
+  const util::CoordinateList locations = util::JoinCoordinates(coords);
+  // Mirror the values sent to the API so that equal keys imply equal requests.
+  return Endpoints::GetEnsembleUrl() + "|" + locations.latitudes + ";" +
+         locations.longitudes + "|" + std::string{model} + "|" +
+         "temperature_2m,cloud_cover,shortwave_radiation|" +
+         time_frame.GetStartDate().StripTime() + "/" +
+         time_frame.GetEndDate().StripTime();
+}
+
+std::vector<weatherer::WeatherJsonPtr> weatherer::EnsembleProcessor::FetchData(
+    std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+    const std::string_view model) {
+  std::vector<Coordinates> snapped{};
+  snapped.reserve(coords.size());
+  std::ranges::transform(
+      coords, std::back_inserter(snapped),
+      [](Coordinates const& coord) { return grid_.SnapToCenter(coord); });
+
+  static util::Counter& requests = util::Metrics::GetCounter(
+      "weatherer_weather_requests_total",
+      "Weather data requests, including coalesced ones.",
+      {{"source", "ensemble"}});
+  static util::Counter& fetches = util::Metrics::GetCounter(
+      "weatherer_weather_fetches_total",
+      "Weather data requests that reached the API.", {{"source", "ensemble"}});
+  static util::Counter& cache_hits = util::Metrics::GetCounter(
+      "weatherer_weather_cache_hits_total",
+      "Weather data requests answered from the response cache.",
+      {{"source", "ensemble"}});
+  requests.Increment();
+
+  const std::string key = MakeRequestKey(snapped, time_frame, model);
+  WeatherJsonPtr response{};
+  if (auto cached = ensemble_cache_.Get(key)) {
+    cache_hits.Increment();
+    response = std::move(*cached);
+  } else {
+    response = ensemble_flights_.Do(key, [&] {
+      fetches.Increment();
+      const cpr::Response res = IngestData(snapped, time_frame, model);
+      util::TraceSpan span{"EnsembleProcessor::ParseEnsembleResponse"};
+      if (span.IsActive()) {
+        span.AddTag("bytes", std::to_string(res.text.size()));
+      }
+      static util::Histogram& parse_duration = util::Metrics::GetHistogram(
+          "weatherer_weather_parse_duration_seconds",
+          "Time spent parsing weather API responses.",
+          {{"source", "ensemble"}});
+      const util::ScopedTimer timer{parse_duration};
+      auto parsed = std::make_shared<const nlohmann::json>(
+          nlohmann::json::parse(res.text));
+      ensemble_cache_.Put(key, parsed);
+      return parsed;
+    });
+  }
+
+  // A single location yields an object, multiple locations an array of them.
+  const std::size_t location_count = response->is_array() ? response->size() : 1;
+  [[unlikely]] if (location_count != coords.size()) {
+    throw std::runtime_error(
+        "Expected " + std::to_string(coords.size()) +
+        " locations in the batched response, got " +
+        std::to_string(location_count));
+  }
+  if (!response->is_array()) {
+    return {response};
+  }
+
+  // Alias each location into the shared response to avoid copying it.
+  std::vector<WeatherJsonPtr> locations{};
+  locations.reserve(response->size());
+  for (auto const& location : *response) {
+    locations.emplace_back(response, &location);
+  }
+  return locations;
+}
+
+weatherer::EnsembleForecastPtr
+weatherer::EnsembleProcessor::OrganizeEnsembleData(
+    const nlohmann::json& json, PvCollection const& sun_times,
+    const util::TimeFrame& time_frame) {
+  using namespace util;
+  TraceSpan span{"EnsembleProcessor::OrganizeEnsembleData"};
+
+  const auto& hourly = json.at("hourly");
+  std::vector<std::int64_t> hourly_times{};
+  hourly_times.reserve(hourly.at("time").size());
+  for (const auto& time : hourly.at("time")) {
+    hourly_times.push_back(time.get<std::int64_t>());
+  }
+  const std::size_t hour_count = hourly_times.size();
+
+  // The control run plus every numbered member.
+  std::size_t member_count = 1;
+  while (hourly.contains(
+      GetMemberKey(kHourlyVariables[kTemperature], member_count))) {
+    ++member_count;
+  }
+  if (span.IsActive()) {
+    span.AddTag("members", std::to_string(member_count));
+  }
+
+  // Decode every member once into member-major columns, in the order of
+  // kHourlyVariables.
+  std::array<std::vector<double>, kHourlyVariables.size()> columns{};
+  for (std::size_t variable = 0; variable < columns.size(); ++variable) {
+    columns[variable].reserve(member_count * hour_count);
+    for (std::size_t member = 0; member < member_count; ++member) {
+      const auto& series =
+          hourly.at(GetMemberKey(kHourlyVariables[variable], member));
+      [[unlikely]] if (series.size() != hour_count) {
+        throw std::out_of_range("Ensemble member series is misaligned");
+      }
+      AppendSeries(series, columns[variable]);
+    }
+  }
+  const auto member_series = [&](const std::size_t variable,
+                                 const std::size_t member) {
+    return std::span<const double>{columns[variable]}.subspan(
+        member * hour_count, hour_count);
+  };
+
+  // The ensemble API has no daily series to take the days from. Bound every
+  // day exactly as the deterministic forecast of the same date is bounded, so
+  // that its slots line up and daylight saving days fold the same way.
+  std::vector<std::int64_t> bounds{};
+  bounds.reserve(2 * sun_times.size());
+  for (const auto& sun : sun_times | std::views::values) {
+    if (sun->GetDayStart() < sun->GetDayEnd()) {
+      bounds.push_back(sun->GetDayStart());
+      bounds.push_back(sun->GetDayEnd());
+    }
+  }
+  // Consecutive days share a bound; the span between two days that are not
+  // consecutive becomes a day of its own, which is left out below.
+  std::ranges::sort(bounds);
+  const auto duplicates = std::ranges::unique(bounds);
+  bounds.erase(duplicates.begin(), duplicates.end());
+  const auto boundaries = DayBoundaries::FromTimestamps(hourly_times, bounds);
+
+  const std::time_t total_days =
+      (time_frame.GetEndDate() - time_frame.GetStartDate()) /
+      Date::kSecondsPerDay;
+  const std::size_t day_limit =
+      static_cast<std::size_t>(std::max<std::time_t>(total_days, 0));
+
+  const auto is_complete = [&](const std::size_t day, PvData const& sun) {
+    // Every hour of the day must be present, not just the ones served.
+    const auto times = boundaries.Slice<std::int64_t>(hourly_times, day);
+    if (times.empty() || times.front() != sun.GetDayStart() ||
+        times.back() + Date::kSecondsPerHour != sun.GetDayEnd()) {
+      return false;
+    }
+    for (std::size_t variable = 0; variable < columns.size(); ++variable) {
+      for (std::size_t member = 0; member < member_count; ++member) {
+        const auto hours =
+            boundaries.Slice<double>(member_series(variable, member), day);
+        if (std::ranges::any_of(hours, [](const double value) {
+              return std::isnan(value);
+            })) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  // Keep the days with sun times for which every member is complete.
+  std::vector<EnsembleForecast::Day> days{};
+  std::vector<std::size_t> source_days{};
+  for (std::size_t i = 0;
+       i + 1 < bounds.size() && days.size() < day_limit; ++i) {
+    std::string date = Date{static_cast<std::time_t>(bounds[i])}.StripTime();
+    const auto sun = sun_times.find(date);
+    if (sun == sun_times.end() || sun->second->GetDayStart() != bounds[i]) {
+      continue;
+    }
+    if (!is_complete(i, *sun->second)) {
+      continue;
+    }
+    days.push_back(EnsembleForecast::Day{std::move(date),
+                                         sun->second->GetSunriseTime(),
+                                         sun->second->GetSunsetTime()});
+    source_days.push_back(i);
+  }
+
+  // Every member shares the timestamps, and so the clock changes.
+  std::vector<std::size_t> clock_changes{};
+  clock_changes.reserve(source_days.size());
+  for (const std::size_t source : source_days) {
+    clock_changes.push_back(boundaries.FindClockChange(hourly_times, source));
+  }
+
+  auto forecast =
+      std::make_shared<EnsembleForecast>(member_count, std::move(days));
+  for (std::size_t member = 0; member < member_count; ++member) {
+    for (std::size_t day = 0; day < source_days.size(); ++day) {
+      const std::size_t source = source_days[day];
+      forecast->SetMemberDay(
+          member, day,
+          boundaries.Slice<double>(member_series(kShortwaveRadiation, member),
+                                   source),
+          boundaries.Slice<double>(member_series(kTemperature, member), source),
+          boundaries.Slice<double>(member_series(kCloudCover, member), source),
+          clock_changes[day]);
+    }
+  }
+  return forecast;
+}
+
+std::vector<weatherer::EnsembleForecastPtr>
+weatherer::EnsembleProcessor::CollectEnsembleData(
+    std::span<const Coordinates> sites, const util::TimeFrame& time_frame,
+    const std::string_view model, const std::size_t max_batch_size) {
+  util::TraceSpan span{"EnsembleProcessor::CollectEnsembleData"};
+  if (span.IsActive()) {
+    span.AddTag("sites", std::to_string(sites.size()));
+    span.AddTag("model", std::string{model});
+  }
+
+  // Sunrise and sunset come from the deterministic forecast of the same days.
+  const std::vector<PvCollectionPtr> sun_times =
+      PvDataProcessor::CollectBatchData(sites, time_frame);
+
+  std::vector<EnsembleForecastPtr> forecasts{};
+  forecasts.reserve(sites.size());
+  for (const auto batch : util::ChunkCoordinates(sites, max_batch_size)) {
+    const std::vector<WeatherJsonPtr> responses =
+        FetchData(batch, time_frame, model);
+    // FetchData returns one response per site of the batch, in order.
+    for (const auto& response : responses) {
+      forecasts.push_back(OrganizeEnsembleData(
+          *response, *sun_times[forecasts.size()], time_frame));
+    }
+  }
+  return forecasts;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cpr/response.h>
+#include <nlohmann/json_fwd.hpp>
+
+#include "api/PvDataProcessor.hpp"
+#include "api/models/Coordinates.hpp"
+#include "api/models/EnsembleForecast.hpp"
+#include "util/Date.hpp"
+#include "util/ExpiringCache.hpp"
+#include "util/SingleFlight.hpp"
+#include "util/SpatialGrid.hpp"
+
+namespace weatherer {
+
+using EnsembleForecastPtr = std::shared_ptr<const EnsembleForecast>;
+
+/**
+ * @class EnsembleProcessor
+ * @brief Retrieves ensemble forecasts from the Open-Meteo ensemble API.
+ *
+ * An ensemble forecast holds many equally likely runs (members) of a weather
+ * model, and is the input for yield distributions rather than single yields;
+ * see PvMetrics::CalculateEnsembleYeildDistribution. Responses carry every
+ * member of every hourly variable and are decoded straight into member-major
+ * columns.
+ *
+ * The ensemble API does not serve sunrise and sunset, which do not vary between
+ * members anyway; they are taken from the deterministic forecast of the same
+ * days, fetched through PvDataProcessor.
+ */
+class EnsembleProcessor {
+  // Shares identical in-flight ensemble requests between concurrent callers.
+  static util::SingleFlight<std::string, WeatherJsonPtr> ensemble_flights_;
+  // Parsed ensemble responses by request key. Each holds every member, so a
+  // hit saves far more transfer and parsing than a deterministic one.
+  static util::ExpiringCache<std::string, WeatherJsonPtr> ensemble_cache_;
+  // Snaps request locations onto the weather model grid.
+  static const util::SpatialGrid grid_;
+
+  // Ensemble models run a few times a day at most.
+  static constexpr std::chrono::minutes kEnsembleCacheTtl_{30};
+  // Every response holds all members, so far fewer are kept than for
+  // deterministic forecasts.
+  static constexpr std::size_t kEnsembleCacheCapacity_ = 128;
+
+/**
+ * @brief Fetches an ensemble forecast from the Open-Meteo ensemble API.
+ * @param coords The coordinates for which the forecast is to be fetched.
+ * @param time_frame The time frame for which data is requested.
+ * @param model The ensemble model (e.g. icon_seamless).
+ * @return cpr::Response containing the HTTP response.
+ * @throws std::runtime_error if the response status code is not 200.
+ *
+ * Requests the hourly variables the yield model uses: temperature, cloud cover
+ * and shortwave radiation. Open-Meteo returns the control run under the plain
+ * variable names and every other member under a suffixed name (e.g.
+ * temperature_2m_member01).
+ */
+  [[nodiscard]] static cpr::Response IngestData(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+      std::string_view model);
+
+/**
+ * @brief Fetches and parses ensemble forecasts, sharing identical in-flight requests.
+ * @param coords The coordinates for which the forecast is to be fetched.
+ * @param time_frame The time frame for which data is requested.
+ * @param model The ensemble model.
+ * @return One WeatherJsonPtr per location holding its parsed, read-only JSON response.
+ * @throws std::runtime_error if the underlying HTTP request fails or the batched
+ * response does not contain one entry per location.
+ *
+ * Snaps, keys, coalesces and caches requests as PvDataProcessor::FetchData does.
+ */
+  [[nodiscard]] static std::vector<WeatherJsonPtr> FetchData(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+      std::string_view model);
+
+/**
+ * @brief Builds the single-flight key identifying an ensemble request.
+ */
+  [[nodiscard]] static std::string MakeRequestKey(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+      std::string_view model);
+
+ public:
+  // Default number of locations packed into a single batched request; lower
+  // than for deterministic forecasts, as every location carries every member.
+  static constexpr std::size_t kDefaultBatchSize = 10;
+  static constexpr std::string_view kDefaultModel{"icon_seamless"};
+
+  // Prevent instantiation of the EnsembleProcessor class.
+  EnsembleProcessor() = delete;
+  ~EnsembleProcessor() = delete;
+
+/**
+ * @brief Decodes one location of an ensemble response into member-major columns.
+ * @param json The parsed JSON response of the location.
+ * @param sun_times The deterministic forecast of the location, providing the
+ * bounds, sunrise and sunset of every day.
+ * @param time_frame The time frame for which data is requested.
+ * @return The ensemble forecast; days missing from sun_times or without known
+ * bounds, not fully covered by the response, or for which any member lacks a
+ * value, are left out.
+ * @throws std::out_of_range if the expected JSON structure is not present.
+ *
+ * Every member is decoded once into its own contiguous column, then chunked
+ * into the days of sun_times (see PvData::GetDayStart), so that a 23 or 25 hour
+ * day is sliced and folded exactly as its deterministic forecast is.
+ */
+  [[nodiscard]] static EnsembleForecastPtr OrganizeEnsembleData(
+      const nlohmann::json& json, PvCollection const& sun_times,
+      const util::TimeFrame& time_frame);
+
+/**
+ * @brief Collects ensemble forecasts for many sites using multi-location requests.
+ * @param sites The coordinates of every site.
+ * @param time_frame The time frame for which data is requested.
+ * @param model The ensemble model.
+ * @param max_batch_size The maximum number of locations packed into one request.
+ * @return One EnsembleForecastPtr per site, in the same order as sites.
+ * @throws std::runtime_error if a request fails or its response does not hold
+ * every site of the batch.
+ */
+  [[nodiscard]] static std::vector<EnsembleForecastPtr> CollectEnsembleData(
+      std::span<const Coordinates> sites, const util::TimeFrame& time_frame,
+      std::string_view model = kDefaultModel,
+      std::size_t max_batch_size = kDefaultBatchSize);
+
+/**
+ * @return The number of ensemble requests that were actually sent.
+ */
+  [[nodiscard]] static std::size_t GetFetchCount() {
+    return ensemble_flights_.GetExecutedCount();
+  }
+
+/**
+ * @brief Drops every cached ensemble response, forcing the next request to fetch.
+ */
+  static void ClearEnsembleCache() { ensemble_cache_.Clear(); }
+};
+}  // namespace weatherer
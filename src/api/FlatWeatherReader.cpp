@@ -0,0 +1,181 @@
+#include "FlatWeatherReader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+[[noreturn]] void ThrowMalformed() {
+  throw std::runtime_error("Malformed FlatBuffers weather response");
+}
+
+// Enumerators of the SDK's Variable enum for the variables requested.
+constexpr std::array<std::pair<std::string_view, std::uint8_t>, 6> kVariables{{
+    {"cloud_cover", 3},
+    {"shortwave_radiation", 32},
+    {"sunrise", 40},
+    {"sunset", 41},
+    {"temperature", 47},
+    {"wind_speed", 59},
+}};
+}  // namespace
+
+template <typename Ty_>
+Ty_ weatherer::FlatWeatherReader::Read(const std::size_t position) const {
+  [[unlikely]] if (position > message_.size() ||
+                   message_.size() - position < sizeof(Ty_)) {
+    ThrowMalformed();
+  }
+  Ty_ value;
+  std::memcpy(&value, message_.data() + position, sizeof(Ty_));
+  return value;
+}
+
+std::optional<std::size_t> weatherer::FlatWeatherReader::FindField(
+    const std::size_t table, const std::uint16_t field) const {
+  // A table starts with the signed distance back to its vtable, which lists
+  // the vtable size, the table size and then the offset of every field.
+  const auto vtable = static_cast<std::int64_t>(table) -
+                      static_cast<std::int64_t>(Read<std::int32_t>(table));
+  [[unlikely]] if (vtable < 0) {
+    ThrowMalformed();
+  }
+  const auto vtable_position = static_cast<std::size_t>(vtable);
+  const std::size_t entry = 4 + 2 * static_cast<std::size_t>(field);
+  if (entry + 2 > Read<std::uint16_t>(vtable_position)) {
+    return std::nullopt;
+  }
+  const std::uint16_t offset = Read<std::uint16_t>(vtable_position + entry);
+  if (offset == 0) {
+    return std::nullopt;
+  }
+  return table + offset;
+}
+
+template <typename Ty_>
+Ty_ weatherer::FlatWeatherReader::ReadField(const std::size_t table,
+                                            const std::uint16_t field,
+                                            const Ty_ fallback) const {
+  const auto position = FindField(table, field);
+  return position ? Read<Ty_>(*position) : fallback;
+}
+
+std::optional<std::size_t> weatherer::FlatWeatherReader::ReadReference(
+    const std::size_t table, const std::uint16_t field) const {
+  const auto position = FindField(table, field);
+  if (!position) {
+    return std::nullopt;
+  }
+  return *position + Read<std::uint32_t>(*position);
+}
+
+std::span<const std::byte> weatherer::FlatWeatherReader::ReadVector(
+    const std::size_t table, const std::uint16_t field,
+    const std::size_t element_size) const {
+  const auto vector = ReadReference(table, field);
+  if (!vector) {
+    return {};
+  }
+  const std::size_t length = Read<std::uint32_t>(*vector);
+  const std::size_t data = *vector + 4;
+  [[unlikely]] if (data > message_.size() ||
+                   (message_.size() - data) / element_size < length) {
+    ThrowMalformed();
+  }
+  return message_.subspan(data, length * element_size);
+}
+
+weatherer::FlatWeatherSeries weatherer::FlatWeatherReader::ReadSeries(
+    const std::size_t table) const {
+  FlatWeatherSeries series{};
+  series.time = ReadField<std::int64_t>(table, kTimeField, 0);
+  series.time_end = ReadField<std::int64_t>(table, kTimeEndField, 0);
+  series.interval = ReadField<std::int32_t>(table, kIntervalField, 0);
+
+  // A vector of tables holds the offset of each table, relative to itself.
+  const std::span<const std::byte> variables =
+      ReadVector(table, kVariablesField, 4);
+  if (variables.empty()) {
+    return series;
+  }
+  const std::size_t first = static_cast<std::size_t>(
+      variables.data() - message_.data());
+  series.variables.reserve(variables.size() / 4);
+  for (std::size_t i = 0; i < variables.size() / 4; ++i) {
+    const std::size_t element = first + 4 * i;
+    const std::size_t variable = element + Read<std::uint32_t>(element);
+    series.variables.push_back(FlatWeatherVariable{
+        FlatVariableId{ReadField<std::uint8_t>(variable, kVariableField, 0),
+                       ReadField<std::int16_t>(variable, kAltitudeField, 0)},
+        FlatVector<float>{ReadVector(variable, kValuesField, sizeof(float))},
+        FlatVector<std::int64_t>{
+            ReadVector(variable, kValuesInt64Field, sizeof(std::int64_t))}});
+  }
+  return series;
+}
+
+weatherer::FlatWeatherLocation weatherer::FlatWeatherReader::ReadLocation()
+    const {
+  // The buffer starts with the offset of its root table.
+  const std::size_t root = Read<std::uint32_t>(0);
+  FlatWeatherLocation location{};
+  location.latitude = ReadField<float>(root, kLatitudeField, 0);
+  location.longitude = ReadField<float>(root, kLongitudeField, 0);
+  location.utc_offset_seconds =
+      ReadField<std::int32_t>(root, kUtcOffsetSecondsField, 0);
+  if (const auto hourly = ReadReference(root, kHourlyField)) {
+    location.hourly = ReadSeries(*hourly);
+  }
+  if (const auto daily = ReadReference(root, kDailyField)) {
+    location.daily = ReadSeries(*daily);
+  }
+  return location;
+}
+
+std::vector<weatherer::FlatWeatherLocation>
+weatherer::FlatWeatherReader::Parse(const std::span<const std::byte> body) {
+  std::vector<FlatWeatherLocation> locations{};
+  std::size_t position = 0;
+  while (position < body.size()) {
+    std::uint32_t size = 0;
+    [[unlikely]] if (body.size() - position < sizeof(size)) {
+      ThrowMalformed();
+    }
+    std::memcpy(&size, body.data() + position, sizeof(size));
+    position += sizeof(size);
+    [[unlikely]] if (body.size() - position < size) {
+      ThrowMalformed();
+    }
+    locations.push_back(
+        FlatWeatherReader{body.subspan(position, size)}.ReadLocation());
+    position += size;
+  }
+  return locations;
+}
+
+std::optional<weatherer::FlatVariableId>
+weatherer::FlatWeatherReader::FindVariableId(std::string_view name) {
+  std::int16_t altitude = 0;
+  // Split off a trailing _<n>m, e.g. the 2m of temperature_2m.
+  if (const auto separator = name.rfind('_');
+      separator != std::string_view::npos && name.ends_with('m')) {
+    const char* const first = name.data() + separator + 1;
+    const char* const last = name.data() + name.size() - 1;
+    const auto [end, error] = std::from_chars(first, last, altitude);
+    if (error == std::errc{} && end == last && first != last) {
+      name = name.substr(0, separator);
+    } else {
+      altitude = 0;
+    }
+  }
+  const auto variable =
+      std::ranges::find(kVariables, name, [](auto const& entry) {
+        return entry.first;
+      });
+  if (variable == kVariables.end()) {
+    return std::nullopt;
+  }
+  return FlatVariableId{variable->second, altitude};
+}
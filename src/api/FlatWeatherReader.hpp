@@ -0,0 +1,177 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace weatherer {
+/**
+ * @brief A view of a numeric vector inside a FlatBuffers buffer.
+ * @tparam Ty_ The element type.
+ *
+ * Elements are read in place, with no alignment requirement on the buffer.
+ */
+template <typename Ty_>
+class FlatVector {
+ private:
+  std::span<const std::byte> bytes_{};
+
+ public:
+  FlatVector() = default;
+  explicit FlatVector(const std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+  [[nodiscard]] std::size_t GetSize() const {
+    return bytes_.size() / sizeof(Ty_);
+  }
+
+  [[nodiscard]] Ty_ operator[](const std::size_t index) const {
+    Ty_ value;
+    std::memcpy(&value, bytes_.data() + index * sizeof(Ty_), sizeof(Ty_));
+    return value;
+  }
+};
+
+/**
+ * @brief What a variable of an Open-Meteo FlatBuffers response measures.
+ */
+struct FlatVariableId {
+  // The Open-Meteo variable enumerator; see the SDK's Variable enum.
+  std::uint8_t variable = 0;
+  // Height above ground in metres, or 0 where the name gives none.
+  std::int16_t altitude = 0;
+
+  bool operator==(FlatVariableId const&) const = default;
+};
+
+/**
+ * @brief One variable of an Open-Meteo FlatBuffers response.
+ */
+struct FlatWeatherVariable {
+  FlatVariableId id{};
+  FlatVector<float> values{};
+  // Set instead of values for timestamps, such as sunrise and sunset.
+  FlatVector<std::int64_t> values_int64{};
+};
+
+/**
+ * @brief The variables of one time resolution, sampled at a fixed interval.
+ */
+struct FlatWeatherSeries {
+  // The first timestamp and the end of the series (exclusive), in Unix time.
+  std::int64_t time = 0;
+  std::int64_t time_end = 0;
+  // The spacing of the timestamps in seconds.
+  std::int32_t interval = 0;
+  // In the order they were requested.
+  std::vector<FlatWeatherVariable> variables{};
+
+  [[nodiscard]] std::size_t GetStepCount() const {
+    return interval > 0 && time_end > time
+               ? static_cast<std::size_t>((time_end - time) / interval)
+               : 0;
+  }
+};
+
+/**
+ * @brief The response for one location of an Open-Meteo FlatBuffers response.
+ */
+struct FlatWeatherLocation {
+  float latitude = 0;
+  float longitude = 0;
+  std::int32_t utc_offset_seconds = 0;
+  std::optional<FlatWeatherSeries> hourly{};
+  std::optional<FlatWeatherSeries> daily{};
+};
+
+/**
+ * @brief Reads Open-Meteo responses requested with format=flatbuffers.
+ *
+ * The body is a sequence of size-prefixed WeatherApiResponse messages, one per
+ * requested location and in the order requested. The reader walks the
+ * FlatBuffers tables directly, without generated code, and returns views into
+ * the body, which must therefore outlive them. Every offset is bounds checked.
+ */
+class FlatWeatherReader {
+ public:
+  // Field indices of the SDK's WeatherApiResponse table.
+  static constexpr std::uint16_t kLatitudeField = 0;
+  static constexpr std::uint16_t kLongitudeField = 1;
+  static constexpr std::uint16_t kUtcOffsetSecondsField = 6;
+  static constexpr std::uint16_t kDailyField = 10;
+  static constexpr std::uint16_t kHourlyField = 11;
+
+  // Field indices of the SDK's VariablesWithTime table.
+  static constexpr std::uint16_t kTimeField = 0;
+  static constexpr std::uint16_t kTimeEndField = 1;
+  static constexpr std::uint16_t kIntervalField = 2;
+  static constexpr std::uint16_t kVariablesField = 3;
+
+  // Field indices of the SDK's VariableWithValues table.
+  static constexpr std::uint16_t kVariableField = 0;
+  static constexpr std::uint16_t kValuesField = 3;
+  static constexpr std::uint16_t kValuesInt64Field = 4;
+  static constexpr std::uint16_t kAltitudeField = 5;
+
+ private:
+  std::span<const std::byte> message_;
+
+  explicit FlatWeatherReader(std::span<const std::byte> message)
+      : message_(message) {}
+
+  /**
+   * @throws std::runtime_error if the read is out of bounds.
+   */
+  template <typename Ty_>
+  [[nodiscard]] Ty_ Read(std::size_t position) const;
+
+  /**
+   * @return The position of a table field, or std::nullopt if it is absent.
+   */
+  [[nodiscard]] std::optional<std::size_t> FindField(std::size_t table,
+                                                     std::uint16_t field) const;
+
+  template <typename Ty_>
+  [[nodiscard]] Ty_ ReadField(std::size_t table, std::uint16_t field,
+                              Ty_ fallback) const;
+
+  /**
+   * @return The position of the object a field refers to, if it is present.
+   */
+  [[nodiscard]] std::optional<std::size_t> ReadReference(
+      std::size_t table, std::uint16_t field) const;
+
+  /**
+   * @return The elements of the vector a field refers to; empty if absent.
+   */
+  [[nodiscard]] std::span<const std::byte> ReadVector(
+      std::size_t table, std::uint16_t field, std::size_t element_size) const;
+
+  [[nodiscard]] FlatWeatherSeries ReadSeries(std::size_t table) const;
+
+  [[nodiscard]] FlatWeatherLocation ReadLocation() const;
+
+ public:
+  /**
+   * @brief Reads every location of a response body.
+   * @param body The response body.
+   * @return One entry per location, viewing into body.
+   * @throws std::runtime_error if the body is not a valid response.
+   */
+  [[nodiscard]] static std::vector<FlatWeatherLocation> Parse(
+      std::span<const std::byte> body);
+
+  /**
+   * @brief Identifies a requested variable, as responses tag it.
+   * @param name The variable as requested (e.g. temperature_2m).
+   * @return The variable enumerator and altitude, or std::nullopt if the
+   * variable is not one the project requests.
+   *
+   * A trailing _<n>m gives the altitude; the rest names the variable.
+   */
+  [[nodiscard]] static std::optional<FlatVariableId> FindVariableId(
+      std::string_view name);
+};
+}  // namespace weatherer
@@ -0,0 +1,233 @@
+#include "HistoricalStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+#include "util/SeriesCodec.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+constexpr std::size_t kRecordAlignment = 8;
+
+std::size_t AlignRecord(const std::size_t size) {
+  return (size + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+}  // namespace
+
+std::string_view weatherer::StoredDay::GetDate() const {
+  return {date.data(), strnlen(date.data(), date.size())};
+}
+
+weatherer::HistoricalStore::HistoricalStore(std::filesystem::path directory)
+    : directory_(std::move(directory)) {
+  std::filesystem::create_directories(directory_);
+}
+
+std::filesystem::path weatherer::HistoricalStore::GetPath(
+    util::GridCell const& cell) const {
+  // Files of other format versions are left alone rather than misread.
+  return directory_ / (std::to_string(cell.lat_index) + "_" +
+                       std::to_string(cell.lon_index) + ".v" +
+                       std::to_string(kVersion_) + ".days");
+}
+
+std::shared_ptr<const weatherer::HistoricalStore::Segment>
+weatherer::HistoricalStore::GetSegment(util::GridCell const& cell,
+                                       const bool refresh) const {
+  std::lock_guard lock{mutex_};
+  const auto it = segments_.find(cell);
+  if (it != segments_.end() && !refresh) {
+    return it->second;
+  }
+
+  const std::filesystem::path path = GetPath(cell);
+  std::error_code error{};
+  const auto size = std::filesystem::file_size(path, error);
+  if (error) {
+    return nullptr;
+  }
+  if (it != segments_.end() && it->second->file.GetSize() == size) {
+    return it->second;
+  }
+
+  auto segment = std::make_shared<Segment>(Segment{util::MappedFile{path}, {}});
+  const std::span<const std::byte> bytes = segment->file.GetBytes();
+  FileHeader header{};
+  [[unlikely]] if (bytes.size() < sizeof(header)) {
+    throw std::runtime_error("Truncated historical store file: " + path.string());
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  [[unlikely]] if (header.magic != kMagic_ || header.version != kVersion_) {
+    throw std::runtime_error("Unrecognized historical store file: " + path.string());
+  }
+
+  // Walk the records; a partially written trailing record is ignored.
+  std::size_t offset = sizeof(header);
+  while (bytes.size() - offset >= sizeof(RecordHeader)) {
+    RecordHeader record{};
+    std::memcpy(&record, bytes.data() + offset, sizeof(record));
+    const std::size_t record_size = sizeof(record) + record.payload_size;
+    if (bytes.size() - offset < record_size) {
+      break;
+    }
+    const std::span<const std::byte> record_bytes =
+        bytes.subspan(offset, record_size);
+    const auto* date = reinterpret_cast<const char*>(record_bytes.data());
+    // The first copy of a day wins should it have been appended twice.
+    segment->index.emplace(
+        std::string_view{date, strnlen(date, record.date.size())}, record_bytes);
+    offset += record_size;
+  }
+
+  std::shared_ptr<const Segment> result = std::move(segment);
+  segments_.insert_or_assign(cell, result);
+  return result;
+}
+
+weatherer::StoredDay weatherer::HistoricalStore::DecodeDay(
+    std::span<const std::byte> record) {
+  RecordHeader header{};
+  std::memcpy(&header, record.data(), sizeof(header));
+  std::span<const std::byte> payload = record.subspan(sizeof(header));
+
+  StoredDay day{};
+  day.date = header.date;
+  day.sunrise_time = header.sunrise_time;
+  day.sunset_time = header.sunset_time;
+  payload = payload.subspan(util::SeriesCodec::Decode(
+      payload, kRadiationScale_, day.shortwave_radiation));
+  payload = payload.subspan(util::SeriesCodec::Decode(
+      payload, kTemperatureScale_, day.temperature));
+  payload = payload.subspan(util::SeriesCodec::Decode(
+      payload, kCloudCoverScale_, day.cloud_cover_total));
+  util::SeriesCodec::Decode(payload, kWindSpeedScale_, day.wind_speed);
+  return day;
+}
+
+std::optional<weatherer::StoredDay> weatherer::HistoricalStore::FindDay(
+    util::GridCell const& cell, const std::string_view date) const {
+  for (const bool refresh : {false, true}) {
+    const auto segment = GetSegment(cell, refresh);
+    if (!segment) {
+      return std::nullopt;
+    }
+    if (const auto it = segment->index.find(date); it != segment->index.end()) {
+      return DecodeDay(it->second);
+    }
+  }
+  return std::nullopt;
+}
+
+weatherer::PvCollectionPtr weatherer::HistoricalStore::Load(
+    util::GridCell const& cell, util::TimeFrame const& time_frame) const {
+  using namespace util;
+  TraceSpan span{"HistoricalStore::Load"};
+
+  const std::time_t total_days =
+      (time_frame.GetEndDate() - time_frame.GetStartDate()) /
+      Date::kSecondsPerDay;
+  // Anchor on midday so that daylight saving shifts never skip or repeat a date.
+  const Date first_midday = time_frame.GetStartDate() + 12 * Date::kSecondsPerHour;
+
+  for (const bool refresh : {false, true}) {
+    const auto segment = GetSegment(cell, refresh);
+    if (!segment) {
+      return nullptr;
+    }
+
+    auto data = std::make_shared<std::unordered_map<std::string, PvDataPtr>>();
+    data->reserve(static_cast<std::size_t>(std::max<std::time_t>(total_days, 0)));
+    bool complete = true;
+    for (std::time_t i = 0; i < total_days; ++i) {
+      std::string date = (first_midday + i * Date::kSecondsPerDay).StripTime();
+      const auto it = segment->index.find(date);
+      if (it == segment->index.end()) {
+        complete = false;
+        break;
+      }
+      const StoredDay day = DecodeDay(it->second);
+      data->emplace(date, std::make_shared<PvData>(
+                              date, day.sunrise_time, day.sunset_time,
+                              day.shortwave_radiation, day.temperature,
+                              day.cloud_cover_total, day.wind_speed));
+    }
+    if (complete) {
+      return data;
+    }
+  }
+  return nullptr;
+}
+
+std::size_t weatherer::HistoricalStore::Append(
+    util::GridCell const& cell,
+    std::unordered_map<std::string, PvDataPtr> const& collection) {
+  util::TraceSpan span{"HistoricalStore::Append"};
+  std::lock_guard append_lock{append_mutex_};
+  const auto segment = GetSegment(cell, true);
+
+  std::vector<std::string_view> dates{};
+  dates.reserve(collection.size());
+  for (auto const& date : collection | std::views::keys) {
+    [[unlikely]] if (date.size() >= RecordHeader{}.date.size()) {
+      throw std::invalid_argument("Invalid date for the historical store: " + date);
+    }
+    if (!segment || !segment->index.contains(date)) {
+      dates.emplace_back(date);
+    }
+  }
+  if (dates.empty()) {
+    return 0;
+  }
+  std::ranges::sort(dates);
+
+  std::vector<std::byte> records{};
+  records.reserve(dates.size() *
+                  (sizeof(RecordHeader) + 4 * util::SeriesCodec::GetMaxEncodedSize(24)));
+  for (const std::string_view date : dates) {
+    PvData const& pv_data = *collection.find(std::string{date})->second;
+    RecordHeader header{};
+    std::ranges::copy(date, header.date.begin());
+    header.sunrise_time = pv_data.GetSunriseTime();
+    header.sunset_time = pv_data.GetSunsetTime();
+
+    const std::size_t header_offset = records.size();
+    records.resize(header_offset + sizeof(header));
+    util::SeriesCodec::Encode(pv_data.GetShortwaveRadiation(), kRadiationScale_, records);
+    util::SeriesCodec::Encode(pv_data.GetTemperature(), kTemperatureScale_, records);
+    util::SeriesCodec::Encode(pv_data.GetCloudCoverTotal(), kCloudCoverScale_, records);
+    util::SeriesCodec::Encode(pv_data.GetWindSpeed(), kWindSpeedScale_, records);
+    records.resize(header_offset + AlignRecord(records.size() - header_offset));
+    header.payload_size =
+        static_cast<std::uint32_t>(records.size() - header_offset - sizeof(header));
+    std::memcpy(records.data() + header_offset, &header, sizeof(header));
+  }
+
+  const std::filesystem::path path = GetPath(cell);
+  std::error_code error{};
+  const bool is_new = std::filesystem::file_size(path, error) == 0 || error;
+  std::ofstream file{path, std::ios::binary | std::ios::app};
+  [[unlikely]] if (!file) {
+    throw std::runtime_error("Failed to open historical store file: " + path.string());
+  }
+  if (is_new) {
+    const FileHeader header{kMagic_, kVersion_, 0};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  file.write(reinterpret_cast<const char*>(records.data()),
+             static_cast<std::streamsize>(records.size()));
+  file.flush();
+  [[unlikely]] if (!file) {
+    throw std::runtime_error("Failed to write historical store file: " + path.string());
+  }
+  return dates.size();
+}
+
+std::size_t weatherer::HistoricalStore::GetDayCount(
+    util::GridCell const& cell) const {
+  const auto segment = GetSegment(cell, true);
+  return segment ? segment->index.size() : 0;
+}
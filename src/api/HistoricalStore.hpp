@@ -0,0 +1,163 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "api/PvDataProcessor.hpp"
+#include "util/Date.hpp"
+#include "util/MappedFile.hpp"
+#include "util/SpatialGrid.hpp"
+
+namespace weatherer {
+/**
+ * @brief One day of hourly weather as read back from the store.
+ *
+ * The series hold the values PvData stores (radiation already in kWh/m^2 and
+ * daylight saving hours folded into 24 slots).
+ */
+struct StoredDay {
+  // Date format (e.g. 2021-01-01), NUL padded.
+  std::array<char, 16> date;
+  std::int64_t sunrise_time;
+  std::int64_t sunset_time;
+  std::array<double, 24> shortwave_radiation;
+  std::array<double, 24> temperature;
+  std::array<double, 24> cloud_cover_total;
+  std::array<double, 24> wind_speed;
+
+  [[nodiscard]] std::string_view GetDate() const;
+};
+
+/**
+ * @class HistoricalStore
+ * @brief An append-only local store of historical weather, read through memory mappings.
+ *
+ * Archived weather never changes once published, so every day fetched from the
+ * historical API only needs to be downloaded once. The store keeps one file per
+ * weather grid cell, holding a small header followed by one record per day in
+ * the order they were appended. A record is a fixed header (date, sunrise and
+ * sunset) followed by the four hourly series, each encoded with SeriesCodec at
+ * the precision the API reports, which takes a day from 800 to roughly 140
+ * bytes. Values off that precision are rounded to it, so the store is lossy.
+ * Each file is memory mapped for reading and indexed by date when first used;
+ * other processes reading the same directory share the page cache.
+ *
+ * Reads are safe from any number of threads and processes. Appends are
+ * serialized within the process; a single writing process per directory is assumed.
+ */
+class HistoricalStore {
+ private:
+  struct FileHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+  };
+
+  struct RecordHeader {
+    std::array<char, 16> date;
+    std::int64_t sunrise_time;
+    std::int64_t sunset_time;
+    // Size of the encoded series following the header, padded to 8 bytes.
+    std::uint32_t payload_size;
+    std::uint32_t reserved;
+  };
+
+  /**
+   * @brief A mapped store file together with its date index.
+   */
+  struct Segment {
+    util::MappedFile file;
+    std::unordered_map<std::string_view, std::span<const std::byte>> index;
+  };
+
+  static constexpr std::array<char, 8> kMagic_{'W', 'T', 'H', 'R', 'D', 'A', 'Y', 'S'};
+  static constexpr std::uint32_t kVersion_ = 2;
+
+  // Quanta per stored unit, matching the precision reported by the API:
+  // 1 Wh/m^2, 0.1 degrees Celsius, 1 percent and 0.1 km/h. Storing is lossy:
+  // values are rounded to the nearest quantum, so averages folded from the
+  // repeated hour of daylight saving days, and the float approximations of
+  // FlatBuffers responses, read back up to half a quantum away.
+  static constexpr double kRadiationScale_ = 1000.0;
+  static constexpr double kTemperatureScale_ = 10.0;
+  static constexpr double kCloudCoverScale_ = 100.0;
+  static constexpr double kWindSpeedScale_ = 10.0;
+
+/**
+ * @brief Decodes one record of a store file.
+ * @param record The record, starting at its header.
+ * @return The decoded day.
+ * @throws std::runtime_error if the record is malformed.
+ */
+  [[nodiscard]] static StoredDay DecodeDay(std::span<const std::byte> record);
+
+  std::filesystem::path directory_;
+  mutable std::mutex mutex_;
+  // Serializes appends, so each day is written once per process.
+  std::mutex append_mutex_;
+  mutable std::unordered_map<util::GridCell, std::shared_ptr<const Segment>,
+                             util::GridCellHash>
+      segments_;
+
+  [[nodiscard]] std::filesystem::path GetPath(util::GridCell const& cell) const;
+
+/**
+ * @brief Gets the mapped file of a grid cell.
+ * @param cell The grid cell.
+ * @param refresh Whether to map the file again if it grew since it was last mapped.
+ * @return The segment, or nullptr if nothing was stored for the cell.
+ * @throws std::runtime_error if the file is not a historical store file.
+ */
+  [[nodiscard]] std::shared_ptr<const Segment> GetSegment(
+      util::GridCell const& cell, bool refresh) const;
+
+ public:
+/**
+ * @param directory The directory holding the store files; created if missing.
+ */
+  explicit HistoricalStore(std::filesystem::path directory);
+  ~HistoricalStore() = default;
+  HistoricalStore(const HistoricalStore& other) = delete;
+  HistoricalStore& operator=(const HistoricalStore& other) = delete;
+
+/**
+ * @brief Looks up and decodes a single stored day.
+ * @param cell The grid cell of the site.
+ * @param date The day, formatted as YYYY-MM-DD.
+ * @return The day, or std::nullopt if it is not stored.
+ */
+  [[nodiscard]] std::optional<StoredDay> FindDay(
+      util::GridCell const& cell, std::string_view date) const;
+
+/**
+ * @brief Loads every day of a time frame from the store.
+ * @param cell The grid cell of the site.
+ * @param time_frame The time frame for which data is requested.
+ * @return The stored days, or nullptr unless every day of the time frame is stored.
+ */
+  [[nodiscard]] PvCollectionPtr Load(util::GridCell const& cell,
+                                     util::TimeFrame const& time_frame) const;
+
+/**
+ * @brief Appends the days of a collection that are not stored yet.
+ * @param cell The grid cell the collection was fetched for.
+ * @param collection The days to store, keyed by date.
+ * @return The number of days written.
+ * @throws std::runtime_error if the store file cannot be written.
+ */
+  std::size_t Append(util::GridCell const& cell,
+                     std::unordered_map<std::string, PvDataPtr> const& collection);
+
+/**
+ * @return The number of days stored for a grid cell.
+ */
+  [[nodiscard]] std::size_t GetDayCount(util::GridCell const& cell) const;
+};
+}  // namespace weatherer
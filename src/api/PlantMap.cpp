@@ -0,0 +1,184 @@
+#include "PlantMap.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "util/Trace.hpp"
+
+weatherer::PlantMap::PlantMap(std::filesystem::path const& path)
+    : file_(path) {
+  const std::span<const std::byte> bytes = file_.GetBytes();
+  FileHeader header{};
+  [[unlikely]] if (bytes.size() < sizeof(header)) {
+    throw std::runtime_error("Truncated plant map: " + path.string());
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  [[unlikely]] if (header.magic != kMagic_ || header.version != kVersion_) {
+    throw std::runtime_error("Unrecognized plant map: " + path.string());
+  }
+
+  words_per_entry_ = header.words_per_entry;
+  row_count_ = header.entry_count;
+  generated_at_ = static_cast<std::time_t>(header.generated_at);
+  [[unlikely]] if (bytes.size() - sizeof(header) <
+                   header.names_size + row_count_ * GetRowSize()) {
+    throw std::runtime_error("Truncated plant map: " + path.string());
+  }
+
+  const auto* names = reinterpret_cast<const char*>(bytes.data() + sizeof(header));
+  const char* names_end = names + header.names_size;
+  crop_names_.reserve(header.crop_count);
+  while (crop_names_.size() < header.crop_count && names < names_end) {
+    const std::size_t length = strnlen(names, names_end - names);
+    crop_names_.emplace_back(names, length);
+    names += length + 1;
+  }
+  [[unlikely]] if (crop_names_.size() != header.crop_count ||
+                   words_per_entry_ != (std::size_t{header.crop_count} + 63) / 64) {
+    throw std::runtime_error("Malformed plant map: " + path.string());
+  }
+  rows_ = bytes.subspan(sizeof(header) + header.names_size,
+                        row_count_ * GetRowSize());
+
+  // Every set bit must name a crop, so Find never returns an index past the
+  // crop names; only the last word of a row can hold bits beyond them.
+  if (const std::size_t used = header.crop_count % 64; used != 0) {
+    const std::uint64_t unused = ~std::uint64_t{0} << used;
+    const std::size_t last_word = sizeof(RowHeader) +
+                                  (words_per_entry_ - 1) * sizeof(std::uint64_t);
+    for (std::size_t row = 0; row < row_count_; ++row) {
+      std::uint64_t bits{};
+      std::memcpy(&bits, rows_.data() + row * GetRowSize() + last_word,
+                  sizeof(bits));
+      [[unlikely]] if ((bits & unused) != 0) {
+        throw std::runtime_error("Malformed plant map: " + path.string());
+      }
+    }
+  }
+}
+
+std::optional<std::uint32_t> weatherer::PlantMap::ParseZipcode(
+    const std::string_view zipcode) {
+  std::uint32_t value = 0;
+  if (zipcode.size() != 5) {
+    return std::nullopt;
+  }
+  const auto [end, error] =
+      std::from_chars(zipcode.data(), zipcode.data() + zipcode.size(), value);
+  if (error != std::errc{} || end != zipcode.data() + zipcode.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+void weatherer::PlantMap::Write(std::filesystem::path const& path,
+                                std::span<const std::string> crop_names,
+                                std::span<const PlantMapEntry> entries,
+                                const std::time_t generated_at) {
+  util::TraceSpan span{"PlantMap::Write"};
+  const std::size_t words = (crop_names.size() + 63) / 64;
+
+  std::string names{};
+  for (std::string const& name : crop_names) {
+    names += name;
+    names += '\0';
+  }
+  names.resize((names.size() + 7) / 8 * 8, '\0');
+
+  // Rows are fixed size and sorted, so readers can binary search them.
+  std::vector<std::pair<std::uint32_t, std::size_t>> order{};
+  order.reserve(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const auto zipcode = ParseZipcode(entries[i].zipcode);
+    [[unlikely]] if (!zipcode) {
+      throw std::invalid_argument("Invalid zipcode: " + entries[i].zipcode);
+    }
+    order.emplace_back(*zipcode, i);
+  }
+  std::ranges::sort(order);
+
+  const std::size_t row_size = sizeof(RowHeader) + words * sizeof(std::uint64_t);
+  std::vector<std::byte> rows(order.size() * row_size);
+  std::byte* row = rows.data();
+  for (auto const& [zipcode, index] : order) {
+    const RowHeader row_header{zipcode, entries[index].zone};
+    std::memcpy(row, &row_header, sizeof(row_header));
+    std::vector<std::uint64_t> mask(words);
+    for (const std::size_t crop : entries[index].plantable) {
+      [[unlikely]] if (crop >= crop_names.size()) {
+        throw std::invalid_argument("Crop index out of range: " + std::to_string(crop));
+      }
+      mask[crop / 64] |= std::uint64_t{1} << (crop % 64);
+    }
+    std::memcpy(row + sizeof(row_header), mask.data(), words * sizeof(std::uint64_t));
+    row += row_size;
+  }
+
+  const FileHeader header{kMagic_,
+                          kVersion_,
+                          static_cast<std::uint32_t>(crop_names.size()),
+                          static_cast<std::uint32_t>(order.size()),
+                          static_cast<std::uint32_t>(words),
+                          static_cast<std::uint32_t>(names.size()),
+                          0,
+                          static_cast<std::int64_t>(generated_at)};
+
+  // Write next to the target and rename, so readers never map a partial file.
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    file.write(reinterpret_cast<const char*>(rows.data()),
+               static_cast<std::streamsize>(rows.size()));
+    [[unlikely]] if (!file.flush()) {
+      throw std::runtime_error("Failed to write plant map: " + temp_path.string());
+    }
+  }
+  std::filesystem::rename(temp_path, path);
+}
+
+std::optional<weatherer::PlantMapEntry> weatherer::PlantMap::Find(
+    const std::string_view zipcode) const {
+  const auto key = ParseZipcode(zipcode);
+  if (!key) {
+    return std::nullopt;
+  }
+
+  const std::size_t row_size = GetRowSize();
+  const auto zipcode_at = [&](const std::size_t index) {
+    RowHeader row_header{};
+    std::memcpy(&row_header, rows_.data() + index * row_size, sizeof(row_header));
+    return row_header;
+  };
+  std::size_t low = 0;
+  std::size_t high = row_count_;
+  while (low < high) {
+    const std::size_t mid = low + (high - low) / 2;
+    if (zipcode_at(mid).zipcode < *key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == row_count_ || zipcode_at(low).zipcode != *key) {
+    return std::nullopt;
+  }
+
+  PlantMapEntry entry{std::string{zipcode}, zipcode_at(low).zone, {}};
+  const std::byte* mask = rows_.data() + low * row_size + sizeof(RowHeader);
+  for (std::size_t word = 0; word < words_per_entry_; ++word) {
+    std::uint64_t bits{};
+    std::memcpy(&bits, mask + word * sizeof(bits), sizeof(bits));
+    while (bits != 0) {
+      entry.plantable.push_back(word * 64 + std::countr_zero(bits));
+      bits &= bits - 1;
+    }
+  }
+  return entry;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/MappedFile.hpp"
+
+namespace weatherer {
+/**
+ * @brief The crops that could be planted in one zipcode when the map was built.
+ */
+struct PlantMapEntry {
+  std::string zipcode;
+  int zone;
+  // Indices into the crop names of the map.
+  std::vector<std::size_t> plantable;
+};
+
+/**
+ * @class PlantMap
+ * @brief A precomputed, memory-mapped table of plantable crops by zipcode.
+ *
+ * The map is written by the weatherer_plant_map batch job and answers "what can
+ * be planted in this zipcode?" without geocoding or weather requests. The file
+ * holds a header, the crop names, then one fixed-size row per zipcode sorted by
+ * zipcode: the zipcode as an integer, its hardiness zone, and a bitmask with
+ * one bit per crop. Lookups binary search the mapped rows in place.
+ */
+class PlantMap {
+ private:
+  struct FileHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t crop_count;
+    std::uint32_t entry_count;
+    std::uint32_t words_per_entry;
+    // Size of the NUL separated crop names, padded to 8 bytes.
+    std::uint32_t names_size;
+    std::uint32_t reserved;
+    std::int64_t generated_at;
+  };
+
+  struct RowHeader {
+    std::uint32_t zipcode;
+    std::int32_t zone;
+  };
+
+  static constexpr std::array<char, 8> kMagic_{'W', 'T', 'H', 'R', 'P', 'M', 'A', 'P'};
+  static constexpr std::uint32_t kVersion_ = 1;
+
+  util::MappedFile file_;
+  std::vector<std::string> crop_names_;
+  std::span<const std::byte> rows_;
+  std::size_t row_count_ = 0;
+  std::size_t words_per_entry_ = 0;
+  std::time_t generated_at_ = 0;
+
+  [[nodiscard]] std::size_t GetRowSize() const {
+    return sizeof(RowHeader) + words_per_entry_ * sizeof(std::uint64_t);
+  }
+
+  /**
+   * @brief Parses a five digit zipcode.
+   * @return The zipcode as an integer, or std::nullopt if it is malformed.
+   */
+  [[nodiscard]] static std::optional<std::uint32_t> ParseZipcode(
+      std::string_view zipcode);
+
+ public:
+/**
+ * @param path The map written by PlantMap::Write.
+ * @throws std::runtime_error if the file cannot be mapped, is not a plant map,
+ * or marks a crop that it does not name.
+ */
+  explicit PlantMap(std::filesystem::path const& path);
+
+/**
+ * @brief Writes a plant map, replacing any existing file atomically.
+ * @param path The file to write.
+ * @param crop_names The crops the entries refer to by index.
+ * @param entries One entry per zipcode, in any order.
+ * @param generated_at When the weather the map is based on was fetched.
+ * @throws std::invalid_argument if a zipcode is malformed or a crop index is out of range.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+  static void Write(std::filesystem::path const& path,
+                    std::span<const std::string> crop_names,
+                    std::span<const PlantMapEntry> entries,
+                    std::time_t generated_at);
+
+/**
+ * @brief Looks up the plantable crops of a zipcode.
+ * @param zipcode The five digit zipcode.
+ * @return The zone and plantable crops of the zipcode, or std::nullopt if it is not mapped.
+ */
+  [[nodiscard]] std::optional<PlantMapEntry> Find(std::string_view zipcode) const;
+
+  [[nodiscard]] std::vector<std::string> const& GetCropNames() const {
+    return crop_names_;
+  }
+
+  [[nodiscard]] std::size_t GetZipcodeCount() const { return row_count_; }
+
+  [[nodiscard]] std::time_t GetGeneratedAt() const { return generated_at_; }
+};
+}  // namespace weatherer
@@ -0,0 +1,185 @@
+#include "PvClimatology.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "api/PvDataProcessor.hpp"
+#include "api/PvMetrics.hpp"
+#include "util/Date.hpp"
+#include "util/QuantileSketch.hpp"
+#include "util/RequestArena.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+// The partial aggregate of the years processed by one worker.
+struct YearAggregate {
+  std::vector<weatherer::util::QuantileSketch> daily =
+      std::vector<weatherer::util::QuantileSketch>(366);
+  weatherer::util::QuantileSketch annual{};
+  weatherer::util::RunningMoments annual_moments{};
+  std::array<std::size_t, 366> daily_samples{};
+  std::size_t years = 0;
+
+  void Merge(YearAggregate const& other) {
+    for (std::size_t day = 0; day < daily.size(); ++day) {
+      daily[day].Merge(other.daily[day]);
+      daily_samples[day] += other.daily_samples[day];
+    }
+    annual.Merge(other.annual);
+    annual_moments.Merge(other.annual_moments);
+    years += other.years;
+  }
+};
+
+weatherer::ExceedanceLevels GetExceedanceLevels(
+    weatherer::util::QuantileSketch const& sketch) {
+  // Exceeded with probability p means the (1 - p) quantile.
+  constexpr std::array kQuantiles{0.5, 0.1, 0.01};
+  const std::vector<double> values = sketch.GetQuantiles(kQuantiles);
+  return weatherer::ExceedanceLevels{values[0], values[1], values[2]};
+}
+
+// Days are counted in a leap year, so that February 29th does not shift the
+// dates after it.
+constexpr std::chrono::year kCalendarYear{2000};
+
+// The index of a date (e.g. 2021-03-01) in ClimatologyReport::daily.
+std::size_t GetCalendarDay(std::string const& date) {
+  unsigned month = 0;
+  unsigned day = 0;
+  [[unlikely]] if (std::sscanf(date.c_str(), "%*4d-%2u-%2u", &month, &day) !=
+                   2) {
+    throw std::invalid_argument("Invalid date: " + date);
+  }
+  const std::chrono::year_month_day calendar_day{
+      kCalendarYear, std::chrono::month{month}, std::chrono::day{day}};
+  [[unlikely]] if (!calendar_day.ok()) {
+    throw std::invalid_argument("Invalid date: " + date);
+  }
+  return static_cast<std::size_t>(
+      (std::chrono::sys_days{calendar_day} -
+       std::chrono::sys_days{kCalendarYear / std::chrono::January / 1})
+          .count());
+}
+
+weatherer::util::Date GetNewYear(const int year) {
+  return weatherer::util::Date{std::to_string(year) + "-01-01T00:00"};
+}
+}  // namespace
+
+weatherer::ClimatologyReport weatherer::PvClimatology::Compute(
+    Coordinates const& coords, Options const& options) {
+  using namespace util;
+
+  [[unlikely]] if (options.first_year > options.last_year) {
+    throw std::invalid_argument("First year must not be after the last year");
+  }
+  [[unlikely]] if (options.panel_eff < 0 || options.panel_eff > 1) {
+    throw std::invalid_argument(
+        "Solar panel efficiency must be a value between 0 and 1 (inclusive)");
+  }
+  [[unlikely]] if (options.panel_area <= 0) {
+    throw std::invalid_argument(
+        "Solar panel area must be a value greater than 0");
+  }
+  [[unlikely]] if (Date{} < GetNewYear(options.last_year + 1)) {
+    throw std::invalid_argument("The last year must be complete");
+  }
+
+  const auto year_count =
+      static_cast<std::size_t>(options.last_year - options.first_year + 1);
+  const std::size_t thread_count =
+      std::clamp<std::size_t>(options.threads, 1, year_count);
+
+  std::atomic<std::size_t> next_year{0};
+  std::vector<YearAggregate> aggregates(thread_count);
+  std::mutex error_mutex{};
+  std::exception_ptr error{};
+
+  const auto work = [&](YearAggregate& aggregate) {
+    try {
+      for (std::size_t i = next_year++; i < year_count; i = next_year++) {
+        const int year = options.first_year + static_cast<int>(i);
+        TraceSpan span{"PvClimatology::ProcessYear"};
+        if (span.IsActive()) {
+          span.AddTag("year", std::to_string(year));
+        }
+
+        // Only one year of weather is held per worker at any time, and its
+        // decoding scratch is dropped with the arena before the next year.
+        RequestArena arena{};
+        const PvCollectionPtr collection = PvDataProcessor::CollectData(
+            coords, TimeFrame{GetNewYear(year), GetNewYear(year + 1)});
+        double annual_yield = 0;
+        for (auto const& [date, pv_data] : *collection) {
+          const double yield = PvMetrics::CalculateDailyEnergyYeild(
+              *pv_data, coords, date, options.panel_eff, options.panel_area);
+          const std::size_t day = GetCalendarDay(date);
+          aggregate.daily[day].Add(yield);
+          ++aggregate.daily_samples[day];
+          annual_yield += yield;
+        }
+        aggregate.annual.Add(annual_yield);
+        aggregate.annual_moments.Add(annual_yield);
+        ++aggregate.years;
+      }
+    } catch (...) {
+      std::lock_guard lock{error_mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+      // Let the other workers run out of years.
+      next_year = year_count;
+    }
+  };
+
+  {
+    std::vector<std::jthread> workers{};
+    workers.reserve(thread_count - 1);
+    for (std::size_t i = 1; i < thread_count; ++i) {
+      workers.emplace_back(work, std::ref(aggregates[i]));
+    }
+    work(aggregates.front());
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  YearAggregate& total = aggregates.front();
+  for (std::size_t i = 1; i < aggregates.size(); ++i) {
+    total.Merge(aggregates[i]);
+  }
+
+  ClimatologyReport report{};
+  report.years = total.years;
+  report.daily_samples = total.daily_samples;
+  for (std::size_t day = 0; day < total.daily.size(); ++day) {
+    if (total.daily[day].GetCount() > 0) {
+      report.daily[day] = GetExceedanceLevels(total.daily[day]);
+    }
+  }
+  report.annual = GetExceedanceLevels(total.annual);
+  report.annual_moments = total.annual_moments;
+  return report;
+}
+
+std::string weatherer::PvClimatology::FormatCalendarDay(const std::size_t day) {
+  [[unlikely]] if (day >= ClimatologyReport{}.daily.size()) {
+    throw std::out_of_range("Calendar day out of range");
+  }
+  const std::chrono::year_month_day calendar_day{
+      std::chrono::sys_days{kCalendarYear / std::chrono::January / 1} +
+      std::chrono::days{static_cast<int>(day)}};
+  char buffer[8];
+  std::snprintf(buffer, sizeof(buffer), "%02u-%02u",
+                static_cast<unsigned>(calendar_day.month()),
+                static_cast<unsigned>(calendar_day.day()));
+  return buffer;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "api/models/Coordinates.hpp"
+#include "util/Statistics.hpp"
+
+namespace weatherer {
+/**
+ * @brief Yields at the usual exceedance probabilities, in kWh.
+ *
+ * Pxx is the yield exceeded with a probability of xx%, so P90 is the 10th
+ * percentile of the distribution and P99 the 1st.
+ */
+struct ExceedanceLevels {
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+};
+
+/**
+ * @brief The distribution of PV yield at a site over many historical years.
+ */
+struct ClimatologyReport {
+  // Number of years that contributed.
+  std::size_t years = 0;
+  // Indexed by calendar day, counted as in a leap year (0 for January 1st, 59
+  // for February 29th), so a date keeps its index in every year; see
+  // PvClimatology::FormatCalendarDay.
+  std::array<ExceedanceLevels, 366> daily{};
+  // Number of years that contributed to each calendar day.
+  std::array<std::size_t, 366> daily_samples{};
+  ExceedanceLevels annual{};
+  // Mean, spread and extremes of the annual yield.
+  util::RunningMoments annual_moments{};
+};
+
+/**
+ * @brief Computes P50/P90/P99 yield statistics from decades of archived weather.
+ *
+ * Each year is fetched from the Open-Meteo archive, converted to daily yields
+ * with PvMetrics (the same model PvHandler uses), folded into mergeable
+ * quantile sketches and released. Memory is therefore bounded by the number of
+ * worker threads, not the number of years, and years are processed in parallel.
+ */
+class PvClimatology {
+ public:
+  struct Options {
+    // First and last calendar year to include; the last must be complete.
+    int first_year = 1995;
+    int last_year = 2024;
+    double panel_eff = 0.2;
+    // Units: m^2
+    double panel_area = 1.0;
+    // Years fetched and processed concurrently.
+    std::size_t threads = 4;
+  };
+
+  // Prevent instantiation of the PvClimatology class.
+  PvClimatology() = delete;
+  ~PvClimatology() = delete;
+
+  /**
+   * @brief Computes the yield climatology of a site.
+   * @param coords The geographical coordinates of the site.
+   * @param options The years to cover, the panel and the parallelism.
+   * @return The daily and annual exceedance yields.
+   * @throws std::invalid_argument if the options are out of their domain.
+   * @throws std::runtime_error if the archive cannot be fetched.
+   */
+  [[nodiscard]] static ClimatologyReport Compute(Coordinates const& coords,
+                                                 Options const& options);
+
+  /**
+   * @param day The index of a calendar day in ClimatologyReport::daily.
+   * @return The month and day (e.g. 02-29).
+   * @throws std::out_of_range if day is not below 366.
+   */
+  [[nodiscard]] static std::string FormatCalendarDay(std::size_t day);
+};
+}  // namespace weatherer
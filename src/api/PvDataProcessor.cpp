@@ -1,38 +1,240 @@
 #include "PvDataProcessor.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <ranges>
 
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 
+#include "api/Endpoints.hpp"
+#include "api/HistoricalStore.hpp"
 #include "util/ChunkOperator.hpp"
 #include "util/Date.hpp"
+#include "util/Http.hpp"
+#include "util/Metrics.hpp"
+#include "util/RequestArena.hpp"
+#include "util/Trace.hpp"
+
+weatherer::util::SingleFlight<std::string, weatherer::WeatherJsonPtr>
+    weatherer::PvDataProcessor::weather_flights_{};
+
+weatherer::util::ExpiringCache<std::string, weatherer::WeatherJsonPtr>
+    weatherer::PvDataProcessor::weather_cache_{kWeatherCacheTtl_,
+                                               kWeatherCacheCapacity_};
+
+weatherer::util::SingleFlight<std::string, weatherer::WeatherBodyPtr>
+    weatherer::PvDataProcessor::binary_flights_{};
+
+weatherer::util::ExpiringCache<std::string, weatherer::WeatherBodyPtr>
+    weatherer::PvDataProcessor::binary_cache_{kWeatherCacheTtl_,
+                                              kWeatherCacheCapacity_};
+
+weatherer::ResponseFormat weatherer::PvDataProcessor::response_format_{
+    ResponseFormat::kJson};
+
+const weatherer::util::SpatialGrid weatherer::PvDataProcessor::grid_{};
+
+std::shared_ptr<weatherer::HistoricalStore>
+    weatherer::PvDataProcessor::historical_store_{};
+
+namespace {
+// Decodes a JSON array into a buffer drawn from the current request arena.
+template <typename Ty_>
+std::pmr::vector<Ty_> DecodeSeries(nlohmann::json const& array) {
+  std::pmr::vector<Ty_> series{weatherer::util::RequestArena::GetCurrent()};
+  series.reserve(array.size());
+  for (const auto& value : array) {
+    series.push_back(value.get<Ty_>());
+  }
+  return series;
+}
+
+// Decodes a FlatBuffers vector the same way.
+template <typename Ty_, typename Source_>
+std::pmr::vector<Ty_> DecodeFlatSeries(
+    weatherer::FlatVector<Source_> const& values) {
+  std::pmr::vector<Ty_> series{weatherer::util::RequestArena::GetCurrent()};
+  series.reserve(values.GetSize());
+  for (std::size_t i = 0; i < values.GetSize(); ++i) {
+    series.push_back(static_cast<Ty_>(values[i]));
+  }
+  return series;
+}
+
+// Expands the fixed interval of a FlatBuffers series into its timestamps.
+std::pmr::vector<std::int64_t> DecodeFlatTimes(
+    weatherer::FlatWeatherSeries const& series) {
+  std::pmr::vector<std::int64_t> times{
+      weatherer::util::RequestArena::GetCurrent()};
+  times.reserve(series.GetStepCount());
+  for (std::size_t i = 0; i < series.GetStepCount(); ++i) {
+    times.push_back(series.time +
+                    static_cast<std::int64_t>(i) * series.interval);
+  }
+  return times;
+}
+
+// Requested in this order, which FlatBuffers responses preserve.
+constexpr std::array<const char*, 4> kHourlyVariables{
+    "temperature_2m", "cloud_cover", "wind_speed_10m", "shortwave_radiation"};
+constexpr std::array<const char*, 2> kDailyVariables{"sunrise", "sunset"};
+
+// Checks that a FlatBuffers series holds the requested variables, in order;
+// responses tag every variable, so nothing rests on the order alone.
+void CheckFlatVariables(
+    std::vector<weatherer::FlatWeatherVariable> const& variables,
+    std::span<const char* const> requested) {
+  [[unlikely]] if (variables.size() != requested.size()) {
+    throw std::out_of_range(
+        "The FlatBuffers response lacks the requested variables");
+  }
+  for (std::size_t i = 0; i < requested.size(); ++i) {
+    [[unlikely]] if (weatherer::FlatWeatherReader::FindVariableId(
+                         requested[i]) != variables[i].id) {
+      throw std::out_of_range(std::string{"The FlatBuffers response does not hold "} +
+                              requested[i] + " where it was requested");
+    }
+  }
+}
+
+// The series of one location, decoded from either response format.
+struct DecodedWeather {
+  std::pmr::vector<std::int64_t> hourly_times;
+  std::pmr::vector<std::int64_t> day_starts;
+  std::pmr::vector<std::int64_t> sunrises;
+  std::pmr::vector<std::int64_t> sunsets;
+  std::pmr::vector<double> temperatures;
+  std::pmr::vector<double> cloud_cover_totals;
+  std::pmr::vector<double> wind_speeds;
+  std::pmr::vector<double> shortwave_radiations;
+};
+
+// Chunks decoded series into per-day PvData, recording the mean per-day cost
+// since organize_start.
+weatherer::PvCollectionPtr BuildCollection(
+    DecodedWeather const& weather,
+    weatherer::util::TimeFrame const& time_frame,
+    const std::chrono::steady_clock::time_point organize_start) {
+  using namespace weatherer;
+  using namespace weatherer::util;
+
+  // Calculate the total number of days in the specified time frame.
+  std::time_t total_days =
+      (time_frame.GetEndDate() - time_frame.GetStartDate()) /
+      Date::kSecondsPerDay;
+
+  static Histogram& organize_day_duration = Metrics::GetHistogram(
+      "weatherer_organize_day_duration_seconds",
+      "Time spent organizing one day of weather data.");
+
+  auto data = std::make_shared<std::unordered_map<std::string, PvDataPtr>>();
+
+  // Every day is a view into the decoded buffers, bounded by the timestamps
+  // rather than a fixed 24 hours.
+  const auto boundaries =
+      DayBoundaries::FromTimestamps(weather.hourly_times, weather.day_starts);
+
+  const std::size_t day_count = std::min(
+      static_cast<std::size_t>(std::max<std::time_t>(total_days, 0)),
+      boundaries.GetDayCount());
+  [[unlikely]] if (weather.sunrises.size() < day_count ||
+                   weather.sunsets.size() < day_count) {
+    throw std::out_of_range("Missing sunrise or sunset times");
+  }
+  data->reserve(day_count);
+
+  // Loop through each day in the specified time frame.
+  for (std::size_t i = 0; i < day_count; ++i) {
+    auto pv_data = std::make_shared<PvData>();
+    // Set weather data attributes for the current day using relevant hourly information.
+    pv_data->SetDate(
+        Date{static_cast<std::time_t>(weather.day_starts[i])}.StripTime());
+    pv_data->SetSunriseTime(static_cast<std::time_t>(weather.sunrises[i]));
+    pv_data->SetSunsetTime(static_cast<std::time_t>(weather.sunsets[i]));
+    // The last day runs to the end of the series, as in DayBoundaries.
+    std::int64_t day_end = weather.day_starts[i];
+    if (i + 1 < weather.day_starts.size()) {
+      day_end = weather.day_starts[i + 1];
+    } else if (!weather.hourly_times.empty()) {
+      day_end = std::max(day_end, weather.hourly_times.back() +
+                                      Date::kSecondsPerHour);
+    }
+    pv_data->SetDayBounds(static_cast<std::time_t>(weather.day_starts[i]),
+                          static_cast<std::time_t>(day_end));
+    const std::size_t clock_change =
+        boundaries.FindClockChange(weather.hourly_times, i);
+    pv_data->SetShortwaveRadiation(
+        boundaries.Slice<double>(weather.shortwave_radiations, i),
+        clock_change);
+    pv_data->SetTemperature(boundaries.Slice<double>(weather.temperatures, i),
+                            clock_change);
+    pv_data->SetCloudCoverTotal(
+        boundaries.Slice<double>(weather.cloud_cover_totals, i), clock_change);
+    pv_data->SetWindSpeed(boundaries.Slice<double>(weather.wind_speeds, i),
+                          clock_change);
+
+    // Add the date and corresponding weather data to the map.
+    data->insert({pv_data->GetDate(), pv_data});
+  }
+  // Record the mean per-day cost once, weighted by the number of days.
+  if (day_count > 0) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - organize_start);
+    organize_day_duration.Record(
+        elapsed / static_cast<std::int64_t>(day_count), day_count);
+  }
+  return data;
+}
+}  // namespace
 
 cpr::Response weatherer::PvDataProcessor::IngestData(
-    const Coordinates& coords, util::TimeFrame const& time_frame,
-    const bool historical) {
+    std::span<const Coordinates> coords, util::TimeFrame const& time_frame,
+    const bool historical, const ResponseFormat format) {
+  const util::CoordinateList locations = util::JoinCoordinates(coords);
+  util::TraceSpan span{"PvDataProcessor::IngestData"};
+  if (span.IsActive()) {
+    span.AddTag("locations", std::to_string(coords.size()));
+    span.AddTag("latitudes", locations.latitudes);
+    span.AddTag("longitudes", locations.longitudes);
+    span.AddTag("time_frame", time_frame.GetStartDate().StripTime() + "/" +
+                                  time_frame.GetEndDate().StripTime());
+    span.AddTag("historical", historical ? "true" : "false");
+    span.AddTag("format",
+                format == ResponseFormat::kFlatBuffers ? "flatbuffers" : "json");
+  }
+
   cpr::Parameters prams{};
   // Set the parameters for the HTTP request.
-  prams.Add(cpr::Parameter{"longitude", std::to_string(coords.GetLongitude())});
-  prams.Add(cpr::Parameter{"latitude", std::to_string(coords.GetLatitude())});
-  prams.Add(cpr::Parameter{"daily", "sunrise"});
-  prams.Add(cpr::Parameter{"daily", "sunset"});
-  prams.Add(cpr::Parameter{"hourly", "temperature_2m"});
-  prams.Add(cpr::Parameter{"hourly", "cloud_cover"});
-  prams.Add(cpr::Parameter{"hourly", "wind_speed_10m"});
-  prams.Add(cpr::Parameter{"hourly", "shortwave_radiation"});
+  prams.Add(cpr::Parameter{"longitude", locations.longitudes});
+  prams.Add(cpr::Parameter{"latitude", locations.latitudes});
+  for (const char* variable : kDailyVariables) {
+    prams.Add(cpr::Parameter{"daily", variable});
+  }
+  for (const char* variable : kHourlyVariables) {
+    prams.Add(cpr::Parameter{"hourly", variable});
+  }
   prams.Add(
       cpr::Parameter{"start_date", time_frame.GetStartDate().StripTime()});
   prams.Add(cpr::Parameter{"end_date", time_frame.GetEndDate().StripTime()});
   prams.Add(cpr::Parameter{"temperature_unit", "celsius"});
   prams.Add(cpr::Parameter{"timeformat", "unixtime"});
   prams.Add(cpr::Parameter{"timezone", "auto"});
+  if (format == ResponseFormat::kFlatBuffers) {
+    prams.Add(cpr::Parameter{"format", "flatbuffers"});
+  }
 
   // Perform the HTTP GET request to the regular Open-Metro API.
-  cpr::Response res = !historical
-                          ? cpr::Get(cpr::Url{kApiUrl_}, prams)
-                          : cpr::Get(cpr::Url{kHistoricalApiUrl_}, prams);
+  cpr::Response res =
+      util::Http::Get(!historical ? Endpoints::GetForecastUrl()
+                                  : Endpoints::GetHistoricalUrl(),
+                      prams);
 
   // If the status code is not 200, throw an exception.
   if (res.status_code != 200) {
@@ -43,57 +245,126 @@ cpr::Response weatherer::PvDataProcessor::IngestData(
   return res;
 }
 
-[[nodiscard]] weatherer::PvCollectionPtr
-weatherer::PvDataProcessor::OrganizeWeatherData(
-    const std::string& response, const util::TimeFrame& time_frame) {
-  using namespace util;
-  using Json = nlohmann::json;
+std::string weatherer::PvDataProcessor::MakeRequestKey(
+    std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+    const bool historical) {
+  const util::CoordinateList locations = util::JoinCoordinates(coords);
+  // Mirror the values sent to the API so that equal keys imply equal requests.
+  return (historical ? Endpoints::GetHistoricalUrl()
+                     : Endpoints::GetForecastUrl()) +
+         "|" +
+         locations.latitudes + ";" + locations.longitudes + "|" +
+         "sunrise,sunset;temperature_2m,cloud_cover,wind_speed_10m,"
+         "shortwave_radiation|" +
+         time_frame.GetStartDate().StripTime() + "/" +
+         time_frame.GetEndDate().StripTime();
+}
 
-  // Calculate the total number of days in the specified time frame.
-  std::time_t total_days =
-      (time_frame.GetEndDate() - time_frame.GetStartDate()) /
-      Date::kSecondsPerDay;
+std::vector<weatherer::WeatherJsonPtr> weatherer::PvDataProcessor::FetchData(
+    std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+    const bool historical) {
+  std::vector<Coordinates> snapped{};
+  snapped.reserve(coords.size());
+  std::ranges::transform(
+      coords, std::back_inserter(snapped),
+      [](Coordinates const& coord) { return grid_.SnapToCenter(coord); });
 
-  auto data = std::make_shared<std::unordered_map<std::string, PvDataPtr>>();
-  // Parse the JSON response.
-  Json json = Json::parse(response);
-
-  const auto hourly = json.at("hourly");
-  const auto daily = json.at("daily");
-
-  const std::size_t split_amount = total_days + 1;
-  // Create chunked vectors for each weather attribute.
-  const auto shortwave_radiations =
-      ChunkVector<int, 24>(hourly.at("shortwave_radiation"), split_amount);
-  const auto temperatures =
-      ChunkVector<double, 24>(hourly.at("temperature_2m"), split_amount);
-  const auto cloud_cover_totals =
-      ChunkVector<int, 24>(hourly.at("cloud_cover"), split_amount);
-  const auto wind_speeds =
-      ChunkVector<double, 24>(hourly.at("wind_speed_10m"), split_amount);
+  // Requests beyond the executed fetches were coalesced into one in flight.
+  static util::Counter& requests = util::Metrics::GetCounter(
+      "weatherer_weather_requests_total",
+      "Weather data requests, including coalesced ones.", {{"source", "pv"}});
+  static util::Counter& fetches = util::Metrics::GetCounter(
+      "weatherer_weather_fetches_total",
+      "Weather data requests that reached the API.", {{"source", "pv"}});
+  static util::Counter& cache_hits = util::Metrics::GetCounter(
+      "weatherer_weather_cache_hits_total",
+      "Weather data requests answered from the response cache.",
+      {{"source", "pv"}});
+  requests.Increment();
 
-  // Loop through each day in the specified time frame.
-  for (const int i : std::ranges::views::iota(0, total_days)) {
-    auto pv_data = std::make_shared<PvData>();
-    // Set weather data attributes for the current day using relevant hourly information.
-    pv_data->SetDate(
-        Date{static_cast<std::time_t>(daily.at("time").at(i))}.StripTime());
-    pv_data->SetSunriseTime(daily.at("sunrise").at(i));
-    pv_data->SetSunsetTime(daily.at("sunset").at(i));
-    pv_data->SetShortwaveRadiation(shortwave_radiations.at(i));
-    pv_data->SetTemperature(temperatures.at(i));
-    pv_data->SetCloudCoverTotal(cloud_cover_totals.at(i));
-    pv_data->SetWindSpeed(wind_speeds.at(i));
+  const std::string key = MakeRequestKey(snapped, time_frame, historical);
+  WeatherJsonPtr response{};
+  if (auto cached = weather_cache_.Get(key)) {
+    cache_hits.Increment();
+    response = std::move(*cached);
+  } else {
+    response = weather_flights_.Do(key, [&] {
+      fetches.Increment();
+      const cpr::Response res = IngestData(snapped, time_frame, historical);
+      util::TraceSpan span{"PvDataProcessor::ParseWeatherResponse"};
+      if (span.IsActive()) {
+        span.AddTag("bytes", std::to_string(res.text.size()));
+      }
+      static util::Histogram& parse_duration = util::Metrics::GetHistogram(
+          "weatherer_weather_parse_duration_seconds",
+          "Time spent parsing weather API responses.", {{"source", "pv"}});
+      const util::ScopedTimer timer{parse_duration};
+      auto parsed = std::make_shared<const nlohmann::json>(
+          nlohmann::json::parse(res.text));
+      weather_cache_.Put(key, parsed);
+      return parsed;
+    });
+  }
 
-    // Add the date and corresponding weather data to the map.
-    data->insert({pv_data->GetDate(), pv_data});
+  // A single location yields an object, multiple locations an array of them.
+  const std::size_t location_count = response->is_array() ? response->size() : 1;
+  [[unlikely]] if (location_count != coords.size()) {
+    throw std::runtime_error(
+        "Expected " + std::to_string(coords.size()) +
+        " locations in the batched response, got " +
+        std::to_string(location_count));
   }
-  return data;
+  if (!response->is_array()) {
+    return {response};
+  }
+
+  // Alias each location into the shared response to avoid copying it.
+  std::vector<WeatherJsonPtr> locations{};
+  locations.reserve(response->size());
+  for (auto const& location : *response) {
+    locations.emplace_back(response, &location);
+  }
+  return locations;
 }
 
-[[nodiscard]] weatherer::PvCollectionPtr
-weatherer::PvDataProcessor::CollectData(
-    const Coordinates& coords, util::TimeFrame const& time_frame) {
+weatherer::WeatherBodyPtr weatherer::PvDataProcessor::FetchBinaryData(
+    std::span<const Coordinates> coords, const util::TimeFrame& time_frame,
+    const bool historical) {
+  std::vector<Coordinates> snapped{};
+  snapped.reserve(coords.size());
+  std::ranges::transform(
+      coords, std::back_inserter(snapped),
+      [](Coordinates const& coord) { return grid_.SnapToCenter(coord); });
+
+  static util::Counter& requests = util::Metrics::GetCounter(
+      "weatherer_weather_requests_total",
+      "Weather data requests, including coalesced ones.", {{"source", "pv"}});
+  static util::Counter& fetches = util::Metrics::GetCounter(
+      "weatherer_weather_fetches_total",
+      "Weather data requests that reached the API.", {{"source", "pv"}});
+  static util::Counter& cache_hits = util::Metrics::GetCounter(
+      "weatherer_weather_cache_hits_total",
+      "Weather data requests answered from the response cache.",
+      {{"source", "pv"}});
+  requests.Increment();
+
+  const std::string key = MakeRequestKey(snapped, time_frame, historical);
+  if (auto cached = binary_cache_.Get(key)) {
+    cache_hits.Increment();
+    return std::move(*cached);
+  }
+  return binary_flights_.Do(key, [&] {
+    fetches.Increment();
+    cpr::Response res = IngestData(snapped, time_frame, historical,
+                                   ResponseFormat::kFlatBuffers);
+    auto body = std::make_shared<const std::string>(std::move(res.text));
+    binary_cache_.Put(key, body);
+    return body;
+  });
+}
+
+std::vector<weatherer::PvDataProcessor::FetchSegment>
+weatherer::PvDataProcessor::SplitTimeFrame(util::TimeFrame const& time_frame) {
   using namespace util;
 
   Date today{};
@@ -108,37 +379,208 @@ weatherer::PvDataProcessor::CollectData(
   // If the time frame covers a period starting and ending in the past
   if ((end_date - start_date) / Date::kSecondsPerDay >= 14 &&
       (today - end_date) / Date::kSecondsPerDay >= 5) {
-    const std::string response = IngestData(coords, time_frame, true).text;
-    return OrganizeWeatherData(response, time_frame);
+    return {FetchSegment{time_frame, true}};
   }
 
   // If the time frame starts in the past and ends in the future
   if ((end_date - start_date) / Date::kSecondsPerDay >= 14 &&
       (today - end_date) / Date::kSecondsPerDay <= 5) {
     const auto five_days_ago = today - (5 * Date::kSecondsPerDay);
-    const std::string first_reponse =
-        IngestData(
-            coords, TimeFrame{start_date.ToString(), five_days_ago.ToString()},
-            true)
-            .text;
-    const std::string second_reponse =
-        IngestData(coords,
-                      TimeFrame{five_days_ago.ToString(), end_date.ToString()})
-            .text;
-
-    // Generate bulk data for each period.
-    const PvCollectionPtr first_data = OrganizeWeatherData(
-        first_reponse,
-        TimeFrame{start_date.ToString(),
-                  (today - (5 * Date::kSecondsPerDay)).ToString()});
-    const PvCollectionPtr second_data = OrganizeWeatherData(
-        second_reponse,
-        TimeFrame{five_days_ago.ToString(), end_date.ToString()});
-
-    // Combine data from both periods and return.
-    first_data->insert(second_data->begin(), second_data->end());
-    return first_data;
-  }
-  // If the time frame starts and ends in the future, fetch and generate bulk data for the future.
-  return OrganizeWeatherData(IngestData(coords, time_frame).text, time_frame);
+    return {FetchSegment{TimeFrame{start_date.ToString(),
+                                   five_days_ago.ToString()},
+                         true},
+            FetchSegment{
+                TimeFrame{five_days_ago.ToString(), end_date.ToString()},
+                false}};
+  }
+  // If the time frame starts and ends in the future, fetch it from the forecast API.
+  return {FetchSegment{time_frame, false}};
+}
+
+[[nodiscard]] weatherer::PvCollectionPtr
+weatherer::PvDataProcessor::OrganizeWeatherData(
+    const nlohmann::json& json, const util::TimeFrame& time_frame) {
+  using namespace util;
+  TraceSpan span{"PvDataProcessor::OrganizeWeatherData"};
+  if (span.IsActive()) {
+    span.AddTag("time_frame", time_frame.GetStartDate().StripTime() + "/" +
+                                  time_frame.GetEndDate().StripTime());
+  }
+  const auto organize_start = std::chrono::steady_clock::now();
+
+  const auto& hourly = json.at("hourly");
+  const auto& daily = json.at("daily");
+
+  // Decode each series once into a contiguous buffer.
+  const DecodedWeather weather{
+      DecodeSeries<std::int64_t>(hourly.at("time")),
+      DecodeSeries<std::int64_t>(daily.at("time")),
+      DecodeSeries<std::int64_t>(daily.at("sunrise")),
+      DecodeSeries<std::int64_t>(daily.at("sunset")),
+      DecodeSeries<double>(hourly.at("temperature_2m")),
+      DecodeSeries<double>(hourly.at("cloud_cover")),
+      DecodeSeries<double>(hourly.at("wind_speed_10m")),
+      DecodeSeries<double>(hourly.at("shortwave_radiation"))};
+  return BuildCollection(weather, time_frame, organize_start);
+}
+
+[[nodiscard]] weatherer::PvCollectionPtr
+weatherer::PvDataProcessor::OrganizeWeatherData(
+    FlatWeatherLocation const& location, const util::TimeFrame& time_frame) {
+  using namespace util;
+  TraceSpan span{"PvDataProcessor::OrganizeWeatherData"};
+  if (span.IsActive()) {
+    span.AddTag("time_frame", time_frame.GetStartDate().StripTime() + "/" +
+                                  time_frame.GetEndDate().StripTime());
+    span.AddTag("format", "flatbuffers");
+  }
+  const auto organize_start = std::chrono::steady_clock::now();
+
+  [[unlikely]] if (!location.hourly || !location.daily) {
+    throw std::out_of_range(
+        "The FlatBuffers response lacks the requested variables");
+  }
+  CheckFlatVariables(location.hourly->variables, kHourlyVariables);
+  CheckFlatVariables(location.daily->variables, kDailyVariables);
+  const auto& hourly = location.hourly->variables;
+  const auto& daily = location.daily->variables;
+
+  // Values are read straight out of the response; only the copy into the
+  // request arena remains.
+  const DecodedWeather weather{
+      DecodeFlatTimes(*location.hourly),
+      DecodeFlatTimes(*location.daily),
+      DecodeFlatSeries<std::int64_t>(daily[0].values_int64),
+      DecodeFlatSeries<std::int64_t>(daily[1].values_int64),
+      DecodeFlatSeries<double>(hourly[0].values),
+      DecodeFlatSeries<double>(hourly[1].values),
+      DecodeFlatSeries<double>(hourly[2].values),
+      DecodeFlatSeries<double>(hourly[3].values)};
+  return BuildCollection(weather, time_frame, organize_start);
+}
+
+[[nodiscard]] weatherer::PvCollectionPtr
+weatherer::PvDataProcessor::CollectData(
+    const Coordinates& coords, util::TimeFrame const& time_frame,
+    const ResponseFormat format) {
+  return CollectBatchData(std::span{&coords, 1}, time_frame, kDefaultBatchSize,
+                          format)
+      .front();
+}
+
+std::vector<weatherer::PvCollectionPtr>
+weatherer::PvDataProcessor::CollectBatchData(
+    std::span<const Coordinates> sites, util::TimeFrame const& time_frame,
+    const std::size_t max_batch_size, const ResponseFormat format) {
+  static util::Counter& store_hits = util::Metrics::GetCounter(
+      "weatherer_historical_store_hits_total",
+      "Historical weather requests answered from the local store.");
+  static util::Counter& store_append_failures = util::Metrics::GetCounter(
+      "weatherer_historical_store_append_failures_total",
+      "Fetched historical weather that could not be written to the local store.");
+  std::vector<PvCollectionPtr> collections(sites.size());
+  const auto merge = [&collections](const std::size_t site,
+                                    PvCollectionPtr const& data) {
+    PvCollectionPtr& collection = collections[site];
+    if (!collection) {
+      collection = data;
+    } else {
+      // Combine data from both periods.
+      collection->insert(data->begin(), data->end());
+    }
+  };
+
+  for (auto const& [segment_frame, historical] : SplitTimeFrame(time_frame)) {
+    const bool use_store = historical && historical_store_ != nullptr;
+    // Only the sites whose days are not all stored locally are fetched.
+    std::vector<Coordinates> pending{};
+    std::vector<std::size_t> pending_sites{};
+    pending.reserve(sites.size());
+    pending_sites.reserve(sites.size());
+    for (std::size_t site = 0; site < sites.size(); ++site) {
+      if (use_store) {
+        if (const PvCollectionPtr stored = historical_store_->Load(
+                grid_.Snap(sites[site]), segment_frame)) {
+          store_hits.Increment();
+          merge(site, stored);
+          continue;
+        }
+      }
+      pending.push_back(sites[site]);
+      pending_sites.push_back(site);
+    }
+
+    std::size_t offset = 0;
+    for (const auto batch : util::ChunkCoordinates(pending, max_batch_size)) {
+      // Demultiplex the batched response into per-site collections.
+      std::vector<PvCollectionPtr> organized{};
+      organized.reserve(batch.size());
+      if (format == ResponseFormat::kFlatBuffers) {
+        const WeatherBodyPtr body =
+            FetchBinaryData(batch, segment_frame, historical);
+        const std::vector<FlatWeatherLocation> locations =
+            FlatWeatherReader::Parse(std::as_bytes(std::span{*body}));
+        [[unlikely]] if (locations.size() != batch.size()) {
+          throw std::runtime_error(
+              "Expected " + std::to_string(batch.size()) +
+              " locations in the batched response, got " +
+              std::to_string(locations.size()));
+        }
+        for (const auto& location : locations) {
+          organized.push_back(OrganizeWeatherData(location, segment_frame));
+        }
+      } else {
+        for (const auto& response :
+             FetchData(batch, segment_frame, historical)) {
+          organized.push_back(OrganizeWeatherData(*response, segment_frame));
+        }
+      }
+      for (std::size_t i = 0; i < organized.size(); ++i) {
+        const PvCollectionPtr& data = organized[i];
+        if (use_store) {
+          // The store only saves future fetches; failing to write it must not
+          // lose the data just fetched. Failures are counted, and the reason
+          // is kept on the trace.
+          util::TraceSpan append_span{"PvDataProcessor::AppendToStore"};
+          try {
+            historical_store_->Append(grid_.Snap(batch[i]), *data);
+          } catch (const std::exception& error) {
+            store_append_failures.Increment();
+            if (append_span.IsActive()) {
+              append_span.AddTag("error", error.what());
+            }
+          }
+        }
+        merge(pending_sites[offset + i], data);
+      }
+      offset += batch.size();
+    }
+  }
+  return collections;
+}
+
+std::vector<weatherer::PvCollectionPtr>
+weatherer::PvDataProcessor::CollectClusteredData(
+    std::span<const Coordinates> sites, util::TimeFrame const& time_frame) {
+  const util::SiteClusters clusters = grid_.Cluster(sites);
+
+  std::vector<Coordinates> centers{};
+  centers.reserve(clusters.size());
+  for (const auto& cell : clusters | std::views::keys) {
+    centers.push_back(grid_.GetCellCenter(cell));
+  }
+
+  // Fetch and organize each grid cell once, then fan it out to its members.
+  const std::vector<PvCollectionPtr> cell_collections =
+      CollectBatchData(centers, time_frame);
+
+  std::vector<PvCollectionPtr> collections(sites.size());
+  std::size_t cell_index = 0;
+  for (const auto& members : clusters | std::views::values) {
+    for (const std::size_t member : members) {
+      collections[member] = cell_collections[cell_index];
+    }
+    ++cell_index;
+  }
+  return collections;
 }
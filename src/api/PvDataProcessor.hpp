@@ -1,18 +1,42 @@
 #pragma once
+#include <chrono>
 #include <map>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <cpr/response.h>
+#include <nlohmann/json_fwd.hpp>
 
+#include "api/FlatWeatherReader.hpp"
 #include "api/models/Coordinates.hpp"
 #include "api/models/PvData.hpp"
 #include "util/Date.hpp"
+#include "util/ExpiringCache.hpp"
+#include "util/SingleFlight.hpp"
+#include "util/SpatialGrid.hpp"
 
 namespace weatherer {
 
-using PvDataPtr = std::shared_ptr<PvData>;
-using PvCollectionPtr = std::shared_ptr<std::unordered_map<std::string, PvDataPtr>>;
+class HistoricalStore;
+
+using PvDataPtr = std::shared_ptr<const PvData>;
+using PvCollection = std::unordered_map<std::string, PvDataPtr>;
+using PvCollectionPtr = std::shared_ptr<PvCollection>;
+// A published collection, never modified again; see util::Snapshot.
+using PvSnapshot = std::shared_ptr<const PvCollection>;
+using WeatherJsonPtr = std::shared_ptr<const nlohmann::json>;
+using WeatherBodyPtr = std::shared_ptr<const std::string>;
+
+/**
+ * @brief The encoding in which weather responses are requested.
+ */
+enum class ResponseFormat {
+  kJson,
+  // Open-Meteo's binary format, read in place without parsing text.
+  kFlatBuffers
+};
 
 /**
  * @class PvDataProcessor
@@ -24,29 +48,118 @@ using PvCollectionPtr = std::shared_ptr<std::unordered_map<std::string, PvDataPt
  * Note: This class should not typically be used directly, but rather through the PvHandler class.
  */
 class PvDataProcessor {
-  static constexpr std::string_view kApiUrl_{
-      "https://api.open-meteo.com/v1/forecast"};
-  static constexpr std::string_view kHistoricalApiUrl_{
-      "https://archive-api.open-meteo.com/v1/archive"};
+  // Shares identical in-flight weather requests between concurrent callers.
+  static util::SingleFlight<std::string, WeatherJsonPtr> weather_flights_;
+  // Parsed forecast and archive responses by request key; a query whose key
+  // has not expired is answered without a request.
+  static util::ExpiringCache<std::string, WeatherJsonPtr> weather_cache_;
+  // The same for responses requested as FlatBuffers, kept as raw bodies.
+  static util::SingleFlight<std::string, WeatherBodyPtr> binary_flights_;
+  static util::ExpiringCache<std::string, WeatherBodyPtr> binary_cache_;
+  // The format used when a caller does not ask for one.
+  static ResponseFormat response_format_;
+  // Snaps request locations onto the weather model grid.
+  static const util::SpatialGrid grid_;
+  // Serves previously fetched historical days without a request, if set.
+  static std::shared_ptr<HistoricalStore> historical_store_;
+
+  // Short enough that a forecast is served at most a quarter of an hour after
+  // a model update, long enough to absorb bursts of queries for one location.
+  static constexpr std::chrono::minutes kWeatherCacheTtl_{15};
+  static constexpr std::size_t kWeatherCacheCapacity_ = 1024;
+
+  /**
+   * @brief A contiguous part of a requested time frame served by a single API.
+   */
+  struct FetchSegment {
+    util::TimeFrame time_frame;
+    bool historical;
+  };
 
 /**
  * @brief Fetches current weather data from the Open-Meteo API.
  * @param coords The coordinates for which weather data is to be fetched.
  * @param time_frame The time frame for which data is requested.
+ * @param historical Whether the historical archive API should be queried.
+ * @param format The encoding of the response body.
  * @return cpr::Response containing the HTTP response.
  * @throws std::runtime_error if an error occurs during the HTTP request or if the response status code is not 200.
  *
  * Constructs a request to the Open-Meteo API to retrieve current weather
- * data for a specified geographical location (latitude and longitude) within a given
+ * data for one or more geographical locations (latitude and longitude) within a given
  * time frame. The fetched data includes details such as sunrise and sunset times,
- * temperature, cloud cover, wind speed, direct and diffuse radiation.
+ * temperature, cloud cover, wind speed, direct and diffuse radiation. When several
+ * locations are requested the response body is a JSON array with one entry per location.
  */
   [[nodiscard]] static cpr::Response IngestData(
-      const Coordinates& coords, const util::TimeFrame& time_frame, bool historical = false);
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame, bool historical = false,
+      ResponseFormat format = ResponseFormat::kJson);
+
+/**
+ * @brief Fetches and parses weather data, sharing identical in-flight requests.
+ * @param coords The coordinates for which weather data is to be fetched.
+ * @param time_frame The time frame for which data is requested.
+ * @param historical Whether the historical archive API should be queried.
+ * @return One WeatherJsonPtr per location holding its parsed, read-only JSON response.
+ * @throws std::runtime_error if the underlying HTTP request fails or the batched
+ * response does not contain one entry per location.
+ *
+ * The coordinates are snapped to the center of their weather grid cell before
+ * the request is made. Requests are keyed on the normalized query (snapped
+ * coordinates, requested variables, date window and endpoint). Concurrent callers
+ * with the same key share a single HTTP request and a single parse of its body.
+ */
+  [[nodiscard]] static std::vector<WeatherJsonPtr> FetchData(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame, bool historical = false);
+
+/**
+ * @brief Fetches weather data as FlatBuffers, sharing identical in-flight requests.
+ * @param coords The coordinates for which weather data is to be fetched.
+ * @param time_frame The time frame for which data is requested.
+ * @param historical Whether the historical archive API should be queried.
+ * @return The raw response body, holding one message per location.
+ * @throws std::runtime_error if the underlying HTTP request fails.
+ *
+ * Snaps, keys, coalesces and caches requests as FetchData does. The body is
+ * not parsed; FlatWeatherReader reads it in place.
+ */
+  [[nodiscard]] static WeatherBodyPtr FetchBinaryData(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame, bool historical = false);
+
+/**
+ * @brief Builds the single-flight key identifying a weather request.
+ * @param coords The coordinates of the request.
+ * @param time_frame The time frame of the request.
+ * @param historical Whether the historical archive API is queried.
+ * @return The normalized request key.
+ */
+  [[nodiscard]] static std::string MakeRequestKey(
+      std::span<const Coordinates> coords, const util::TimeFrame& time_frame, bool historical);
+
+/**
+ * @brief Splits a time frame into the parts served by the historical and forecast APIs.
+ * @param time_frame The requested time frame.
+ * @return The segments to fetch, in chronological order.
+ *
+ * If the time frame covers a period starting and ending in the past, it is served
+ * by the historical API. If it starts in the past and ends in the future, the part
+ * up to five days ago is served by the historical API and the remainder by the
+ * forecast API. Otherwise the forecast API serves the whole time frame.
+ */
+  [[nodiscard]] static std::vector<FetchSegment> SplitTimeFrame(
+      const util::TimeFrame& time_frame);
+
+ public:
+  // Default number of locations packed into a single batched request.
+  static constexpr std::size_t kDefaultBatchSize = 50;
+
+  // Prevent instantiation of the PvDataProcessor class.
+  PvDataProcessor() = delete;
+  ~PvDataProcessor() = delete;
 
 /**
  * @brief Generates bulk weather data from the fetched JSON response.
- * @param response The JSON response containing weather data.
+ * @param json The parsed JSON response containing weather data.
  * @param time_frame The time frame for which data is requested.
  * @return PvCollectionPtr containing bulk weather data.
  * @throws std::out_of_range if the expected JSON structure is not present.
@@ -57,18 +170,27 @@ class PvDataProcessor {
  * details such as sunrise and sunset times, diffuse and direct radiation, temperature,
  * cloud cover, and wind speed for each day.
  */
-  [[nodiscard]] static PvCollectionPtr OrganizeWeatherData(const std::string& response,
+  [[nodiscard]] static PvCollectionPtr OrganizeWeatherData(const nlohmann::json& json,
                                           const util::TimeFrame& time_frame);
 
- public:
-  // Prevent instantiation of the PvDataProcessor class.
-  PvDataProcessor() = delete;
-  ~PvDataProcessor() = delete;
+/**
+ * @brief Generates bulk weather data from one location of a FlatBuffers response.
+ * @param location The location, as read by FlatWeatherReader.
+ * @param time_frame The time frame for which data is requested.
+ * @return PvCollectionPtr containing bulk weather data.
+ * @throws std::out_of_range if a requested series is missing or too short.
+ *
+ * Produces the same collection as the JSON overload. Variables are matched by
+ * the order in which IngestData requests them.
+ */
+  [[nodiscard]] static PvCollectionPtr OrganizeWeatherData(FlatWeatherLocation const& location,
+                                          const util::TimeFrame& time_frame);
 
 /**
  * @brief Aggregates all weather data based on the specified time frame.
  * @param coords The coordinates for which data is to be aggregated.
  * @param time_frame The time frame for which data is requested.
+ * @param format The encoding in which responses are requested.
  * @return PvCollectionPtr containing aggregated weather data.
  *
  * Aggregates weather data based on different scenarios. If the time frame
@@ -81,6 +203,87 @@ class PvDataProcessor {
  * to GenerateBulkData, incorporating historical data and handling future periods.
  */
   [[nodiscard]] static PvCollectionPtr CollectData(
-      const Coordinates& coords, const util::TimeFrame& time_frame);
+      const Coordinates& coords, const util::TimeFrame& time_frame,
+      ResponseFormat format = GetResponseFormat());
+
+/**
+ * @brief Aggregates weather data for many sites using multi-location requests.
+ * @param sites The coordinates of every site.
+ * @param time_frame The time frame for which data is requested.
+ * @param max_batch_size The maximum number of locations packed into one request.
+ * @param format The encoding in which responses are requested.
+ * @return One PvCollectionPtr per site, in the same order as sites.
+ *
+ * Packs up to max_batch_size sites into each Open-Meteo request, further limited
+ * by the URL length, and demultiplexes every response into per-site collections.
+ * Time frames are split between the historical and forecast APIs as in CollectData.
+ * Historical segments are served from the historical store when it holds every
+ * day of them, and fetched historical days are appended to it. Failed appends
+ * do not fail the request; they are counted in
+ * weatherer_historical_store_append_failures_total and traced with their reason.
+ */
+  [[nodiscard]] static std::vector<PvCollectionPtr> CollectBatchData(
+      std::span<const Coordinates> sites, const util::TimeFrame& time_frame,
+      std::size_t max_batch_size = kDefaultBatchSize,
+      ResponseFormat format = GetResponseFormat());
+
+/**
+ * @brief Aggregates weather data for many sites, fetching once per grid cell.
+ * @param sites The coordinates of every site.
+ * @param time_frame The time frame for which data is requested.
+ * @return One PvCollectionPtr per site, in the same order as sites.
+ *
+ * Groups the sites by weather grid cell and collects the data of every cell
+ * once, at the cell center, packing the cells into batched requests. Sites in the same cell share the same collection,
+ * which must therefore be treated as read-only.
+ */
+  [[nodiscard]] static std::vector<PvCollectionPtr> CollectClusteredData(
+      std::span<const Coordinates> sites, const util::TimeFrame& time_frame);
+
+/**
+ * @return The number of weather requests that were actually sent.
+ */
+  [[nodiscard]] static std::size_t GetFetchCount() {
+    return weather_flights_.GetExecutedCount() +
+           binary_flights_.GetExecutedCount();
+  }
+
+/**
+ * @return The number of weather requests served by joining an identical in-flight request.
+ */
+  [[nodiscard]] static std::size_t GetDeduplicatedFetchCount() {
+    return weather_flights_.GetDeduplicatedCount() +
+           binary_flights_.GetDeduplicatedCount();
+  }
+
+/**
+ * @brief Sets the local store used for historical weather.
+ * @param store The store, or nullptr to always fetch historical weather.
+ *
+ * Note: This must be called before any data is collected.
+ */
+  static void SetHistoricalStore(std::shared_ptr<HistoricalStore> store) {
+    historical_store_ = std::move(store);
+  }
+
+/**
+ * @brief Drops every cached weather response, forcing the next request to fetch.
+ */
+  static void ClearWeatherCache() {
+    weather_cache_.Clear();
+    binary_cache_.Clear();
+  }
+
+/**
+ * @brief Sets the format in which weather responses are requested by default.
+ * @param format The format; JSON unless set.
+ */
+  static void SetResponseFormat(const ResponseFormat format) {
+    response_format_ = format;
+  }
+
+  [[nodiscard]] static ResponseFormat GetResponseFormat() {
+    return response_format_;
+  }
 };
 }  // namespace weatherer
@@ -1,10 +1,15 @@
 #include "PvHandler.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <ostream>
+#include <ranges>
+#include <stdexcept>
 // #include <iomanip>
 // #include <print>
 
 #include "PvMetrics.hpp"
+#include "util/Trace.hpp"
 
 
 /**
@@ -17,6 +22,18 @@ weatherer::PvHandler::PvHandler(Coordinates const& coords,
       time_frame_{time_frame},
       pv_collection_(PvDataProcessor::CollectData(coords, time_frame)) {}
 
+/**
+ * @param coords The geographical coordinates.
+ * @param time_frame The time frame covered by the collection.
+ * @param pv_collection The collected weather data.
+*/
+weatherer::PvHandler::PvHandler(Coordinates const& coords,
+                                util::TimeFrame const& time_frame,
+                                PvSnapshot pv_collection)
+    : coords_{coords},
+      time_frame_{time_frame},
+      pv_collection_(std::move(pv_collection)) {}
+
 weatherer::PvHandler::~PvHandler() = default;
 
 weatherer::PvHandler::PvHandler(const PvHandler& other) = default;
@@ -24,7 +41,11 @@ weatherer::PvHandler::PvHandler(const PvHandler& other) = default;
 weatherer::PvHandler::PvHandler(PvHandler&& other) noexcept
     : coords_(std::move(other.coords_)),
       time_frame_(std::move(other.time_frame_)),
-      pv_collection_(std::move(other.pv_collection_)) {}
+      pv_collection_(std::move(other.pv_collection_)),
+      window_days_(other.window_days_),
+      rollup_(std::move(other.rollup_)),
+      rollup_panel_(other.rollup_panel_),
+      rollup_pending_(std::move(other.rollup_pending_)) {}
 
 weatherer::PvHandler& weatherer::PvHandler::operator=(const PvHandler& other) {
   if (this == &other)
@@ -32,6 +53,10 @@ weatherer::PvHandler& weatherer::PvHandler::operator=(const PvHandler& other) {
   coords_ = other.coords_;
   time_frame_ = other.time_frame_;
   pv_collection_ = other.pv_collection_;
+  window_days_ = other.window_days_;
+  rollup_ = other.rollup_;
+  rollup_panel_ = other.rollup_panel_;
+  rollup_pending_ = other.rollup_pending_;
   return *this;
 }
 
@@ -42,6 +67,10 @@ weatherer::PvHandler& weatherer::PvHandler::operator=(
   coords_ = other.coords_;
   time_frame_ = other.time_frame_;
   pv_collection_ = std::move(other.pv_collection_);
+  window_days_ = other.window_days_;
+  rollup_ = std::move(other.rollup_);
+  rollup_panel_ = other.rollup_panel_;
+  rollup_pending_ = std::move(other.rollup_pending_);
   return *this;
 }
 
@@ -64,7 +93,8 @@ bool weatherer::PvHandler::ValidateSolarPanelArea(const double panel_area) {
 // }
 
 void weatherer::PvHandler::OutputData(std::ostream& os) const {
-  for (const auto& [key, value] : *pv_collection_) {
+  const PvSnapshot collection = pv_collection_.Load();
+  for (const auto& [key, value] : *collection) {
     os << key << "\n" << *value << "\n";
   }
 }
@@ -93,7 +123,131 @@ void weatherer::PvHandler::OutputData(std::ostream& os) const {
 
 void weatherer::PvHandler::OutputDailyEnergyYeild(
     std::ostream& os, const double panel_eff, const double panel_area) const {
-  // Check if the solar panel efficiency and area are within the valid domain.
+  // The rollup validates the solar panel efficiency and area.
+  YieldRollup const& rollup = UpdateRollup(panel_eff, panel_area);
+
+  // os << std::setprecision(3);
+  const PvSnapshot collection = pv_collection_.Load();
+  util::TraceSpan span{"PvHandler::OutputDailyEnergyYeild"};
+  if (span.IsActive()) {
+    span.AddTag("site", std::to_string(coords_.GetLatitude()) + "," +
+                            std::to_string(coords_.GetLongitude()));
+    span.AddTag("days", std::to_string(collection->size()));
+  }
+
+  // Loop over the days in the PvCollection, sending their yields to the output stream.
+  for (const auto& key : *collection | std::views::keys) {
+    os << key << "\n" << rollup.FindDay(key).value_or(0.0) << " kWh\n\n";
+  }
+}
+
+void weatherer::PvHandler::FetchDays(std::vector<util::Date> const& days) {
+  using namespace util;
+
+  // Fetch every run first, so the collection is replaced only once.
+  std::vector<PvCollectionPtr> fetched{};
+  std::size_t run_begin = 0;
+  while (run_begin < days.size()) {
+    // Extend the run while the next day directly follows the previous one.
+    std::size_t run_end = run_begin + 1;
+    while (run_end < days.size() &&
+           days[run_end] - days[run_end - 1] <= Date::kSecondsPerDay) {
+      ++run_end;
+    }
+
+    Date start = days[run_begin];
+    start.ResetToMidnight();
+    Date end = days[run_end - 1] + Date::kSecondsPerDay;
+    end.ResetToMidnight();
+    fetched.push_back(
+        PvDataProcessor::CollectData(coords_, TimeFrame{start, end}));
+    run_begin = run_end;
+  }
+  if (fetched.empty()) {
+    return;
+  }
+
+  pv_collection_.Update([&fetched](PvCollection& collection) {
+    for (PvCollectionPtr const& run : fetched) {
+      for (auto const& [date, pv_data] : *run) {
+        collection.insert_or_assign(date, pv_data);
+      }
+    }
+  });
+  // Until a rollup is built there is nothing to keep up to date.
+  if (rollup_panel_.first >= 0) {
+    for (PvCollectionPtr const& run : fetched) {
+      std::ranges::copy(*run | std::views::keys,
+                        std::back_inserter(rollup_pending_));
+    }
+  }
+}
+
+void weatherer::PvHandler::EvictOutsideTimeFrame() {
+  // Dates are formatted as YYYY-MM-DD, so they order lexicographically.
+  const std::string first_day = time_frame_.GetStartDate().StripTime();
+  const std::string end_day = time_frame_.GetEndDate().StripTime();
+  const auto is_outside = [&](std::string const& date) {
+    return date < first_day || date >= end_day;
+  };
+
+  if (std::ranges::none_of(*pv_collection_.Load() | std::views::keys,
+                           is_outside)) {
+    return;
+  }
+  pv_collection_.Update([&](PvCollection& collection) {
+    std::erase_if(collection,
+                  [&](auto const& day) { return is_outside(day.first); });
+  });
+  std::erase_if(rollup_pending_, is_outside);
+  rollup_.Retain(first_day, end_day);
+}
+
+void weatherer::PvHandler::ExtendTo(util::Date const& end_date) {
+  using namespace util;
+
+  Date end = end_date;
+  end.ResetToMidnight();
+  Date start = time_frame_.GetStartDate();
+  start.ResetToMidnight();
+  if (window_days_ > 0) {
+    // Step back from midday, so daylight saving changes cannot skip a date.
+    start = end - (static_cast<std::time_t>(window_days_) * Date::kSecondsPerDay -
+                   Date::kSecondsPerDay / 2);
+    start.ResetToMidnight();
+  }
+  time_frame_ = TimeFrame{start, end};
+
+  EvictOutsideTimeFrame();
+  Refresh();
+}
+
+void weatherer::PvHandler::Refresh() {
+  using namespace util;
+
+  Date unsettled{};
+  unsettled.ResetToMidnight();
+  unsettled = unsettled - kUnsettledDays_ * Date::kSecondsPerDay;
+  const std::string first_unsettled = unsettled.StripTime();
+
+  // Walk the frame day by day from midday, which stays on the same date across
+  // daylight saving changes.
+  const PvSnapshot collection = pv_collection_.Load();
+  std::vector<Date> days{};
+  Date day = time_frame_.GetStartDate();
+  day.ResetToMidnight();
+  day = day + Date::kSecondsPerDay / 2;
+  for (; day < time_frame_.GetEndDate(); day = day + Date::kSecondsPerDay) {
+    const std::string date = day.StripTime();
+    if (date >= first_unsettled || !collection->contains(date)) {
+      days.push_back(day);
+    }
+  }
+  FetchDays(days);
+}
+
+weatherer::YieldRollup const& weatherer::PvHandler::UpdateRollup(
+    const double panel_eff, const double panel_area) const {
   if (!VaildateSolarPanelEfficiency(panel_eff)) {
     throw std::invalid_argument(
         "Solar panel efficiency must be a value between 0 and 1 (inclusive)");
@@ -103,18 +257,67 @@ void weatherer::PvHandler::OutputDailyEnergyYeild(
         "Solar panel area must be a value greater than 0");
   }
 
-  // os << std::setprecision(3);
+  const PvSnapshot collection = pv_collection_.Load();
+  const auto add_day = [&](std::string const& date) {
+    const auto pv_data = collection->find(date);
+    if (pv_data != collection->end()) {
+      rollup_.Set(date, PvMetrics::CalculateHourlyEnergyYeild(
+                            *pv_data->second, coords_, date, panel_eff,
+                            panel_area));
+    }
+  };
+
+  if (rollup_panel_ != std::pair{panel_eff, panel_area}) {
+    util::TraceSpan span{"PvHandler::BuildRollup"};
+    if (span.IsActive()) {
+      span.AddTag("days", std::to_string(collection->size()));
+    }
+    // Add the days in date order, so each one is appended.
+    std::vector<std::string> dates{};
+    dates.reserve(collection->size());
+    std::ranges::copy(*collection | std::views::keys,
+                      std::back_inserter(dates));
+    std::ranges::sort(dates);
 
-  // Loop over the PvData instances in the PvCollection, calculating and sending it to the output stream.
-  for (const auto& [key, value] : *pv_collection_) {
-    os << key << "\n"
-       << PvMetrics::CalculateDailyEnergyYeild(*value, coords_, key, panel_eff,
-                                               panel_area)
-       << " kWh\n\n";
+    rollup_.Clear();
+    std::ranges::for_each(dates, add_day);
+    rollup_panel_ = {panel_eff, panel_area};
+  } else {
+    std::ranges::for_each(rollup_pending_, add_day);
   }
+  rollup_pending_.clear();
+  return rollup_;
 }
 
-inline weatherer::PvCollectionPtr weatherer::PvHandler::GetPvCollection() const {
-  return pv_collection_;
+weatherer::RangeYield weatherer::PvHandler::QueryEnergyYeild(
+    util::TimeFrame const& range, const double panel_eff,
+    const double panel_area) const {
+  return UpdateRollup(panel_eff, panel_area)
+      .Query(range.GetStartDate().StripTime(), range.GetEndDate().StripTime());
+}
+
+double weatherer::PvHandler::QueryHourlyEnergyYeild(
+    util::TimeFrame const& range, const double panel_eff,
+    const double panel_area) const {
+  return UpdateRollup(panel_eff, panel_area)
+      .QueryHours(range.GetStartDate(), range.GetEndDate());
+}
+
+weatherer::YieldRollup const& weatherer::PvHandler::GetYieldRollup(
+    const double panel_eff, const double panel_area) const {
+  return UpdateRollup(panel_eff, panel_area);
+}
+
+std::vector<weatherer::PvHandler> weatherer::PvHandler::CreateForSites(
+    std::span<const Coordinates> sites, util::TimeFrame const& time_frame) {
+  const std::vector<PvCollectionPtr> collections =
+      PvDataProcessor::CollectClusteredData(sites, time_frame);
+
+  std::vector<PvHandler> handlers{};
+  handlers.reserve(sites.size());
+  for (std::size_t i = 0; i < sites.size(); ++i) {
+    handlers.emplace_back(sites[i], time_frame, collections[i]);
+  }
+  return handlers;
 }
 
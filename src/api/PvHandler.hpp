@@ -1,8 +1,16 @@
 #pragma once
 
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "api/PvDataProcessor.hpp"
+#include "api/YieldRollup.hpp"
 #include "api/models/Coordinates.hpp"
 #include "util/Date.hpp"
+#include "util/Snapshot.hpp"
 
 namespace weatherer {
 /**
@@ -14,12 +22,57 @@ namespace weatherer {
  * information. The class is designed to abstract the underlying complexities of data
  * processing from the user, offering a streamlined interface for working with
  * photovoltaic system data.
+ *
+ * The weather data is published as immutable snapshots: ExtendTo and Refresh
+ * build the next collection aside and swap it in, so GetPvCollection may be
+ * called from any thread at any time and never observes a partial update. The
+ * yield caches are not synchronized; queries and updates of the same handler
+ * must not run concurrently.
  */
 class PvHandler {
  private:
   Coordinates coords_;
   util::TimeFrame time_frame_;
-  PvCollectionPtr pv_collection_;
+  util::Snapshot<PvCollection> pv_collection_;
+  // Number of days kept by ExtendTo, or 0 to keep every day.
+  std::size_t window_days_ = 0;
+
+  // Hourly yields indexed for range queries, valid for the panel in
+  // rollup_panel_, less the days in rollup_pending_ that were fetched since.
+  mutable YieldRollup rollup_{};
+  mutable std::pair<double, double> rollup_panel_{-1.0, -1.0};
+  mutable std::vector<std::string> rollup_pending_{};
+
+  // Days this close to today may still change. SplitTimeFrame ends the archive
+  // segment five days before today, so these recent past days, like future
+  // ones, come from the forecast API and are replaced by archive values once
+  // they fall out of this window.
+  static constexpr std::time_t kUnsettledDays_ = 5;
+
+/**
+ * @brief Fetches the given days and publishes a collection with them replaced.
+ * @param days The midday of every day to fetch, in ascending order.
+ *
+ * Consecutive days are fetched together, one request per run of days.
+ */
+  void FetchDays(std::vector<util::Date> const& days);
+
+/**
+ * @brief Removes the days outside the time frame, with their cached yields.
+ */
+  void EvictOutsideTimeFrame();
+
+/**
+ * @brief Brings the yield rollup up to date for a panel.
+ * @param panel_eff The efficiency of the solar panel.
+ * @param panel_area The area of the solar panel.
+ * @return The rollup over every day of the collection.
+ * @throws std::invalid_argument if the solar panel efficiency or area is outside the valid domain.
+ *
+ * The rollup is built once per panel; afterwards only the days fetched since
+ * the last call are recomputed.
+ */
+  YieldRollup const& UpdateRollup(double panel_eff, double panel_area) const;
 
 /**
  * @brief Validates the efficiency domain of a solar panel (0 <= efficiency <= 1).
@@ -38,6 +91,16 @@ class PvHandler {
  public:
   [[nodiscard]] explicit PvHandler(Coordinates const& coords,
                           util::TimeFrame const& time_frame);
+
+/**
+ * @brief Creates a handler over an already collected weather data set.
+ * @param coords The geographical coordinates of the site.
+ * @param time_frame The time frame covered by the collection.
+ * @param pv_collection The weather data, possibly shared with other sites.
+ */
+  [[nodiscard]] explicit PvHandler(Coordinates const& coords,
+                          util::TimeFrame const& time_frame,
+                          PvSnapshot pv_collection);
   ~PvHandler();
   PvHandler(const PvHandler& other);
   PvHandler(PvHandler&& other) noexcept;
@@ -68,13 +131,94 @@ class PvHandler {
  * Calculates and appends the daily energy yield information for each
  * day, considering the specified solar panel efficiency and area. It validates the
  * input parameters before processing and appends the date along with the calculated
- * daily energy yield in kilowatt-hours to the output stream.
+ * daily energy yield in kilowatt-hours to the output stream. Yields are read
+ * from the yield rollup, as for QueryEnergyYeild.
  */
   void OutputDailyEnergyYeild(std::ostream& os,
                                  const double panel_eff,
                                  const double panel_area) const;
 
-  [[nodiscard]] inline PvCollectionPtr GetPvCollection() const;
+/**
+ * @return The current collection; later updates publish a new one instead of
+ * modifying it.
+ */
+  [[nodiscard]] PvSnapshot GetPvCollection() const { return pv_collection_.Load(); }
+
+/**
+ * @brief Gets the energy yield of a range of days.
+ * @param range The range; every day from the date of its start up to, but not
+ * including, the date of its end counts in full.
+ * @param panel_eff The efficiency of the solar panel.
+ * @param panel_area The area of the solar panel.
+ * @return The total and mean daily energy yield of the days of the range.
+ * @throws std::invalid_argument if the solar panel efficiency or area is outside the valid domain.
+ *
+ * Answered in constant time from the yield rollup, which is built on the first
+ * query for a panel and then kept up to date as days are fetched.
+ */
+  [[nodiscard]] RangeYield QueryEnergyYeild(util::TimeFrame const& range,
+                                            double panel_eff,
+                                            double panel_area) const;
+
+/**
+ * @brief Gets the energy yield of the whole hours of a range, e.g. from sunrise
+ * to now.
+ * @param range The range; the hour of its start counts, the hour of its end does not.
+ * @param panel_eff The efficiency of the solar panel.
+ * @param panel_area The area of the solar panel.
+ * @return The total energy yield in kilowatt-hours.
+ * @throws std::invalid_argument if the solar panel efficiency or area is outside the valid domain.
+ */
+  [[nodiscard]] double QueryHourlyEnergyYeild(util::TimeFrame const& range,
+                                              double panel_eff,
+                                              double panel_area) const;
+
+/**
+ * @brief Gets the yield rollup, with its month and year totals.
+ * @param panel_eff The efficiency of the solar panel.
+ * @param panel_area The area of the solar panel.
+ * @return The rollup, valid until this handler is next modified.
+ * @throws std::invalid_argument if the solar panel efficiency or area is outside the valid domain.
+ */
+  [[nodiscard]] YieldRollup const& GetYieldRollup(double panel_eff,
+                                                  double panel_area) const;
+
+  [[nodiscard]] util::TimeFrame GetTimeFrame() const { return time_frame_; }
+
+/**
+ * @brief Keeps the time frame to a fixed number of days as it is extended.
+ * @param days The number of days to keep, or 0 to keep every day.
+ *
+ * The window is applied by the next call to ExtendTo.
+ */
+  void SetSlidingWindow(const std::size_t days) { window_days_ = days; }
+
+/**
+ * @brief Moves the end of the time frame to end_date, fetching only what changed.
+ * @param end_date The new (exclusive) end of the time frame.
+ *
+ * Fetches the days missing from the collection and refetches the days that may
+ * still change, then drops the days that fall out of the sliding window, if one
+ * is set. Every other day, and its cached energy yield, is kept as is.
+ */
+  void ExtendTo(util::Date const& end_date);
+
+/**
+ * @brief Fetches the missing days of the time frame and those that may still change.
+ */
+  void Refresh();
+
+/**
+ * @brief Creates handlers for many sites, fetching weather data once per grid cell.
+ * @param sites The geographical coordinates of every site.
+ * @param time_frame The time frame for data aggregation.
+ * @return One PvHandler per site, in the same order as sites.
+ *
+ * Sites that fall into the same weather grid cell share a single weather series,
+ * while energy yields are still computed from each site's own coordinates.
+ */
+  [[nodiscard]] static std::vector<PvHandler> CreateForSites(
+      std::span<const Coordinates> sites, util::TimeFrame const& time_frame);
 
 };
 }  // namespace weatherer
@@ -1,26 +1,42 @@
 #include "PvMetrics.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <numbers>
 #include <span>
+#include <stdexcept>
 
 #include "api/models/Coordinates.hpp"
 #include "util/Date.hpp"
+#include "util/Metrics.hpp"
 #include "util/Statistics.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+// Exposed as a counter; rate() over it gives computations per second.
+weatherer::util::Counter& GetYieldComputations() {
+  static weatherer::util::Counter& yield_computations =
+      weatherer::util::Metrics::GetCounter(
+          "weatherer_yield_computations_total",
+          "Daily PV energy yield computations performed.");
+  return yield_computations;
+}
+}  // namespace
 
-int weatherer::PvMetrics::CalculateSolarNoonTime(const PvData& pv_data) {
-  // Parse sunrise and sunset times from the photovoltaic data.
-  const auto sunrise_time = util::Date{pv_data.GetSunriseTime()};
-  const auto sunset_time = util::Date{pv_data.GetSunsetTime()};
+int weatherer::PvMetrics::CalculateSolarNoonTime(const std::time_t sunrise_time,
+                                                 const std::time_t sunset_time) {
+  const auto sunrise = util::Date{sunrise_time};
+  const auto sunset = util::Date{sunset_time};
 
   // Calculate the total duration between sunrise and sunset.
-  const auto duration = sunset_time - sunrise_time;
+  const auto duration = sunset - sunrise;
 
   // Calculate the midpoint duration between sunrise and sunset.
   const auto midpoint_duration = duration / 2;
 
   // Calculate the solar noon time by adding the midpoint duration to the sunrise time.
-  const auto solar_noon = sunrise_time + midpoint_duration;
+  const auto solar_noon = sunrise + midpoint_duration;
   // Convert the solar noon time to a time structure to extract the hour.
   const std::time_t solar_noon_time = solar_noon.GetTime();
   std::tm solar_noon_tm{};
@@ -33,11 +49,9 @@ int weatherer::PvMetrics::CalculateSolarNoonTime(const PvData& pv_data) {
   return solar_noon_tm.tm_hour + 1;
 }
 
-double weatherer::PvMetrics::CalculateDailyEnergyYeild(
-    PvData const& pv_data, Coordinates const& coordinates,
-    std::string const& date, const double panel_eff, const double panel_area) {
-  using namespace util;
-
+weatherer::PvMetrics::DayGeometry weatherer::PvMetrics::CalculateDayGeometry(
+    Coordinates const& coordinates, const int day_of_year,
+    const std::time_t sunrise_time, const std::time_t sunset_time) {
   const auto convert_to_radians = [](const double degrees) {
     return degrees * (std::numbers::pi / 180.0);
   };
@@ -45,8 +59,6 @@ double weatherer::PvMetrics::CalculateDailyEnergyYeild(
   const double radians_latitude = convert_to_radians(coordinates.GetLatitude());
 
   // Calcuate the laitude factor based on the solar declination angle.
-  const int day_of_year =
-      Date{date}.GetCurrentLocalTime().tm_yday;
   const double solar_declination_angle =
       23.45 * std::sin((365.0 / 360.0) * (day_of_year - 81));
   const double radian_solar_declination_angle =
@@ -55,7 +67,7 @@ double weatherer::PvMetrics::CalculateDailyEnergyYeild(
       std::cos(radians_latitude) * std::cos(radian_solar_declination_angle);
 
   // Calculate the incident angle factor based on the solar noon time.
-  const int solar_time = CalculateSolarNoonTime(pv_data);
+  const int solar_time = CalculateSolarNoonTime(sunrise_time, sunset_time);
   const double hour_angle = 15 * (solar_time - 12);
   const double solar_zenith_angle = std::asin(
       std::sin(radians_latitude) * std::sin(radian_solar_declination_angle) +
@@ -63,20 +75,149 @@ double weatherer::PvMetrics::CalculateDailyEnergyYeild(
           std::cos(convert_to_radians(hour_angle)));
   const double incident_angle_factor =
       std::cos(convert_to_radians(solar_zenith_angle));
+  return DayGeometry{latitude_factor, incident_angle_factor};
+}
+
+double weatherer::PvMetrics::CalculateDailyEnergyYeild(
+    PvData const& pv_data, Coordinates const& coordinates,
+    std::string const& date, const double panel_eff, const double panel_area) {
+  using namespace util;
+  TraceSpan span{"PvMetrics::CalculateDailyEnergyYeild"};
+  if (span.IsActive()) {
+    span.AddTag("date", date);
+  }
+
+  const std::array<double, 24> hourly_pv = CalculateHourlyEnergyYeild(
+      pv_data, coordinates, date, panel_eff, panel_area);
+  return Statistics::Sum(std::span{hourly_pv});
+}
+
+std::array<double, 24> weatherer::PvMetrics::CalculateHourlyEnergyYeild(
+    PvData const& pv_data, Coordinates const& coordinates,
+    std::string const& date, const double panel_eff, const double panel_area) {
+  using namespace util;
+  GetYieldComputations().Increment();
+
+  const DayGeometry geometry = CalculateDayGeometry(
+      coordinates, Date{date}.GetCurrentLocalTime().tm_yday,
+      pv_data.GetSunriseTime(), pv_data.GetSunsetTime());
+
+  // The getters return copies; take them once rather than once per hour.
+  const std::array<double, 24> shortwave_radiation = pv_data.GetShortwaveRadiation();
+  const std::array<double, 24> temperature = pv_data.GetTemperature();
+  const std::array<double, 24> cloud_cover_total = pv_data.GetCloudCoverTotal();
+  return CalculateHourYields(
+      [&](const std::size_t i) {
+        return std::array{shortwave_radiation[i], temperature[i],
+                          cloud_cover_total[i]};
+      },
+      panel_eff, panel_area, geometry);
+}
+
+double weatherer::PvMetrics::CalculateDailyEnergyYeild(
+    PvDayRecord const& record, Coordinates const& coordinates,
+    const double panel_eff, const double panel_area) {
+  using namespace util;
+  TraceSpan span{"PvMetrics::CalculateDailyEnergyYeild"};
+  GetYieldComputations().Increment();
+  if (span.IsActive()) {
+    span.AddTag("date", record.GetDate());
+  }
+
+  const DayGeometry geometry = CalculateDayGeometry(
+      coordinates, record.GetDayOfYear(),
+      static_cast<std::time_t>(record.sunrise_time),
+      static_cast<std::time_t>(record.sunset_time));
+
+  // Each quantized hour is widened as it is read.
+  const std::array<double, 24> hourly_pv = CalculateHourYields(
+      [&record](const std::size_t i) {
+        return std::array{record.GetShortwaveRadiation(i),
+                          record.GetTemperature(i),
+                          record.GetCloudCoverTotal(i)};
+      },
+      panel_eff, panel_area, geometry);
+  return Statistics::Sum(std::span{hourly_pv});
+}
+
+std::vector<double> weatherer::PvMetrics::CalculateEnsembleDailyEnergyYeild(
+    EnsembleForecast const& forecast, Coordinates const& coordinates,
+    const double panel_eff, const double panel_area) {
+  using namespace util;
+  TraceSpan span{"PvMetrics::CalculateEnsembleDailyEnergyYeild"};
+  if (span.IsActive()) {
+    span.AddTag("members", std::to_string(forecast.GetMemberCount()));
+    span.AddTag("days", std::to_string(forecast.GetDayCount()));
+  }
 
-  std::vector<double> hourly_pv{};
-  hourly_pv.reserve(24);
-
-  for (int i = 0; i < 24; i++) {
-    const double solar_irradiance = pv_data.GetShortwaveRadiation().at(i);
-    const double base_daily_energy_yield = solar_irradiance * panel_eff * panel_area;
-    const double hourly_temperature = pv_data.GetTemperature().at(i);
-    const double temperature_factor = hourly_temperature > 25 ? 1.0 - 0.004 * (hourly_temperature - 25) : 1.0;
-    const double hourly_cloud_cover = pv_data.GetCloudCoverTotal().at(i);
-    const double cloud_coverage_factor = (1 - hourly_cloud_cover);
-    hourly_pv.push_back(base_daily_energy_yield * temperature_factor * latitude_factor *
-         cloud_coverage_factor * incident_angle_factor);
+  const std::size_t member_count = forecast.GetMemberCount();
+  const auto& days = forecast.GetDays();
+  GetYieldComputations().Increment(member_count * days.size());
+  std::vector<double> yields(days.size() * member_count);
+
+  for (std::size_t day = 0; day < days.size(); ++day) {
+    const DayGeometry geometry = CalculateDayGeometry(
+        coordinates, Date{days[day].date}.GetCurrentLocalTime().tm_yday,
+        days[day].sunrise_time, days[day].sunset_time);
+
+    const std::size_t first_hour = day * EnsembleForecast::kHoursPerDay;
+    for (std::size_t member = 0; member < member_count; ++member) {
+      const auto shortwave_radiation =
+          forecast.GetShortwaveRadiation(member).subspan(first_hour).first<24>();
+      const auto temperature =
+          forecast.GetTemperature(member).subspan(first_hour).first<24>();
+      const auto cloud_cover_total =
+          forecast.GetCloudCoverTotal(member).subspan(first_hour).first<24>();
+      const std::array<double, 24> hourly_pv = CalculateHourYields(
+          [&](const std::size_t i) {
+            return std::array{shortwave_radiation[i], temperature[i],
+                              cloud_cover_total[i]};
+          },
+          panel_eff, panel_area, geometry);
+      yields[day * member_count + member] = Statistics::Sum(std::span{hourly_pv});
+    }
   }
+  return yields;
+}
 
-  return std::accumulate(hourly_pv.begin(), hourly_pv.end(), 0.0);
-};
\ No newline at end of file
+std::vector<weatherer::YieldDistribution>
+weatherer::PvMetrics::CalculateEnsembleYeildDistribution(
+    EnsembleForecast const& forecast, Coordinates const& coordinates,
+    const double panel_eff, const double panel_area,
+    std::span<const double> quantiles) {
+  using namespace util;
+  const std::size_t member_count = forecast.GetMemberCount();
+  [[unlikely]] if (member_count == 0) {
+    throw std::invalid_argument("The ensemble forecast has no members");
+  }
+  [[unlikely]] if (!std::ranges::all_of(quantiles, [](const double quantile) {
+                     return quantile >= 0 && quantile <= 1;
+                   })) {
+    throw std::invalid_argument("Quantiles must be between 0 and 1");
+  }
+
+  std::vector<double> yields = CalculateEnsembleDailyEnergyYeild(
+      forecast, coordinates, panel_eff, panel_area);
+
+  std::vector<YieldDistribution> distributions{};
+  distributions.reserve(forecast.GetDayCount());
+  for (std::size_t day = 0; day < forecast.GetDayCount(); ++day) {
+    // Every day's members are contiguous, so they are sorted in place.
+    const auto members =
+        std::span{yields}.subspan(day * member_count, member_count);
+    RunningMoments moments{};
+    moments.Add(members);
+    std::ranges::sort(members);
+
+    YieldDistribution distribution{forecast.GetDays()[day].date,
+                                   moments.GetMean(),
+                                   moments.GetStandardDeviation()};
+    distribution.quantiles.reserve(quantiles.size());
+    for (const double quantile : quantiles) {
+      distribution.quantiles.push_back(
+          Statistics::SortedQuantile(members, quantile));
+    }
+    distributions.push_back(std::move(distribution));
+  }
+  return distributions;
+}
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <ctime>
+#include <span>
+#include <vector>
+
 #include "models/Coordinates.hpp"
+#include "models/EnsembleForecast.hpp"
 #include "models/PvData.hpp"
+#include "models/PvDayRecord.hpp"
 
 namespace weatherer {
 
@@ -16,6 +24,14 @@ namespace weatherer {
  */
 class PvMetrics {
 private:
+  /**
+   * @brief The factors of the yield model that are constant over a day.
+   */
+  struct DayGeometry {
+    double latitude_factor;
+    double incident_angle_factor;
+  };
+
 /**
  * @brief Calculates the solar irradiance based on direct and diffuse radiation data.
  * @param pv_data The photovoltaic data containing radiation information.
@@ -30,7 +46,8 @@ private:
 
   /**
    * @brief Calculates the solar noon time based on sunrise and sunset information.
-   * @param pv_data The photovoltaic data containing sunrise and sunset times.
+   * @param sunrise_time The sunrise time of the day.
+   * @param sunset_time The sunset time of the day.
    * @return The calculated solar noon hour.
    *
    * Determines the solar noon time by finding the midpoint between the
@@ -38,9 +55,75 @@ private:
    * midpoint duration, and adds it to the sunrise time. The result represents the hour
    * of the day when solar noon occurs.
    */
-  static int CalculateSolarNoonTime(const PvData& pv_data);
+  static int CalculateSolarNoonTime(std::time_t sunrise_time,
+                                    std::time_t sunset_time);
+
+  /**
+   * @brief Calculates the latitude and incident angle factors of a day.
+   * @param coordinates The geographical coordinates of the location.
+   * @param day_of_year The zero-based day of the year.
+   * @param sunrise_time The sunrise time of the day.
+   * @param sunset_time The sunset time of the day.
+   * @return The factors shared by every hour of the day.
+   */
+  static DayGeometry CalculateDayGeometry(Coordinates const& coordinates,
+                                          int day_of_year,
+                                          std::time_t sunrise_time,
+                                          std::time_t sunset_time);
+
+  /**
+   * @brief Calculates the energy yield of a single hour.
+   * @param shortwave_radiation Units: kWh/m^2
+   * @param temperature Units: degrees Celsius
+   * @param cloud_cover_total Value between 0 and 1
+   * @param panel_eff The efficiency of the solar panel.
+   * @param panel_area The area of the solar panel in m^2.
+   * @param geometry The factors of the day.
+   * @return The energy yield of the hour in kWh.
+   */
+  static double CalculateHourYield(const double shortwave_radiation,
+                                   const double temperature,
+                                   const double cloud_cover_total,
+                                   const double panel_eff,
+                                   const double panel_area,
+                                   DayGeometry const& geometry) {
+    const double base_daily_energy_yield = shortwave_radiation * panel_eff * panel_area;
+    const double temperature_factor = temperature > 25 ? 1.0 - 0.004 * (temperature - 25) : 1.0;
+    const double cloud_coverage_factor = (1 - cloud_cover_total);
+    return base_daily_energy_yield * temperature_factor * geometry.latitude_factor *
+           cloud_coverage_factor * geometry.incident_angle_factor;
+  }
+
+  /**
+   * @brief Calculates the energy yield of every hour of a day.
+   * @param hour_weather Called with the index of every hour; returns its
+   * shortwave radiation, temperature and cloud cover, as CalculateHourYield
+   * takes them.
+   * @param panel_eff The efficiency of the solar panel.
+   * @param panel_area The area of the solar panel in m^2.
+   * @param geometry The factors of the day.
+   * @return The energy yield of every hour in kWh.
+   */
+  template <typename HourWeather_>
+  static std::array<double, 24> CalculateHourYields(HourWeather_ hour_weather,
+                                                    const double panel_eff,
+                                                    const double panel_area,
+                                                    DayGeometry const& geometry) {
+    std::array<double, 24> hourly_pv{};
+    for (std::size_t i = 0; i < 24; i++) {
+      const auto [shortwave_radiation, temperature, cloud_cover_total] =
+          hour_weather(i);
+      hourly_pv[i] = CalculateHourYield(shortwave_radiation, temperature,
+                                        cloud_cover_total, panel_eff,
+                                        panel_area, geometry);
+    }
+    return hourly_pv;
+  }
 
 public:
+  // The quantiles reported by CalculateEnsembleYeildDistribution by default.
+  static constexpr std::array<double, 3> kDefaultQuantiles{0.1, 0.5, 0.9};
+
   // Prevent instantiation of the PvMetrics class.
   PvMetrics() = delete;
   ~PvMetrics() = delete;
@@ -65,5 +148,71 @@ public:
                                           std::string const& date,
                                           const double panel_eff,
                                           const double panel_area);
+
+/**
+ * @brief Calculates the hourly energy yields of a photovoltaic system over a day.
+ * @param pv_data The photovoltaic data containing weather information.
+ * @param coordinates The geographical coordinates of the location.
+ * @param date The date for which the energy yields are calculated.
+ * @param panel_eff The efficiency of the solar panel (between 0 and 1).
+ * @param panel_area The area of the solar panel (in square meters).
+ * @return The energy yield of every hour of the day in kilowatt-hours; their sum
+ * is the daily energy yield.
+ */
+  static std::array<double, 24> CalculateHourlyEnergyYeild(
+      PvData const& pv_data, Coordinates const& coordinates,
+      std::string const& date, const double panel_eff,
+      const double panel_area);
+
+/**
+ * @brief Calculates the daily energy yield of a photovoltaic system from a compact record.
+ * @param record The day of weather data.
+ * @param coordinates The geographical coordinates of the location.
+ * @param panel_eff The efficiency of the solar panel (between 0 and 1).
+ * @param panel_area The area of the solar panel (in square meters).
+ * @return The calculated daily energy yield in kilowatt-hours.
+ *
+ * Applies the same model as the PvData overload, widening the quantized hourly
+ * values as they are read, and returns the same result for the same day.
+ */
+  static double CalculateDailyEnergyYeild(PvDayRecord const& record,
+                                          Coordinates const& coordinates,
+                                          const double panel_eff,
+                                          const double panel_area);
+
+/**
+ * @brief Calculates the daily energy yield of every member of an ensemble forecast.
+ * @param forecast The ensemble forecast of the location.
+ * @param coordinates The geographical coordinates of the location.
+ * @param panel_eff The efficiency of the solar panel (between 0 and 1).
+ * @param panel_area The area of the solar panel (in square meters).
+ * @return The yield of member m on day d at index d * GetMemberCount() + m, in
+ * kilowatt-hours.
+ *
+ * Applies the same model as the PvData overload, and returns the same result
+ * for a member as for a PvData holding the same day. The factors that depend
+ * only on the day, which dominate the cost of a single yield, are computed once
+ * per day and shared by every member; each member then only adds one pass of
+ * CalculateHourYield over its 24 contiguous hours, with no PvData objects.
+ */
+  static std::vector<double> CalculateEnsembleDailyEnergyYeild(
+      EnsembleForecast const& forecast, Coordinates const& coordinates,
+      const double panel_eff, const double panel_area);
+
+/**
+ * @brief Summarizes the daily energy yield of an ensemble forecast across its members.
+ * @param forecast The ensemble forecast of the location.
+ * @param coordinates The geographical coordinates of the location.
+ * @param panel_eff The efficiency of the solar panel (between 0 and 1).
+ * @param panel_area The area of the solar panel (in square meters).
+ * @param quantiles The quantiles to report, each between 0 and 1.
+ * @return The mean, spread and quantiles of the yield of every day.
+ * @throws std::invalid_argument if the forecast has no members or a quantile
+ * is out of range.
+ */
+  static std::vector<YieldDistribution> CalculateEnsembleYeildDistribution(
+      EnsembleForecast const& forecast, Coordinates const& coordinates,
+      const double panel_eff, const double panel_area,
+      std::span<const double> quantiles = kDefaultQuantiles);
 };
 }  // namespace weatherer
@@ -0,0 +1,205 @@
+#include "YieldRollup.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <numeric>
+#include <stdexcept>
+
+#include "util/Statistics.hpp"
+
+namespace {
+// The number of days from 1970-01-01 to a calendar date.
+std::int64_t GetDayNumber(std::chrono::year_month_day const& date) {
+  return std::chrono::sys_days{date}.time_since_epoch().count();
+}
+
+// The inverse of GetDayNumber, formatted as YYYY-MM-DD.
+std::string FormatDay(const std::int64_t day_number) {
+  const std::chrono::year_month_day date{
+      std::chrono::sys_days{std::chrono::days{day_number}}};
+  char buffer[16];
+  std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u",
+                static_cast<int>(date.year()),
+                static_cast<unsigned>(date.month()),
+                static_cast<unsigned>(date.day()));
+  return buffer;
+}
+}  // namespace
+
+std::int64_t weatherer::YieldRollup::ToDayNumber(const std::string_view date) {
+  const auto parse = [date](const std::size_t offset, const std::size_t length) {
+    int value = 0;
+    const char* const first = date.data() + offset;
+    const auto [end, error] = std::from_chars(first, first + length, value);
+    [[unlikely]] if (error != std::errc{} || end != first + length) {
+      throw std::invalid_argument("Date must be formatted as YYYY-MM-DD");
+    }
+    return value;
+  };
+  [[unlikely]] if (date.size() != 10 || date[4] != '-' || date[7] != '-') {
+    throw std::invalid_argument("Date must be formatted as YYYY-MM-DD");
+  }
+  const std::chrono::year_month_day calendar_date{
+      std::chrono::year{parse(0, 4)},
+      std::chrono::month{static_cast<unsigned>(parse(5, 2))},
+      std::chrono::day{static_cast<unsigned>(parse(8, 2))}};
+  [[unlikely]] if (!calendar_date.ok()) {
+    throw std::invalid_argument("Invalid date: " + std::string{date});
+  }
+  return GetDayNumber(calendar_date);
+}
+
+void weatherer::YieldRollup::UpdatePrefixFrom(const std::size_t day) {
+  for (std::size_t hour = day * 24; hour < hourly_.size(); ++hour) {
+    hourly_prefix_[hour + 1] = hourly_prefix_[hour] + hourly_[hour];
+  }
+  for (std::size_t i = day; i < present_.size(); ++i) {
+    day_count_prefix_[i + 1] = day_count_prefix_[i] + present_[i];
+  }
+}
+
+void weatherer::YieldRollup::UpdatePeriods(const std::string_view date,
+                                           const double daily_kwh,
+                                           const int sign) {
+  for (const auto& [periods, length] :
+       {std::pair{&months_, std::size_t{7}}, std::pair{&years_, std::size_t{4}}}) {
+    const std::string_view key = date.substr(0, length);
+    auto period = periods->find(key);
+    if (period == periods->end()) {
+      period = periods->emplace(std::string{key}, RangeYield{}).first;
+    }
+    period->second.total_kwh += sign * daily_kwh;
+    if (sign > 0) {
+      ++period->second.days;
+    } else if (--period->second.days == 0) {
+      periods->erase(period);
+    }
+  }
+}
+
+std::size_t weatherer::YieldRollup::ClampDay(const std::int64_t day_number) const {
+  if (day_number <= first_day_) {
+    return 0;
+  }
+  return std::min(static_cast<std::size_t>(day_number - first_day_),
+                  present_.size());
+}
+
+void weatherer::YieldRollup::Set(const std::string_view date,
+                                 const std::span<const double, 24> hourly_kwh) {
+  const std::int64_t day_number = ToDayNumber(date);
+  std::size_t first_changed = present_.size();
+  if (present_.empty()) {
+    first_day_ = day_number;
+  } else if (day_number < first_day_) {
+    // Shift every stored day back to make room in front of them.
+    const auto shift = static_cast<std::size_t>(first_day_ - day_number);
+    hourly_.insert(hourly_.begin(), shift * 24, 0.0);
+    present_.insert(present_.begin(), shift, 0);
+    first_day_ = day_number;
+    first_changed = 0;
+  }
+
+  const auto day = static_cast<std::size_t>(day_number - first_day_);
+  if (day >= present_.size()) {
+    hourly_.resize((day + 1) * 24, 0.0);
+    present_.resize(day + 1, 0);
+  }
+  hourly_prefix_.resize(hourly_.size() + 1);
+  day_count_prefix_.resize(present_.size() + 1);
+
+  const auto hours = hourly_.begin() + static_cast<std::ptrdiff_t>(day * 24);
+  if (present_[day] != 0) {
+    UpdatePeriods(date, std::accumulate(hours, hours + 24, 0.0), -1);
+  }
+  std::ranges::copy(hourly_kwh, hours);
+  present_[day] = 1;
+  UpdatePeriods(date, std::accumulate(hours, hours + 24, 0.0), 1);
+  UpdatePrefixFrom(std::min(first_changed, day));
+}
+
+void weatherer::YieldRollup::Retain(const std::string_view first_date,
+                                    const std::string_view end_date) {
+  const std::size_t first = ClampDay(ToDayNumber(first_date));
+  const std::size_t end = std::max(first, ClampDay(ToDayNumber(end_date)));
+  if (first == 0 && end == present_.size()) {
+    return;
+  }
+
+  for (std::size_t day = 0; day < present_.size(); ++day) {
+    if (present_[day] != 0 && (day < first || day >= end)) {
+      const auto hours = hourly_.begin() + static_cast<std::ptrdiff_t>(day * 24);
+      UpdatePeriods(FormatDay(first_day_ + static_cast<std::int64_t>(day)),
+                    std::accumulate(hours, hours + 24, 0.0), -1);
+    }
+  }
+  hourly_.erase(hourly_.begin() + static_cast<std::ptrdiff_t>(end * 24),
+                hourly_.end());
+  hourly_.erase(hourly_.begin(),
+                hourly_.begin() + static_cast<std::ptrdiff_t>(first * 24));
+  present_.erase(present_.begin() + static_cast<std::ptrdiff_t>(end),
+                 present_.end());
+  present_.erase(present_.begin(),
+                 present_.begin() + static_cast<std::ptrdiff_t>(first));
+  first_day_ += static_cast<std::int64_t>(first);
+  hourly_prefix_.resize(hourly_.size() + 1);
+  day_count_prefix_.resize(present_.size() + 1);
+  UpdatePrefixFrom(0);
+}
+
+void weatherer::YieldRollup::Clear() {
+  first_day_ = 0;
+  hourly_.clear();
+  present_.clear();
+  hourly_prefix_.assign(1, 0.0);
+  day_count_prefix_.assign(1, 0);
+  months_.clear();
+  years_.clear();
+}
+
+std::optional<double> weatherer::YieldRollup::FindDay(
+    const std::string_view date) const {
+  const std::int64_t day_number = ToDayNumber(date);
+  if (day_number < first_day_ ||
+      day_number - first_day_ >= static_cast<std::int64_t>(present_.size())) {
+    return std::nullopt;
+  }
+  const auto day = static_cast<std::size_t>(day_number - first_day_);
+  if (present_[day] == 0) {
+    return std::nullopt;
+  }
+  return util::Statistics::Sum(std::span{hourly_}.subspan(day * 24).first<24>());
+}
+
+weatherer::RangeYield weatherer::YieldRollup::Query(
+    const std::string_view first_date, const std::string_view end_date) const {
+  const std::size_t first = ClampDay(ToDayNumber(first_date));
+  const std::size_t end = ClampDay(ToDayNumber(end_date));
+  if (end <= first) {
+    return RangeYield{};
+  }
+  return RangeYield{hourly_prefix_[end * 24] - hourly_prefix_[first * 24],
+                    day_count_prefix_[end] - day_count_prefix_[first]};
+}
+
+double weatherer::YieldRollup::QueryHours(util::Date const& start,
+                                          util::Date const& end) const {
+  const auto clamp_hour = [this](util::Date const& date) {
+    const std::tm local = date.GetCurrentLocalTime();
+    const std::chrono::year_month_day local_date{
+        std::chrono::year{local.tm_year + 1900},
+        std::chrono::month{static_cast<unsigned>(local.tm_mon + 1)},
+        std::chrono::day{static_cast<unsigned>(local.tm_mday)}};
+    const std::int64_t hour =
+        (GetDayNumber(local_date) - first_day_) * 24 + local.tm_hour;
+    return static_cast<std::size_t>(
+        std::clamp<std::int64_t>(hour, 0,
+                                 static_cast<std::int64_t>(hourly_.size())));
+  };
+  const std::size_t first = clamp_hour(start);
+  const std::size_t last = clamp_hour(end);
+  return last > first ? hourly_prefix_[last] - hourly_prefix_[first] : 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/Date.hpp"
+
+namespace weatherer {
+/**
+ * @brief The energy yield over a range of days.
+ */
+struct RangeYield {
+  double total_kwh = 0;
+  // The number of days of the range that have a yield.
+  std::size_t days = 0;
+
+  /**
+   * @return The mean daily energy yield, or 0 if no day has a yield.
+   */
+  [[nodiscard]] double GetMeanDaily() const {
+    return days > 0 ? total_kwh / static_cast<double>(days) : 0;
+  }
+};
+
+/**
+ * @brief A prefix-sum index of the hourly energy yields of one site.
+ *
+ * Days are stored densely from the first day added, with missing days yielding
+ * nothing, and every hour carries the running total of the hours before it.
+ * The yield of any range of days or hours is then the difference of two
+ * running totals, so range queries take constant time however long the range.
+ * Calendar month and year totals are kept alongside.
+ *
+ * Adding a day after the last one is amortized constant time. Replacing an
+ * earlier day updates the running totals from that day on, and adding a day
+ * before the first one rebuilds the index.
+ */
+class YieldRollup {
+ private:
+  // The day number of the first stored day, in days since 1970-01-01.
+  std::int64_t first_day_ = 0;
+  // 24 yields per stored day, 0 for the hours of missing days.
+  std::vector<double> hourly_{};
+  std::vector<std::uint8_t> present_{};
+  // hourly_prefix_[h] is the sum of hourly_[0, h); every 24th entry is
+  // therefore the daily running total.
+  std::vector<double> hourly_prefix_{0.0};
+  // day_count_prefix_[d] is the number of present days in [0, d).
+  std::vector<std::size_t> day_count_prefix_{0};
+  // Keyed by YYYY-MM and YYYY.
+  std::map<std::string, RangeYield, std::less<>> months_{};
+  std::map<std::string, RangeYield, std::less<>> years_{};
+
+  /**
+   * @brief Recomputes the running totals from a day to the last one.
+   */
+  void UpdatePrefixFrom(std::size_t day);
+
+  /**
+   * @brief Adds a day's yield to its month and year totals.
+   * @param sign 1 to add the day, -1 to remove it.
+   */
+  void UpdatePeriods(std::string_view date, double daily_kwh, int sign);
+
+  /**
+   * @return The stored day index of a day number, clamped to [0, day count].
+   */
+  [[nodiscard]] std::size_t ClampDay(std::int64_t day_number) const;
+
+ public:
+  /**
+   * @brief Converts a date to its day number.
+   * @param date A date formatted as YYYY-MM-DD.
+   * @return The number of days from 1970-01-01 to date.
+   * @throws std::invalid_argument if date is not formatted as YYYY-MM-DD or
+   * does not exist (e.g. 2023-02-29).
+   */
+  [[nodiscard]] static std::int64_t ToDayNumber(std::string_view date);
+
+  /**
+   * @brief Adds or replaces the yields of a day.
+   * @param date The day, formatted as YYYY-MM-DD.
+   * @param hourly_kwh The energy yield of every hour of the day.
+   * @throws std::invalid_argument if date is not formatted as YYYY-MM-DD.
+   */
+  void Set(std::string_view date, std::span<const double, 24> hourly_kwh);
+
+  /**
+   * @brief Drops every day outside [first_date, end_date).
+   * @param first_date The first day to keep, formatted as YYYY-MM-DD.
+   * @param end_date The day after the last one to keep, formatted as YYYY-MM-DD.
+   * @throws std::invalid_argument if a date is not formatted as YYYY-MM-DD.
+   */
+  void Retain(std::string_view first_date, std::string_view end_date);
+
+  void Clear();
+
+  /**
+   * @return The number of days that have a yield.
+   */
+  [[nodiscard]] std::size_t GetDayCount() const {
+    return day_count_prefix_.back();
+  }
+
+  /**
+   * @brief Gets the energy yield of a single day.
+   * @param date The day, formatted as YYYY-MM-DD.
+   * @return The daily energy yield in kilowatt-hours, summed as
+   * PvMetrics::CalculateDailyEnergyYeild does, or std::nullopt if the day has
+   * no yield.
+   * @throws std::invalid_argument if date is not formatted as YYYY-MM-DD.
+   */
+  [[nodiscard]] std::optional<double> FindDay(std::string_view date) const;
+
+  /**
+   * @brief Gets the energy yield of the days in [first_date, end_date).
+   * @param first_date The first day, formatted as YYYY-MM-DD.
+   * @param end_date The day after the last one, formatted as YYYY-MM-DD.
+   * @return The total and mean daily yield of the stored days in the range.
+   * @throws std::invalid_argument if a date is not formatted as YYYY-MM-DD.
+   */
+  [[nodiscard]] RangeYield Query(std::string_view first_date,
+                                 std::string_view end_date) const;
+
+  /**
+   * @brief Gets the energy yield of the whole hours in [start, end).
+   * @param start The start of the range; its hour counts in full.
+   * @param end The end of the range; its hour does not count.
+   * @return The total energy yield in kilowatt-hours.
+   *
+   * Hours are those of the local calendar day, as in PvData.
+   */
+  [[nodiscard]] double QueryHours(util::Date const& start,
+                                  util::Date const& end) const;
+
+  /**
+   * @return The yield of every calendar month with a stored day, by YYYY-MM.
+   */
+  [[nodiscard]] std::map<std::string, RangeYield, std::less<>> const&
+  GetMonths() const {
+    return months_;
+  }
+
+  /**
+   * @return The yield of every calendar year with a stored day, by YYYY.
+   */
+  [[nodiscard]] std::map<std::string, RangeYield, std::less<>> const&
+  GetYears() const {
+    return years_;
+  }
+};
+}  // namespace weatherer
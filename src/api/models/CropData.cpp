@@ -1,68 +1,62 @@
 #include "CropData.hpp"
 
+#include "util/StringPool.hpp"
+
+std::string_view weatherer::ToString(const LightLevel level) {
+  switch (level) {
+    case LightLevel::kFull:
+      return "Full";
+    case LightLevel::kPartial:
+      return "Partial";
+    case LightLevel::kFullOrPartial:
+      return "Full/Partial";
+    default:
+      return "Unknown";
+  }
+}
+
+weatherer::LightLevel weatherer::ParseLightLevel(const std::string_view str) {
+  for (const LightLevel level :
+       {LightLevel::kFull, LightLevel::kPartial, LightLevel::kFullOrPartial}) {
+    if (str == ToString(level)) {
+      return level;
+    }
+  }
+  return LightLevel::kUnknown;
+}
+
 weatherer::CropData::CropData()
     : name_("Unknown"),
       species_name_("Unknown"),
       pref_soil_temp_{INT_MIN},
       pref_air_temp_{INT_MIN},
       pref_soil_ph_{util::NumericRange<double>{0, 0}},
-      pref_light_level_{"Unknown"},
-      fun_facts_{"N/A"} {}
+      pref_light_level_{LightLevel::kUnknown} {}
 
 weatherer::CropData::CropData(const CropData& other) = default;
 
-weatherer::CropData::CropData(CropData&& other) noexcept
-    : name_(std::move(other.name_)),
-      species_name_(std::move(other.species_name_)),
-      pref_soil_temp_(other.pref_soil_temp_),
-      pref_air_temp_(other.pref_air_temp_),
-      pref_soil_ph_(other.pref_soil_ph_),
-      pref_light_level_(std::move(other.pref_light_level_)),
-      fun_facts_(std::move(other.fun_facts_)),
-      plantable_(other.plantable_) {}
-
-weatherer::CropData& weatherer::CropData::operator=(const CropData& other) {
-  if (this == &other)
-    return *this;
-  name_ = other.name_;
-  species_name_ = other.species_name_;
-  pref_soil_temp_ = other.pref_soil_temp_;
-  pref_air_temp_ = other.pref_air_temp_;
-  pref_soil_ph_ = other.pref_soil_ph_;
-  pref_light_level_ = other.pref_light_level_;
-  fun_facts_ = other.fun_facts_;
-  plantable_ = other.plantable_;
-  return *this;
-}
-
-weatherer::CropData& weatherer::CropData::operator=(CropData&& other) noexcept {
-  if (this == &other)
-    return *this;
-  name_ = std::move(other.name_);
-  species_name_ = std::move(other.species_name_);
-  pref_soil_temp_ = other.pref_soil_temp_;
-  pref_air_temp_ = other.pref_air_temp_;
-  pref_soil_ph_ = other.pref_soil_ph_;
-  pref_light_level_ = std::move(other.pref_light_level_);
-  fun_facts_ = std::move(other.fun_facts_);
-  plantable_ = other.plantable_;
-  return *this;
-}
-
-std::string weatherer::CropData::GetName() const {
+weatherer::CropData::CropData(CropData&& other) noexcept = default;
+
+weatherer::CropData& weatherer::CropData::operator=(const CropData& other) =
+    default;
+
+weatherer::CropData& weatherer::CropData::operator=(CropData&& other) noexcept =
+    default;
+
+std::string_view weatherer::CropData::GetName() const {
   return name_;
 }
 
-void weatherer::CropData::SetName(const std::string& name) {
-  name_ = name;
+void weatherer::CropData::SetName(const std::string_view name) {
+  name_ = util::StringPool::Intern(name);
 }
 
-std::string weatherer::CropData::GetSpeciesName() const {
+std::string_view weatherer::CropData::GetSpeciesName() const {
   return species_name_;
 }
 
-void weatherer::CropData::SetSpeciesName(const std::string& species_name) {
-  species_name_ = species_name;
+void weatherer::CropData::SetSpeciesName(const std::string_view species_name) {
+  species_name_ = util::StringPool::Intern(species_name);
 }
 
 int weatherer::CropData::GetPrefSoilTemp() const {
@@ -86,12 +80,11 @@ weatherer::util::NumericRange<double> weatherer::CropData::GetPrefSoilPh()
   return pref_soil_ph_;
 }
 
-std::string weatherer::CropData::GetPrefLightLevel() const {
+weatherer::LightLevel weatherer::CropData::GetPrefLightLevel() const {
   return pref_light_level_;
 }
 
-void weatherer::CropData::SetPrefLightLevel(
-    const std::string& pref_light_level) {
+void weatherer::CropData::SetPrefLightLevel(const LightLevel pref_light_level) {
   pref_light_level_ = pref_light_level;
 }
 
@@ -100,12 +93,13 @@ void weatherer::CropData::SetPrefSoilPh(
   pref_soil_ph_ = pref_soil_ph;
 }
 
-std::string weatherer::CropData::GetFunFacts() const {
-  return fun_facts_;
+std::string_view weatherer::CropData::GetFunFacts() const {
+  return fun_facts_ != nullptr ? std::string_view{*fun_facts_} : "N/A";
 }
 
-void weatherer::CropData::SetFunFacts(const std::string& fun_facts) {
-  fun_facts_ = fun_facts;
+void weatherer::CropData::SetFunFacts(
+    std::shared_ptr<const std::string> fun_facts) {
+  fun_facts_ = std::move(fun_facts);
 }
 
 bool weatherer::CropData::IsPlantable() const {
@@ -1,19 +1,47 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 #include "util/NumericRange.hpp"
 
 namespace weatherer {
+/**
+ * @brief The light exposure a crop prefers.
+ */
+enum class LightLevel : std::uint8_t { kUnknown, kFull, kPartial, kFullOrPartial };
+
+/**
+ * @param level The light level.
+ * @return The name of level as written in the crop database, e.g. "Full".
+ */
+[[nodiscard]] std::string_view ToString(LightLevel level);
+
+/**
+ * @param str A light exposure as written in the crop database.
+ * @return The matching light level, or LightLevel::kUnknown if there is none.
+ */
+[[nodiscard]] LightLevel ParseLightLevel(std::string_view str);
+
+/**
+ * @brief The preferences of a single crop.
+ *
+ * Crop text is not owned: names are interned in util::StringPool and the fun
+ * facts are shared with their source, so copying or printing a crop does not
+ * allocate per field.
+ */
 class CropData {
  private:
-  std::string name_;
-  std::string species_name_;
+  std::string_view name_;
+  std::string_view species_name_;
   int pref_soil_temp_;
   int pref_air_temp_;
   util::NumericRange<double> pref_soil_ph_;
-  std::string pref_light_level_;
-  std::string fun_facts_;
+  LightLevel pref_light_level_;
+  // Null until fun facts are set; viewed only when they are asked for.
+  std::shared_ptr<const std::string> fun_facts_;
   bool plantable_ = false;
 
  public:
@@ -26,20 +54,27 @@ class CropData {
   CropData& operator=(const CropData& other);
   CropData& operator=(CropData&& other) noexcept;
 
-  [[nodiscard]] std::string GetName() const;
-  void SetName(const std::string& name);
-  [[nodiscard]] std::string GetSpeciesName() const;
-  void SetSpeciesName(const std::string& species_name);
+  [[nodiscard]] std::string_view GetName() const;
+  void SetName(std::string_view name);
+  [[nodiscard]] std::string_view GetSpeciesName() const;
+  void SetSpeciesName(std::string_view species_name);
   [[nodiscard]] int GetPrefSoilTemp() const;
   void SetPrefSoilTemp(int pref_soil_temp);
   [[nodiscard]] int GetPrefAirTemp() const;
   void SetPrefAirTemp(int pref_air_temp);
   [[nodiscard]] util::NumericRange<double> GetPrefSoilPh() const;
-  [[nodiscard]] std::string GetPrefLightLevel() const;
-  void SetPrefLightLevel(const std::string& pref_light_level);
+  [[nodiscard]] LightLevel GetPrefLightLevel() const;
+  void SetPrefLightLevel(LightLevel pref_light_level);
   void SetPrefSoilPh(const util::NumericRange<double>& pref_soil_ph);
-  [[nodiscard]] std::string GetFunFacts() const;
-  void SetFunFacts(const std::string& fun_facts);
+  /**
+   * @return The fun facts, or "N/A" if there are none.
+   */
+  [[nodiscard]] std::string_view GetFunFacts() const;
+  /**
+   * @param fun_facts The fun facts text; may alias a larger owner, such as the
+   * crop database, which is then kept alive by this crop.
+   */
+  void SetFunFacts(std::shared_ptr<const std::string> fun_facts);
   [[nodiscard]] bool IsPlantable() const;
   void SetPlantable(bool plantable);
 
@@ -56,9 +91,9 @@ inline std::ostream& operator<<(std::ostream& os, const CropData& obj) {
     os << "Pref Soil Temp: " << obj.pref_soil_temp_ << "\n"
        << "Pref Air Temp: " << obj.pref_air_temp_ << "\n"
        << "Pref Soil Ph: " << obj.pref_soil_ph_ << "\n"
-       << "Pref Light Level: " << obj.pref_light_level_ << "\n";
+       << "Pref Light Level: " << ToString(obj.pref_light_level_) << "\n";
     if (obj.GetFunFacts() != "N/A") {
-      os << "Fun Facts: " << obj.fun_facts_ << "\n";
+      os << "Fun Facts: " << obj.GetFunFacts() << "\n";
     }
     os << "Plantable: " << std::boolalpha << obj.plantable_ << "\n\n";
   }
@@ -0,0 +1,69 @@
+#include "EnsembleForecast.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "PvData.hpp"
+
+weatherer::EnsembleForecast::EnsembleForecast(const std::size_t member_count,
+                                              std::vector<Day> days)
+    : member_count_(member_count),
+      days_(std::move(days)),
+      shortwave_radiation_(member_count * days_.size() * kHoursPerDay),
+      temperature_(member_count * days_.size() * kHoursPerDay),
+      cloud_cover_total_(member_count * days_.size() * kHoursPerDay) {}
+
+std::size_t weatherer::EnsembleForecast::GetOffset(const std::size_t member,
+                                                   const std::size_t day) const {
+  [[unlikely]] if (member >= member_count_ || day >= days_.size()) {
+    throw std::out_of_range("Ensemble member or day out of range");
+  }
+  return (member * days_.size() + day) * kHoursPerDay;
+}
+
+std::span<const double> weatherer::EnsembleForecast::GetShortwaveRadiation(
+    const std::size_t member) const {
+  [[unlikely]] if (member >= member_count_) {
+    throw std::out_of_range("Ensemble member out of range");
+  }
+  return std::span{shortwave_radiation_}.subspan(
+      member * days_.size() * kHoursPerDay, days_.size() * kHoursPerDay);
+}
+
+std::span<const double> weatherer::EnsembleForecast::GetTemperature(
+    const std::size_t member) const {
+  [[unlikely]] if (member >= member_count_) {
+    throw std::out_of_range("Ensemble member out of range");
+  }
+  return std::span{temperature_}.subspan(member * days_.size() * kHoursPerDay,
+                                         days_.size() * kHoursPerDay);
+}
+
+std::span<const double> weatherer::EnsembleForecast::GetCloudCoverTotal(
+    const std::size_t member) const {
+  [[unlikely]] if (member >= member_count_) {
+    throw std::out_of_range("Ensemble member out of range");
+  }
+  return std::span{cloud_cover_total_}.subspan(
+      member * days_.size() * kHoursPerDay, days_.size() * kHoursPerDay);
+}
+
+void weatherer::EnsembleForecast::SetMemberDay(
+    const std::size_t member, const std::size_t day,
+    std::span<const double> shortwave_radiation,
+    std::span<const double> temperature,
+    std::span<const double> cloud_cover_total,
+    const std::size_t clock_change) {
+  const std::size_t offset = GetOffset(member, day);
+  // Divide by 1000 to convert from W/m^2 to kWh/m^2.
+  PvData::FoldHours(shortwave_radiation,
+                    std::span{shortwave_radiation_}.subspan(offset).first<24>(),
+                    1000.0, true, clock_change);
+  PvData::FoldHours(temperature,
+                    std::span{temperature_}.subspan(offset).first<24>(), 1.0,
+                    false, clock_change);
+  // Divide by 100 to convert from percentage to decimal.
+  PvData::FoldHours(cloud_cover_total,
+                    std::span{cloud_cover_total_}.subspan(offset).first<24>(),
+                    100.0, false, clock_change);
+}
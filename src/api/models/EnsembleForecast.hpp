@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <ctime>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace weatherer {
+/**
+ * @brief The mean, spread and quantiles of one day's energy yield across the
+ * members of an ensemble.
+ */
+struct YieldDistribution {
+  // Date format (e.g. 2021-01-01)
+  std::string date;
+  // Units: kWh
+  double mean = 0;
+  // The population standard deviation across members, in kWh.
+  double spread = 0;
+  // One yield per requested quantile, in the order requested.
+  std::vector<double> quantiles{};
+};
+
+/**
+ * @brief Every member of an ensemble forecast for one location.
+ *
+ * The hourly variables are stored as one contiguous column each, member-major:
+ * the hours of a member follow each other, and the members follow each other,
+ * so a member's series is a single span. Every day takes 24 slots, folded and
+ * converted to the units PvData stores exactly as PvData's hourly setters do;
+ * member m, day d and hour h is at index (m * GetDayCount() + d) * 24 + h.
+ *
+ * Sunrise and sunset do not vary between members and are stored once per day.
+ */
+class EnsembleForecast {
+ public:
+  static constexpr std::size_t kHoursPerDay = 24;
+
+  struct Day {
+    // Date format (e.g. 2021-01-01)
+    std::string date;
+    std::time_t sunrise_time;
+    std::time_t sunset_time;
+  };
+
+ private:
+  std::size_t member_count_;
+  std::vector<Day> days_;
+  // Units: kWh/m^2
+  std::vector<double> shortwave_radiation_;
+  // Units: degrees Celsius
+  std::vector<double> temperature_;
+  // Value between 0 and 1
+  std::vector<double> cloud_cover_total_;
+
+  /**
+   * @throws std::out_of_range if member or day is out of range.
+   */
+  [[nodiscard]] std::size_t GetOffset(std::size_t member,
+                                      std::size_t day) const;
+
+ public:
+  /**
+   * @brief Constructs a forecast with every hourly value zero.
+   * @param member_count The number of members, including the control run.
+   * @param days The days covered, in chronological order.
+   */
+  EnsembleForecast(std::size_t member_count, std::vector<Day> days);
+
+  [[nodiscard]] std::size_t GetMemberCount() const { return member_count_; }
+
+  [[nodiscard]] std::size_t GetDayCount() const { return days_.size(); }
+
+  [[nodiscard]] std::vector<Day> const& GetDays() const { return days_; }
+
+  /**
+   * @return Every hour of a member, day after day; kHoursPerDay per day.
+   * @throws std::out_of_range if member is out of range.
+   */
+  [[nodiscard]] std::span<const double> GetShortwaveRadiation(
+      std::size_t member) const;
+
+  [[nodiscard]] std::span<const double> GetTemperature(
+      std::size_t member) const;
+
+  [[nodiscard]] std::span<const double> GetCloudCoverTotal(
+      std::size_t member) const;
+
+  /**
+   * @brief Sets one day of one member from the samples of that calendar day.
+   * @param member The index of the member; 0 is the control run.
+   * @param day The index of the day.
+   * @param shortwave_radiation Units: W/m^2
+   * @param temperature Units: degrees Celsius
+   * @param cloud_cover_total Units: percent
+   * @param clock_change The index of the first sample after the daylight
+   * saving transition of the day; see util::DayBoundaries::FindClockChange.
+   * @throws std::out_of_range if member or day is out of range.
+   *
+   * Converts units and folds daylight saving hours as PvData's setters do.
+   */
+  void SetMemberDay(std::size_t member, std::size_t day,
+                    std::span<const double> shortwave_radiation,
+                    std::span<const double> temperature,
+                    std::span<const double> cloud_cover_total,
+                    std::size_t clock_change);
+};
+}  // namespace weatherer
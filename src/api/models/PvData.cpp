@@ -2,15 +2,34 @@
 
 #include <algorithm>
 
+
 weatherer::PvData::PvData()
     : date_({}),
       sunrise_time_(0),
       sunset_time_(0),
+      day_start_(0),
+      day_end_(0),
       shortwave_radiation_({}),
       temperature_({}),
       cloud_cover_total_({}),
       wind_speed_({}) {}
 
+weatherer::PvData::PvData(std::string date, const std::time_t sunrise_time,
+                          const std::time_t sunset_time,
+                          std::array<double, 24> const& shortwave_radiation,
+                          std::array<double, 24> const& temperature,
+                          std::array<double, 24> const& cloud_cover_total,
+                          std::array<double, 24> const& wind_speed)
+    : date_(std::move(date)),
+      sunrise_time_(sunrise_time),
+      sunset_time_(sunset_time),
+      day_start_(0),
+      day_end_(0),
+      shortwave_radiation_(shortwave_radiation),
+      temperature_(temperature),
+      cloud_cover_total_(cloud_cover_total),
+      wind_speed_(wind_speed) {}
+
 weatherer::PvData::~PvData() = default;
 
 weatherer::PvData::PvData(const PvData& other) = default;
@@ -19,6 +38,8 @@ weatherer::PvData::PvData(PvData&& other) noexcept
       : date_(std::move(other.date_)),
         sunrise_time_(other.sunrise_time_),
         sunset_time_(other.sunset_time_),
+        day_start_(other.day_start_),
+        day_end_(other.day_end_),
         shortwave_radiation_(other.shortwave_radiation_),
         temperature_(other.temperature_),
         cloud_cover_total_(other.cloud_cover_total_),
@@ -30,6 +51,8 @@ weatherer::PvData& weatherer::PvData::operator=(const PvData& other) {
   date_ = other.date_;
   sunrise_time_ = other.sunrise_time_;
   sunset_time_ = other.sunset_time_;
+  day_start_ = other.day_start_;
+  day_end_ = other.day_end_;
   shortwave_radiation_ = other.shortwave_radiation_;
   temperature_ = other.temperature_;
   cloud_cover_total_ = other.cloud_cover_total_;
@@ -42,6 +65,8 @@ weatherer::PvData& weatherer::PvData::operator=(PvData&& other) noexcept {
   date_ = std::move(other.date_);
   sunrise_time_ = other.sunrise_time_;
   sunset_time_ = other.sunset_time_;
+  day_start_ = other.day_start_;
+  day_end_ = other.day_end_;
   shortwave_radiation_ = other.shortwave_radiation_;
   temperature_ = other.temperature_;
   cloud_cover_total_ = other.cloud_cover_total_;
@@ -49,6 +74,44 @@ weatherer::PvData& weatherer::PvData::operator=(PvData&& other) noexcept {
   return *this;
 }
 
+void weatherer::PvData::FoldHours(std::span<const double> hours,
+                                  std::span<double, 24> slots,
+                                  const double divisor, const bool sum,
+                                  const std::size_t clock_change) {
+  std::ranges::fill(slots, 0.0);
+  if (hours.size() > slots.size()) {
+    // The clocks went back: fold the samples of the repeated hour together.
+    const std::size_t extra = hours.size() - slots.size();
+    const std::size_t repeated =
+        std::clamp<std::size_t>(clock_change, 1, slots.size()) - 1;
+    for (std::size_t i = 0; i < repeated; ++i) {
+      slots[i] = hours[i] / divisor;
+    }
+    double total = 0;
+    for (const double value : hours.subspan(repeated, extra + 1)) {
+      total += value / divisor;
+    }
+    slots[repeated] = sum ? total : total / static_cast<double>(extra + 1);
+    for (std::size_t i = repeated + 1; i < slots.size(); ++i) {
+      slots[i] = hours[i + extra] / divisor;
+    }
+    return;
+  }
+
+  // The clocks went forward, if at all: samples from the change on move up
+  // past the skipped slots.
+  const std::size_t missing = slots.size() - hours.size();
+  const std::size_t skipped = std::min(clock_change, hours.size());
+  for (std::size_t i = 0; i < hours.size(); ++i) {
+    slots[i < skipped ? i : i + missing] = hours[i] / divisor;
+  }
+  if (sum || missing == 0 || hours.empty()) {
+    return;
+  }
+  const double fill = skipped > 0 ? slots[skipped - 1] : slots[missing];
+  std::fill_n(slots.begin() + skipped, missing, fill);
+}
+
 std::string weatherer::PvData::GetDate() const {
   return date_;
 }
@@ -73,28 +136,38 @@ void weatherer::PvData::SetSunsetTime(const std::time_t sunset_time) {
   sunset_time_ = sunset_time;
 }
 
+std::time_t weatherer::PvData::GetDayStart() const {
+  return day_start_;
+}
+
+std::time_t weatherer::PvData::GetDayEnd() const {
+  return day_end_;
+}
+
+void weatherer::PvData::SetDayBounds(const std::time_t day_start,
+                                     const std::time_t day_end) {
+  day_start_ = day_start;
+  day_end_ = day_end;
+}
+
 std::array<double, 24> weatherer::PvData::GetShortwaveRadiation() const {
   return shortwave_radiation_;
 }
 
 void weatherer::PvData::SetShortwaveRadiation(
-    const std::array<int, 24>& shortwave_radiation) {
-  shortwave_radiation_ = std::array<double, 24>{};
+    std::span<const double> shortwave_radiation,
+    const std::size_t clock_change) {
   // Divide by 1000 to convert from W/m^2 to kWh/m^2.
-  std::ranges::transform(shortwave_radiation.begin(), shortwave_radiation.end(),
-                         shortwave_radiation_.begin(),
-                         [](const int rad) {
-                           return rad / 1000.0;
-                         });
+  FoldHours(shortwave_radiation, shortwave_radiation_, 1000.0, true, clock_change);
 }
 
 std::array<double, 24> weatherer::PvData::GetTemperature() const {
   return temperature_;
 }
 
-void weatherer::PvData::SetTemperature(
-    const std::array<double, 24>& temperature) {
-  temperature_ = temperature;
+void weatherer::PvData::SetTemperature(std::span<const double> temperature,
+                                       const std::size_t clock_change) {
+  FoldHours(temperature, temperature_, 1.0, false, clock_change);
 }
 
 std::array<double, 24> weatherer::PvData::GetCloudCoverTotal() const {
@@ -102,20 +175,17 @@ std::array<double, 24> weatherer::PvData::GetCloudCoverTotal() const {
 }
 
 void weatherer::PvData::SetCloudCoverTotal(
-    const std::array<int, 24>& cloud_cover_total) {
-  cloud_cover_total_ = std::array<double, 24>{};
+    std::span<const double> cloud_cover_total,
+    const std::size_t clock_change) {
   // Divide by 100 to convert from percentage to decimal.
-  std::ranges::transform(cloud_cover_total.begin(), cloud_cover_total.end(),
-                         cloud_cover_total_.begin(),
-                         [](const int cover) {
-                           return cover / 100.0;
-                         });
+  FoldHours(cloud_cover_total, cloud_cover_total_, 100.0, false, clock_change);
 }
 
 std::array<double, 24> weatherer::PvData::GetWindSpeed() const {
   return wind_speed_;
 }
 
-void weatherer::PvData::SetWindSpeed(const std::array<double, 24>& wind_speed) {
-  wind_speed_ = wind_speed;
-}
\ No newline at end of file
+void weatherer::PvData::SetWindSpeed(std::span<const double> wind_speed,
+                                     const std::size_t clock_change) {
+  FoldHours(wind_speed, wind_speed_, 1.0, false, clock_change);
+}
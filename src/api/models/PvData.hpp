@@ -2,8 +2,10 @@
 #include <array>
 #include <ostream>
 #include <print>
+#include <span>
 #include <string>
 
+#include "util/ChunkOperator.hpp"
 #include "util/Date.hpp"
 
 namespace weatherer {
@@ -15,6 +17,13 @@ namespace weatherer {
  * radiation, temperature, cloud cover, and wind speed. It provides methods for
  * accessing and setting these data attributes and has a friend operator<< function
  * for convenient ostream output.
+ *
+ * The hourly setters accept the samples of one calendar day. Days around
+ * daylight saving transitions have 23 or 25 hours, folded into 24 slots at the
+ * clock change (see FoldHours): the repeated hour of a 25 hour day takes one
+ * slot (summed for radiation, averaged for the other quantities), and the hour
+ * skipped on a 23 hour day is zero for radiation and repeats the previous hour
+ * for the other quantities.
  */
 class PvData {
  private:
@@ -24,6 +33,10 @@ class PvData {
   std::time_t sunrise_time_;
   // Military time format (e.g. 00:00, 01:00, 02:00, ..., 23:00)
   std::time_t sunset_time_;
+  // The time of the first sample of the day, and the end of its last sample;
+  // both zero if unknown (e.g. for days read back from storage).
+  std::time_t day_start_;
+  std::time_t day_end_;
   // Units: kWh/m^2
   std::array<double, 24> shortwave_radiation_;
   // Units: degrees Celsius
@@ -35,6 +48,18 @@ class PvData {
 
  public:
   [[nodiscard]] explicit PvData();
+  /**
+   * @brief Constructs a day from values already in the units PvData stores.
+   *
+   * Unlike the hourly setters, the series are taken as is: no unit conversion
+   * or folding of daylight saving hours is applied.
+   */
+  [[nodiscard]] PvData(std::string date, std::time_t sunrise_time,
+                       std::time_t sunset_time,
+                       std::array<double, 24> const& shortwave_radiation,
+                       std::array<double, 24> const& temperature,
+                       std::array<double, 24> const& cloud_cover_total,
+                       std::array<double, 24> const& wind_speed);
   ~PvData();
   PvData(const PvData& other);
   PvData(PvData&& other) noexcept;
@@ -53,21 +78,58 @@ class PvData {
 
   void SetSunsetTime(const std::time_t sunset_time);
 
+  [[nodiscard]] std::time_t GetDayStart() const;
+
+  [[nodiscard]] std::time_t GetDayEnd() const;
+
+  /**
+   * @brief Records the timestamps bounding the samples of the day.
+   * @param day_start The time of the first sample.
+   * @param day_end The end of the last sample; the start of the next day.
+   */
+  void SetDayBounds(std::time_t day_start, std::time_t day_end);
+
   [[nodiscard]] std::array<double, 24> GetShortwaveRadiation() const;
 
-  void SetShortwaveRadiation(const std::array<int, 24>& diffuse_radiation);
+  void SetShortwaveRadiation(
+      std::span<const double> shortwave_radiation,
+      std::size_t clock_change = util::DayBoundaries::kDefaultClockChange);
 
   [[nodiscard]] std::array<double, 24> GetTemperature() const;
 
-  void SetTemperature(const std::array<double, 24>& temperature);
+  void SetTemperature(
+      std::span<const double> temperature,
+      std::size_t clock_change = util::DayBoundaries::kDefaultClockChange);
 
   [[nodiscard]] std::array<double, 24> GetCloudCoverTotal() const;
 
-  void SetCloudCoverTotal(const std::array<int, 24>& cloud_cover_total);
+  void SetCloudCoverTotal(
+      std::span<const double> cloud_cover_total,
+      std::size_t clock_change = util::DayBoundaries::kDefaultClockChange);
 
   [[nodiscard]] std::array<double, 24> GetWindSpeed() const;
 
-  void SetWindSpeed(const std::array<double, 24>& wind_speed);
+  void SetWindSpeed(
+      std::span<const double> wind_speed,
+      std::size_t clock_change = util::DayBoundaries::kDefaultClockChange);
+
+  /**
+   * @brief Copies the hours of one day into 24 slots, as the hourly setters do.
+   * @param hours The samples of the day.
+   * @param slots The slots to fill.
+   * @param divisor Every value is divided by it, converting its unit.
+   * @param sum Whether the samples of a repeated hour are summed rather than
+   * averaged.
+   * @param clock_change The index of the first sample after the daylight
+   * saving transition; see util::DayBoundaries::FindClockChange.
+   *
+   * On 25 hour days the hour before clock_change repeats, and its samples are
+   * folded into one slot. On 23 hour days the slot at clock_change is skipped:
+   * it is zero for summed values and repeats the previous hour otherwise.
+   */
+  static void FoldHours(std::span<const double> hours,
+                        std::span<double, 24> slots, double divisor, bool sum,
+                        std::size_t clock_change);
 
   /**
    * @brief Overloaded stream insertion operator to facilitate object output.
@@ -0,0 +1,100 @@
+#include "PvDayRecord.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+static_assert(sizeof(weatherer::PvDayRecord) == 192);
+
+namespace {
+// Rounds every hour of a PvData series to a multiple of 1 / scale.
+template <typename Ty_>
+std::array<Ty_, 24> Quantize(std::array<double, 24> const& values,
+                             const double scale) {
+  std::array<Ty_, 24> quantized{};
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const double scaled = std::round(values[i] * scale);
+    [[unlikely]] if (!(scaled >= std::numeric_limits<Ty_>::min() &&
+                       scaled <= std::numeric_limits<Ty_>::max())) {
+      throw std::invalid_argument("Value out of range for a day record: " +
+                                  std::to_string(values[i]));
+    }
+    quantized[i] = static_cast<Ty_>(scaled);
+  }
+  return quantized;
+}
+
+template <typename Ty_>
+std::array<double, 24> Widen(std::array<Ty_, 24> const& values,
+                             const double scale) {
+  std::array<double, 24> widened{};
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    widened[i] = values[i] / scale;
+  }
+  return widened;
+}
+
+std::chrono::year_month_day GetCalendarDate(const std::int32_t day_number) {
+  return std::chrono::year_month_day{
+      std::chrono::sys_days{std::chrono::days{day_number}}};
+}
+}  // namespace
+
+weatherer::PvDayRecord weatherer::PvDayRecord::FromPvData(
+    PvData const& pv_data) {
+  const std::string date = pv_data.GetDate();
+  int year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  [[unlikely]] if (std::sscanf(date.c_str(), "%d-%u-%u", &year, &month, &day) != 3) {
+    throw std::invalid_argument("Invalid date for a day record: " + date);
+  }
+  const std::chrono::year_month_day calendar_date{
+      std::chrono::year{year}, std::chrono::month{month}, std::chrono::day{day}};
+  [[unlikely]] if (!calendar_date.ok()) {
+    throw std::invalid_argument("Invalid date for a day record: " + date);
+  }
+
+  PvDayRecord record{};
+  record.sunrise_time = pv_data.GetSunriseTime();
+  record.sunset_time = pv_data.GetSunsetTime();
+  record.day_number = static_cast<std::int32_t>(
+      std::chrono::sys_days{calendar_date}.time_since_epoch().count());
+  record.shortwave_radiation =
+      Quantize<std::uint16_t>(pv_data.GetShortwaveRadiation(), 1000.0);
+  record.temperature = Quantize<std::int16_t>(pv_data.GetTemperature(), 10.0);
+  record.cloud_cover_total =
+      Quantize<std::uint8_t>(pv_data.GetCloudCoverTotal(), 100.0);
+  record.wind_speed = Quantize<std::uint16_t>(pv_data.GetWindSpeed(), 10.0);
+  return record;
+}
+
+weatherer::PvData weatherer::PvDayRecord::ToPvData() const {
+  return PvData{GetDate(),
+                static_cast<std::time_t>(sunrise_time),
+                static_cast<std::time_t>(sunset_time),
+                Widen(shortwave_radiation, 1000.0),
+                Widen(temperature, 10.0),
+                Widen(cloud_cover_total, 100.0),
+                Widen(wind_speed, 10.0)};
+}
+
+std::string weatherer::PvDayRecord::GetDate() const {
+  const auto calendar_date = GetCalendarDate(day_number);
+  char date[16]{};
+  std::snprintf(date, sizeof(date), "%04d-%02u-%02u",
+                static_cast<int>(calendar_date.year()),
+                static_cast<unsigned>(calendar_date.month()),
+                static_cast<unsigned>(calendar_date.day()));
+  return date;
+}
+
+int weatherer::PvDayRecord::GetDayOfYear() const {
+  const auto calendar_date = GetCalendarDate(day_number);
+  const std::chrono::sys_days new_year{calendar_date.year() /
+                                       std::chrono::January / 1};
+  return static_cast<int>(
+      (std::chrono::sys_days{calendar_date} - new_year).count());
+}
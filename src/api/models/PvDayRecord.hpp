@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "PvData.hpp"
+
+namespace weatherer {
+/**
+ * @brief A compact, fixed-size day of weather for holding many days in memory.
+ *
+ * PvDayRecord stores the same day as PvData, quantized to the precision the
+ * weather API reports: whole W/m^2, 0.1 degrees Celsius, whole percent and
+ * 0.1 km/h, with the date kept as a day number rather than a string. A record
+ * takes 192 bytes and is meant to be held by value in contiguous containers,
+ * against roughly 1 KiB for a PvData behind a shared_ptr in a hash map. The
+ * getters widen a single hour back to the units PvData uses.
+ */
+struct PvDayRecord {
+  std::int64_t sunrise_time;
+  std::int64_t sunset_time;
+  // Days since 1970-01-01 of the calendar date.
+  std::int32_t day_number;
+  // Units: W/m^2
+  std::array<std::uint16_t, 24> shortwave_radiation;
+  // Units: 0.1 degrees Celsius
+  std::array<std::int16_t, 24> temperature;
+  // Units: percent
+  std::array<std::uint8_t, 24> cloud_cover_total;
+  // Units: 0.1 km/h
+  std::array<std::uint16_t, 24> wind_speed;
+
+  /**
+   * @brief Quantizes a day of PvData.
+   * @param pv_data The day to convert.
+   * @return The compact record.
+   * @throws std::invalid_argument if the date cannot be parsed or a value is
+   * outside the range of its field.
+   */
+  [[nodiscard]] static PvDayRecord FromPvData(PvData const& pv_data);
+
+  [[nodiscard]] PvData ToPvData() const;
+
+  // Date format (e.g. 2021-01-01)
+  [[nodiscard]] std::string GetDate() const;
+
+  // Zero-based, as std::tm::tm_yday.
+  [[nodiscard]] int GetDayOfYear() const;
+
+  // Units: kWh/m^2
+  [[nodiscard]] double GetShortwaveRadiation(const std::size_t hour) const {
+    return shortwave_radiation[hour] / 1000.0;
+  }
+
+  // Units: degrees Celsius
+  [[nodiscard]] double GetTemperature(const std::size_t hour) const {
+    return temperature[hour] / 10.0;
+  }
+
+  // Value between 0 and 1
+  [[nodiscard]] double GetCloudCoverTotal(const std::size_t hour) const {
+    return cloud_cover_total[hour] / 100.0;
+  }
+
+  // Units: km/h
+  [[nodiscard]] double GetWindSpeed(const std::size_t hour) const {
+    return wind_speed[hour] / 10.0;
+  }
+};
+}  // namespace weatherer
@@ -1,10 +1,82 @@
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
 #include "api/CropDataProcessor.hpp"
+#include "api/HistoricalStore.hpp"
+#include "api/PvDataProcessor.hpp"
 #include "nlohmann/json.hpp"
+#include "server/QueryServer.hpp"
 #include "util/ChunkOperator.hpp"
+#include "util/Interrupt.hpp"
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+void PrintUsage() {
+  std::cout
+      << "Usage: Weatherer [--serve [options]]\n"
+         "  Without --serve, asks for an address and prints its crops.\n"
+         "  --serve              Answer queries over HTTP until interrupted\n"
+         "  --host <host>        Address to bind (default: 127.0.0.1)\n"
+         "  --port <port>        Port to bind (default: 8081)\n"
+         "  --socket <path>      Listen on a Unix domain socket instead\n"
+         "  --threads <count>    Worker threads (default: 8)\n"
+         "  --plant-map <file>   Serve /crops/plantable from a plant map\n";
+}
+
+int Serve(weatherer::server::QueryServer::Options const& options) {
+  weatherer::server::QueryServer server{options};
+  const weatherer::util::InterruptWatcher interrupt{[&server] { server.Stop(); }};
+
+  std::cout << "Serving queries on "
+            << (options.unix_socket.empty()
+                    ? options.host + ":" + std::to_string(options.port)
+                    : options.unix_socket)
+            << std::endl;
+  server.Listen();
+  std::cout << "Served: " << server.GetServedCount()
+            << " Failed: " << server.GetFailedCount() << "\n";
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  bool serve = false;
+  weatherer::server::QueryServer::Options server_options{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      return 0;
+    }
+    if (arg == "--serve") {
+      serve = true;
+      continue;
+    }
+    [[unlikely]] if (i + 1 >= argc) {
+      PrintUsage();
+      return 1;
+    }
+    const std::string value{argv[++i]};
+    if (arg == "--host") {
+      server_options.host = value;
+    } else if (arg == "--port") {
+      server_options.port = std::stoi(value);
+    } else if (arg == "--socket") {
+      server_options.unix_socket = value;
+    } else if (arg == "--threads") {
+      server_options.threads = std::stoul(value);
+    } else if (arg == "--plant-map") {
+      server_options.plant_map = value;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
 
-int main() {
   // double latitute{}, longitude{}, panel_eff{}, panel_area{};
   // std::println("Enter latitude (Example: 34.0549)");
   // std::cin >> latitute;
@@ -21,6 +93,51 @@ int main() {
   // // pv_handle->OutputData(std::cout);
   // pv_handle->OutputDailyEnergyYeild(std::cout, panel_eff, panel_area);
 
+  // Set WEATHERER_TRACE to a file path to record a Chrome/Perfetto trace.
+  const char* trace_path = std::getenv("WEATHERER_TRACE");
+  if (trace_path != nullptr) {
+    weatherer::util::Tracer::Enable();
+  }
+  const auto write_trace = [trace_path] {
+    if (trace_path != nullptr) {
+      std::ofstream trace_file{trace_path};
+      weatherer::util::Tracer::WriteChromeTrace(trace_file);
+    }
+  };
+
+  // Set WEATHERER_METRICS to a file path, or "-" for stdout, to dump metrics in
+  // the Prometheus text format every WEATHERER_METRICS_INTERVAL_MS (10 s).
+  std::unique_ptr<weatherer::util::MetricsDumper> metrics_dumper{};
+  if (const char* metrics_path = std::getenv("WEATHERER_METRICS");
+      metrics_path != nullptr) {
+    const char* interval = std::getenv("WEATHERER_METRICS_INTERVAL_MS");
+    metrics_dumper = std::make_unique<weatherer::util::MetricsDumper>(
+        metrics_path, std::chrono::milliseconds{
+                          interval != nullptr ? std::atoll(interval) : 10000});
+  }
+
+  // Set WEATHERER_STORE_DIR to a directory to keep historical weather locally,
+  // so that each archived day is only downloaded once.
+  if (const char* store_dir = std::getenv("WEATHERER_STORE_DIR");
+      store_dir != nullptr) {
+    weatherer::PvDataProcessor::SetHistoricalStore(
+        std::make_shared<weatherer::HistoricalStore>(store_dir));
+  }
+
+  // Set WEATHERER_RESPONSE_FORMAT to "flatbuffers" to request weather in
+  // Open-Meteo's binary format instead of JSON.
+  if (const char* format = std::getenv("WEATHERER_RESPONSE_FORMAT");
+      format != nullptr && std::string_view{format} == "flatbuffers") {
+    weatherer::PvDataProcessor::SetResponseFormat(
+        weatherer::ResponseFormat::kFlatBuffers);
+  }
+
+  if (serve) {
+    const int status = Serve(server_options);
+    write_trace();
+    return status;
+  }
+
   std::cout << "Address: ";
   std::string address{};
   std::getline(std::cin, address);
@@ -31,6 +148,8 @@ int main() {
     std::cout << *value;
   }
 
+  write_trace();
+
   system("pause");
   return 0;
 }
@@ -0,0 +1,370 @@
+#include "QueryServer.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include "api/CropDataProcessor.hpp"
+#include "api/PvClimatology.hpp"
+#include "api/PvDataProcessor.hpp"
+#include "api/PvMetrics.hpp"
+#include "util/Date.hpp"
+#include "util/Metrics.hpp"
+#include "util/RequestArena.hpp"
+#include "util/RequestScheduler.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+using Json = nlohmann::json;
+
+std::string GetRequiredParam(const httplib::Request& req,
+                             std::string const& name) {
+  [[unlikely]] if (!req.has_param(name)) {
+    throw std::invalid_argument("Missing query parameter: " + name);
+  }
+  return req.get_param_value(name);
+}
+
+double GetRequiredNumber(const httplib::Request& req,
+                         std::string const& name) {
+  const std::string value = GetRequiredParam(req, name);
+  try {
+    return std::stod(value);
+  } catch (std::exception const&) {
+    throw std::invalid_argument("Query parameter " + name +
+                                " is not a number: " + value);
+  }
+}
+
+// Parses a whole number parameter; fractions, exponents and values outside
+// [min, max] are rejected, so the result is safe to narrow.
+long long GetRequiredInteger(const httplib::Request& req,
+                             std::string const& name, const long long min,
+                             const long long max) {
+  const std::string value = GetRequiredParam(req, name);
+  long long number = 0;
+  const auto [end, error] =
+      std::from_chars(value.data(), value.data() + value.size(), number);
+  [[unlikely]] if (error != std::errc{} || end != value.data() + value.size() ||
+                   number < min || number > max) {
+    throw std::invalid_argument("Query parameter " + name +
+                                " must be an integer between " +
+                                std::to_string(min) + " and " +
+                                std::to_string(max) + ": " + value);
+  }
+  return number;
+}
+
+// Parses a YYYY-MM-DD parameter into local midnight of that day.
+weatherer::util::Date GetRequiredDate(const httplib::Request& req,
+                                      std::string const& name) {
+  const std::string value = GetRequiredParam(req, name);
+  int year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  char trailing = 0;
+  const bool parsed = std::sscanf(value.c_str(), "%4d-%2u-%2u%c", &year,
+                                  &month, &day, &trailing) == 3;
+  [[unlikely]] if (!parsed ||
+                   !std::chrono::year_month_day{std::chrono::year{year},
+                                                std::chrono::month{month},
+                                                std::chrono::day{day}}
+                        .ok()) {
+    throw std::invalid_argument("Query parameter " + name +
+                                " is not a date (YYYY-MM-DD): " + value);
+  }
+  std::tm time{};
+  time.tm_year = year - 1900;
+  time.tm_mon = static_cast<int>(month) - 1;
+  time.tm_mday = static_cast<int>(day);
+  time.tm_isdst = -1;
+  return weatherer::util::Date{std::mktime(&time)};
+}
+
+Json ToJson(weatherer::ExceedanceLevels const& levels) {
+  return Json{{"p50", levels.p50}, {"p90", levels.p90}, {"p99", levels.p99}};
+}
+
+Json ToJson(weatherer::CropData const& crop) {
+  const auto soil_ph = crop.GetPrefSoilPh();
+  return Json{{"name", crop.GetName()},
+              {"species_name", crop.GetSpeciesName()},
+              {"pref_soil_temp", crop.GetPrefSoilTemp()},
+              {"pref_air_temp", crop.GetPrefAirTemp()},
+              {"pref_soil_ph", {soil_ph.GetMin(), soil_ph.GetMax()}},
+              {"pref_light_level", ToString(crop.GetPrefLightLevel())},
+              {"fun_facts", crop.GetFunFacts()},
+              {"plantable", crop.IsPlantable()}};
+}
+
+// Runs a handler, mapping its exceptions to HTTP error responses.
+template <typename Fn_>
+bool Respond(httplib::Response& res, Fn_&& fn) {
+  try {
+    res.set_content(std::forward<Fn_>(fn)().dump(), "application/json");
+    return true;
+  } catch (std::invalid_argument const& e) {
+    res.status = 400;
+    res.set_content(Json{{"error", e.what()}}.dump(), "application/json");
+  } catch (nlohmann::json::out_of_range const& e) {
+    // The databases and API responses are looked up with at().
+    res.status = 404;
+    res.set_content(Json{{"error", e.what()}}.dump(), "application/json");
+  } catch (std::exception const& e) {
+    res.status = 500;
+    res.set_content(Json{{"error", e.what()}}.dump(), "application/json");
+  }
+  return false;
+}
+}  // namespace
+
+weatherer::server::QueryServer::QueryServer(
+    Options options, std::shared_ptr<const CropDatabase> database)
+    : options_(std::move(options)),
+      database_(std::move(database)),
+      server_(std::make_unique<httplib::Server>()),
+      locations_(kLocationCacheTtl_, kLocationCacheCapacity_) {
+  [[unlikely]] if (!database_) {
+    throw std::invalid_argument("Crop database must not be null");
+  }
+
+  // A client waiting on the other end is better served by an error than by
+  // queueing behind the rate limit for minutes.
+  util::SchedulerPolicy policy = util::RequestScheduler::GetPolicy();
+  policy.max_queue_wait = options_.max_queue_wait;
+  util::RequestScheduler::SetPolicy(policy);
+
+  const std::size_t threads = options_.threads;
+  server_->new_task_queue = [threads] {
+    return new httplib::ThreadPool(threads);
+  };
+  server_->Get("/crops", [this](const httplib::Request& req,
+                                httplib::Response& res) {
+    HandleCrops(req, res);
+  });
+  if (!options_.plant_map.empty()) {
+    plant_map_ = std::make_unique<const PlantMap>(options_.plant_map);
+    server_->Get("/crops/plantable", [this](const httplib::Request& req,
+                                            httplib::Response& res) {
+      HandlePlantable(req, res);
+    });
+  }
+  server_->Get("/pv", [this](const httplib::Request& req,
+                             httplib::Response& res) { HandlePv(req, res); });
+  server_->Get("/pv/climatology", [this](const httplib::Request& req,
+                                         httplib::Response& res) {
+    HandleClimatology(req, res);
+  });
+  server_->Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+    std::ostringstream os{};
+    util::Metrics::WritePrometheus(os);
+    res.set_content(os.str(), "text/plain; version=0.0.4");
+  });
+  server_->Get("/healthz", [](const httplib::Request&, httplib::Response& res) {
+    res.set_content("ok", "text/plain");
+  });
+}
+
+weatherer::server::QueryServer::~QueryServer() {
+  Stop();
+}
+
+void weatherer::server::QueryServer::Listen() {
+  bool bound = false;
+  if (!options_.unix_socket.empty()) {
+#ifdef _WIN32
+    throw std::runtime_error("Unix domain sockets are not supported here");
+#else
+    // A socket file left behind by a previous run would make bind fail.
+    std::filesystem::remove(options_.unix_socket);
+    server_->set_address_family(AF_UNIX);
+    bound = server_->bind_to_port(options_.unix_socket, 80);
+#endif
+  } else {
+    bound = server_->bind_to_port(options_.host, options_.port);
+  }
+  [[unlikely]] if (!bound) {
+    throw std::runtime_error("Failed to bind query server");
+  }
+  server_->listen_after_bind();
+}
+
+void weatherer::server::QueryServer::Stop() {
+  server_->stop();
+}
+
+weatherer::util::LocationData
+weatherer::server::QueryServer::ResolveLocation(const httplib::Request& req) {
+  if (req.has_param("address")) {
+    const std::string address = req.get_param_value("address");
+    if (auto cached = locations_.Get(address)) {
+      return std::move(*cached);
+    }
+    util::LocationData location = util::Geolocation::GetLocationData(address);
+    locations_.Put(address, location);
+    return location;
+  }
+  return util::LocationData{
+      Coordinates{GetRequiredNumber(req, "latitude"),
+                  GetRequiredNumber(req, "longitude")},
+      GetRequiredParam(req, "zipcode")};
+}
+
+void weatherer::server::QueryServer::HandleCrops(const httplib::Request& req,
+                                                 httplib::Response& res) {
+  util::TraceSpan span{"QueryServer::HandleCrops"};
+  const bool ok = Respond(res, [&] {
+    const util::LocationData location = ResolveLocation(req);
+    const CropDataProcessor processor{location, database_};
+
+    // Planting windows need the full forecast horizon, so only on request.
+    std::optional<PlantingWindows> windows{};
+    if (req.has_param("window_days")) {
+      const auto window_days = GetRequiredInteger(
+          req, "window_days", 1,
+          static_cast<long long>(CropDataProcessor::kForecastHorizonDays));
+      windows = processor.GetPlantingWindows(static_cast<std::size_t>(window_days));
+    }
+
+    Json crops = Json::array();
+    for (auto const& [crop_name, crop] : *processor.GetData()) {
+      Json crop_json = ToJson(*crop);
+      if (windows) {
+        const auto& window = windows->at(crop_name);
+        crop_json["planting_window"] =
+            window ? Json{{"start_date", window->start_date},
+                          {"days", window->days}}
+                   : Json(nullptr);
+      }
+      crops.push_back(std::move(crop_json));
+    }
+    return Json{{"latitude", location.first.GetLatitude()},
+                {"longitude", location.first.GetLongitude()},
+                {"zipcode", location.second},
+                {"zone", processor.GetHardnessZone(location.second)},
+                {"crops", std::move(crops)}};
+  });
+  ++(ok ? served_ : failed_);
+}
+
+void weatherer::server::QueryServer::HandlePlantable(
+    const httplib::Request& req, httplib::Response& res) {
+  util::TraceSpan span{"QueryServer::HandlePlantable"};
+  const bool ok = Respond(res, [&] {
+    const std::string zipcode = GetRequiredParam(req, "zipcode");
+    const auto entry = plant_map_->Find(zipcode);
+    [[unlikely]] if (!entry) {
+      throw std::invalid_argument("Zipcode is not in the plant map: " + zipcode);
+    }
+
+    Json crops = Json::array();
+    for (const std::size_t crop : entry->plantable) {
+      crops.push_back(plant_map_->GetCropNames().at(crop));
+    }
+    return Json{{"zipcode", entry->zipcode},
+                {"zone", entry->zone},
+                {"generated_at", plant_map_->GetGeneratedAt()},
+                {"plantable", std::move(crops)}};
+  });
+  ++(ok ? served_ : failed_);
+}
+
+void weatherer::server::QueryServer::HandlePv(const httplib::Request& req,
+                                              httplib::Response& res) {
+  util::TraceSpan span{"QueryServer::HandlePv"};
+  const bool ok = Respond(res, [&] {
+    const Coordinates coords{GetRequiredNumber(req, "latitude"),
+                             GetRequiredNumber(req, "longitude")};
+    const util::TimeFrame time_frame{GetRequiredDate(req, "start_date"),
+                                     GetRequiredDate(req, "end_date")};
+    const std::time_t day_count =
+        (time_frame.GetEndDate() - time_frame.GetStartDate()) /
+        util::Date::kSecondsPerDay;
+    [[unlikely]] if (day_count < 0 || day_count > kMaxPvDays_) {
+      throw std::invalid_argument(
+          "The end date must follow the start date by at most " +
+          std::to_string(kMaxPvDays_) + " days");
+    }
+    const double panel_eff = GetRequiredNumber(req, "panel_efficiency");
+    const double panel_area = GetRequiredNumber(req, "panel_area");
+    [[unlikely]] if (panel_eff < 0 || panel_eff > 1) {
+      throw std::invalid_argument(
+          "Solar panel efficiency must be a value between 0 and 1 (inclusive)");
+    }
+    [[unlikely]] if (panel_area <= 0) {
+      throw std::invalid_argument(
+          "Solar panel area must be a value greater than 0");
+    }
+
+    // Decoding scratch is released in one step once the response is built.
+    util::RequestArena arena{};
+    const PvCollectionPtr collection =
+        PvDataProcessor::CollectData(coords, time_frame);
+    // Answer in date order; the collection itself is unordered.
+    std::map<std::string, double> yields{};
+    for (auto const& [date, pv_data] : *collection) {
+      yields.emplace(date, PvMetrics::CalculateDailyEnergyYeild(
+                               *pv_data, coords, date, panel_eff, panel_area));
+    }
+
+    Json days = Json::array();
+    for (auto const& [date, yield] : yields) {
+      days.push_back(Json{{"date", date}, {"yield_kwh", yield}});
+    }
+    return Json{{"latitude", coords.GetLatitude()},
+                {"longitude", coords.GetLongitude()},
+                {"days", std::move(days)}};
+  });
+  ++(ok ? served_ : failed_);
+}
+
+void weatherer::server::QueryServer::HandleClimatology(
+    const httplib::Request& req, httplib::Response& res) {
+  util::TraceSpan span{"QueryServer::HandleClimatology"};
+  const bool ok = Respond(res, [&] {
+    const Coordinates coords{GetRequiredNumber(req, "latitude"),
+                             GetRequiredNumber(req, "longitude")};
+    PvClimatology::Options options{};
+    options.first_year = static_cast<int>(
+        GetRequiredInteger(req, "first_year", kMinClimatologyYear_, kMaxClimatologyYear_));
+    options.last_year = static_cast<int>(
+        GetRequiredInteger(req, "last_year", kMinClimatologyYear_, kMaxClimatologyYear_));
+    [[unlikely]] if (options.last_year - options.first_year >=
+                     kMaxClimatologyYears_) {
+      throw std::invalid_argument("The range may span at most " +
+                                  std::to_string(kMaxClimatologyYears_) +
+                                  " years");
+    }
+    options.panel_eff = GetRequiredNumber(req, "panel_efficiency");
+    options.panel_area = GetRequiredNumber(req, "panel_area");
+    const ClimatologyReport report = PvClimatology::Compute(coords, options);
+
+    Json daily = Json::array();
+    for (std::size_t day = 0; day < report.daily.size(); ++day) {
+      if (report.daily_samples[day] > 0) {
+        Json levels = ToJson(report.daily[day]);
+        levels["date"] = PvClimatology::FormatCalendarDay(day);
+        levels["years"] = report.daily_samples[day];
+        daily.push_back(std::move(levels));
+      }
+    }
+    return Json{{"latitude", coords.GetLatitude()},
+                {"longitude", coords.GetLongitude()},
+                {"years", report.years},
+                {"annual", ToJson(report.annual)},
+                {"annual_mean", report.annual_moments.GetMean()},
+                {"annual_stddev", report.annual_moments.GetStandardDeviation()},
+                {"daily", std::move(daily)}};
+  });
+  ++(ok ? served_ : failed_);
+}
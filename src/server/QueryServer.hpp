@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "api/CropDatabase.hpp"
+#include "api/PlantMap.hpp"
+#include "util/ExpiringCache.hpp"
+#include "util/Geolocation.hpp"
+
+namespace httplib {
+class Server;
+struct Request;
+struct Response;
+}  // namespace httplib
+
+namespace weatherer::server {
+/**
+ * @brief Long-running HTTP front end answering crop and PV yield queries.
+ *
+ * The crop databases are loaded once at start-up and shared by every request,
+ * and geocoding results and weather responses are cached, so warm queries cost
+ * at most one weather fetch. Requests are served concurrently by a thread pool.
+ *
+ * Endpoints (all GET, answering JSON unless noted):
+ *   /crops?address=<one-line address>
+ *   /crops?latitude=<lat>&longitude=<lon>&zipcode=<zip>
+ *      Either form accepts &window_days=<integer in [1, 16]> to add each crop's planting
+ *      window over the forecast horizon.
+ *   /crops/plantable?zipcode=<zip>
+ *      Answered from the precomputed plant map; only served when one is set.
+ *   /pv?latitude=<lat>&longitude=<lon>&start_date=<YYYY-MM-DD>
+ *      &end_date=<YYYY-MM-DD>&panel_efficiency=<[0, 1]>&panel_area=<m^2>
+ *      The range may span at most kMaxPvDays_ days.
+ *   /pv/climatology?latitude=<lat>&longitude=<lon>&first_year=<year>
+ *      &last_year=<year>&panel_efficiency=<[0, 1]>&panel_area=<m^2>
+ *      Years are whole numbers from kMinClimatologyYear_ on, and the range
+ *      may span at most kMaxClimatologyYears_ years.
+ *   /metrics   Prometheus text format
+ *   /healthz   Plain text "ok"
+ */
+class QueryServer {
+ public:
+  struct Options {
+    std::string host{"127.0.0.1"};
+    int port = 8081;
+    // When set, listen on this Unix domain socket instead of host:port.
+    std::string unix_socket{};
+    // Number of worker threads serving requests.
+    std::size_t threads = 8;
+    // Plant map written by weatherer_plant_map; enables /crops/plantable.
+    std::string plant_map{};
+    // Longest wait for the upstream rate limit before a request fails; set
+    // as the process-wide util::SchedulerPolicy when the server is created.
+    std::chrono::seconds max_queue_wait{30};
+  };
+
+ private:
+  Options options_;
+  std::shared_ptr<const CropDatabase> database_;
+  std::unique_ptr<httplib::Server> server_;
+  std::unique_ptr<const PlantMap> plant_map_;
+
+  // Addresses do not move, so geocoding results are kept for a day.
+  static constexpr std::chrono::hours kLocationCacheTtl_{24};
+  static constexpr std::size_t kLocationCacheCapacity_ = 16384;
+  util::ExpiringCache<std::string, util::LocationData> locations_;
+
+  // Longest /pv range, in days. Every range is cached as one response, so
+  // unbounded ranges would make the weather cache unbounded too.
+  static constexpr std::time_t kMaxPvDays_ = 366;
+
+  // Most /pv/climatology years. Every year is a separate archive fetch, so the
+  // range bounds the work a single request can queue.
+  static constexpr int kMaxClimatologyYears_ = 50;
+  // The years /pv/climatology accepts at all; the archive starts in 1940.
+  static constexpr int kMinClimatologyYear_ = 1940;
+  static constexpr int kMaxClimatologyYear_ = 9999;
+
+  std::atomic<std::size_t> served_{0};
+  std::atomic<std::size_t> failed_{0};
+
+  void HandleCrops(const httplib::Request& req, httplib::Response& res);
+  void HandlePlantable(const httplib::Request& req, httplib::Response& res);
+  void HandlePv(const httplib::Request& req, httplib::Response& res);
+  void HandleClimatology(const httplib::Request& req, httplib::Response& res);
+
+  /**
+   * @brief Resolves the location of a crop query, geocoding it if needed.
+   * @param req The incoming request.
+   * @return The coordinates and zipcode of the query.
+   * @throws std::invalid_argument if the query names no location.
+   */
+  [[nodiscard]] util::LocationData ResolveLocation(const httplib::Request& req);
+
+ public:
+  /**
+   * @param options The address to serve on and the size of the thread pool.
+   * @param database The crop databases; loaded before the first request is served.
+   */
+  explicit QueryServer(
+      Options options,
+      std::shared_ptr<const CropDatabase> database = CropDatabase::GetDefault());
+  ~QueryServer();
+  QueryServer(const QueryServer& other) = delete;
+  QueryServer& operator=(const QueryServer& other) = delete;
+
+  /**
+   * @brief Serves requests on the calling thread until stopped.
+   * @throws std::runtime_error if the server cannot bind to the configured address.
+   */
+  void Listen();
+
+  /**
+   * @brief Stops serving. Safe to call from another thread while Listen() runs,
+   * but not from a signal handler; see util::InterruptWatcher.
+   */
+  void Stop();
+
+  [[nodiscard]] std::size_t GetServedCount() const { return served_; }
+  [[nodiscard]] std::size_t GetFailedCount() const { return failed_; }
+};
+}  // namespace weatherer::server
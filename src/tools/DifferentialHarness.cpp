@@ -0,0 +1,101 @@
+#include "DifferentialHarness.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <optional>
+
+std::uint64_t weatherer::tools::DifferentialHarness::GetUlpDistance(
+    const double a, const double b) {
+  if (a == b) {
+    return 0;
+  }
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::isnan(a) && std::isnan(b)
+               ? 0
+               : std::numeric_limits<std::uint64_t>::max();
+  }
+  // Maps doubles onto unsigned integers in the same order, so that adjacent
+  // doubles map to adjacent integers.
+  constexpr std::uint64_t kSignBit = std::uint64_t{1} << 63;
+  const auto ordered = [](const double value) {
+    const auto bits = std::bit_cast<std::uint64_t>(value);
+    return (bits & kSignBit) != 0 ? ~bits : bits | kSignBit;
+  };
+  const std::uint64_t x = ordered(a);
+  const std::uint64_t y = ordered(b);
+  return x > y ? x - y : y - x;
+}
+
+void weatherer::tools::DifferentialHarness::CompareOutputs(
+    Report& report, std::string const& label,
+    std::vector<double> const& reference,
+    std::vector<double> const& candidate) const {
+  const std::size_t count = std::max(reference.size(), candidate.size());
+  report.values += count;
+  std::optional<Mismatch> first_mismatch{};
+  for (std::size_t i = 0; i < count; ++i) {
+    // A value missing from either output fails like a NaN would.
+    const double expected = i < reference.size()
+                                ? reference[i]
+                                : std::numeric_limits<double>::quiet_NaN();
+    const double actual = i < candidate.size()
+                              ? candidate[i]
+                              : std::numeric_limits<double>::quiet_NaN();
+    const std::uint64_t ulps = GetUlpDistance(expected, actual);
+    const double absolute =
+        ulps == 0 ? 0
+                  : (std::isnan(expected) || std::isnan(actual)
+                         ? std::numeric_limits<double>::infinity()
+                         : std::abs(expected - actual));
+    report.max_absolute_error = std::max(report.max_absolute_error, absolute);
+    report.max_ulp_error = std::max(report.max_ulp_error, ulps);
+    if (!first_mismatch && absolute > report.tolerance.absolute &&
+        ulps > report.tolerance.ulps) {
+      first_mismatch = Mismatch{label, i, expected, actual};
+    }
+  }
+  if (first_mismatch) {
+    ++report.mismatching_inputs;
+    if (report.mismatches.size() < options_.max_reported_mismatches) {
+      report.mismatches.push_back(std::move(*first_mismatch));
+    }
+  }
+}
+
+bool weatherer::tools::DifferentialHarness::IsPassing() const {
+  return std::ranges::all_of(
+      reports_, [](Report const& report) { return report.IsPassing(); });
+}
+
+void weatherer::tools::DifferentialHarness::Print(std::ostream& os) const {
+  const auto to_milliseconds = [](const std::chrono::nanoseconds duration) {
+    return static_cast<double>(duration.count()) / 1e6;
+  };
+  char line[256];
+  for (Report const& report : reports_) {
+    std::snprintf(
+        line, sizeof(line),
+        "%-32s %s  inputs %zu  values %zu  mismatching %zu  max abs %.3g  "
+        "max ulp %llu\n",
+        report.name.c_str(), report.IsPassing() ? "PASS" : "FAIL",
+        report.inputs, report.values, report.mismatching_inputs,
+        report.max_absolute_error,
+        static_cast<unsigned long long>(report.max_ulp_error));
+    os << line;
+    std::snprintf(line, sizeof(line),
+                  "%-32s reference %.3f ms  candidate %.3f ms  speedup %.2fx  "
+                  "(tolerance abs %.3g or %llu ulp)\n",
+                  "", to_milliseconds(report.reference_time),
+                  to_milliseconds(report.candidate_time), report.GetSpeedup(),
+                  report.tolerance.absolute,
+                  static_cast<unsigned long long>(report.tolerance.ulps));
+    os << line;
+    for (Mismatch const& mismatch : report.mismatches) {
+      std::snprintf(line, sizeof(line),
+                    "%-32s [%zu] reference %.17g candidate %.17g  ", "",
+                    mismatch.index, mismatch.reference, mismatch.candidate);
+      os << line << mismatch.label << "\n";
+    }
+  }
+}
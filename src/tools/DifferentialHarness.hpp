@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace weatherer::tools {
+/**
+ * @brief How far a candidate value may stray from the reference value.
+ *
+ * A value passes if it is within either bound, so the absolute bound covers
+ * values near zero and the ULP bound covers large ones.
+ */
+struct Tolerance {
+  double absolute = 1e-9;
+  std::uint64_t ulps = 4;
+};
+
+/**
+ * @brief Runs a reference implementation and a candidate side by side.
+ *
+ * Both implementations map every input to a vector of doubles; booleans and
+ * collections are flattened into one by the caller. The harness times both
+ * over all inputs, keeping the fastest of a few repetitions. It then compares
+ * the outputs value by value and records the largest absolute and ULP errors
+ * and the inputs that exceed the tolerance. A comparison fails if any value
+ * does, or if the outputs for an input differ in length.
+ */
+class DifferentialHarness {
+ public:
+  /**
+   * @brief One input, labelled so that mismatches can be traced back to it.
+   */
+  template <typename Input_>
+  struct Case {
+    std::string label;
+    Input_ input;
+  };
+
+  struct Mismatch {
+    std::string label;
+    // The position of the first failing value within the output.
+    std::size_t index;
+    double reference;
+    double candidate;
+  };
+
+  struct Report {
+    std::string name;
+    Tolerance tolerance{};
+    std::size_t inputs = 0;
+    std::size_t values = 0;
+    std::size_t mismatching_inputs = 0;
+    double max_absolute_error = 0;
+    std::uint64_t max_ulp_error = 0;
+    // The first mismatching inputs, up to the configured number.
+    std::vector<Mismatch> mismatches{};
+    std::chrono::nanoseconds reference_time{};
+    std::chrono::nanoseconds candidate_time{};
+
+    [[nodiscard]] bool IsPassing() const { return mismatching_inputs == 0; }
+
+    /**
+     * @return How many times faster the candidate ran than the reference.
+     */
+    [[nodiscard]] double GetSpeedup() const {
+      return candidate_time.count() > 0
+                 ? static_cast<double>(reference_time.count()) /
+                       static_cast<double>(candidate_time.count())
+                 : 0;
+    }
+  };
+
+  struct Options {
+    // Both implementations run this many times; the fastest run is reported.
+    std::size_t repetitions = 3;
+    std::size_t max_reported_mismatches = 5;
+  };
+
+ private:
+  Options options_;
+  std::vector<Report> reports_{};
+
+  template <typename Input_, typename Fn_>
+  [[nodiscard]] std::chrono::nanoseconds Time(
+      std::span<const Case<Input_>> cases, Fn_& fn,
+      std::vector<std::vector<double>>& outputs) const {
+    auto fastest = std::chrono::nanoseconds::max();
+    for (std::size_t run = 0; run < std::max<std::size_t>(options_.repetitions, 1);
+         ++run) {
+      std::vector<std::vector<double>> results{};
+      results.reserve(cases.size());
+      const auto start = std::chrono::steady_clock::now();
+      for (const auto& test_case : cases) {
+        results.push_back(fn(test_case.input));
+      }
+      fastest = std::min(fastest, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start));
+      outputs = std::move(results);
+    }
+    return fastest;
+  }
+
+  /**
+   * @brief Compares the outputs for one input and updates the report.
+   */
+  void CompareOutputs(Report& report, std::string const& label,
+                      std::vector<double> const& reference,
+                      std::vector<double> const& candidate) const;
+
+ public:
+  DifferentialHarness() : options_{} {}
+  explicit DifferentialHarness(Options options) : options_(options) {}
+
+  /**
+   * @brief Compares a candidate implementation against the reference.
+   * @param name The name of the comparison, as printed.
+   * @param cases The inputs.
+   * @param tolerance The allowed error of every value.
+   * @param reference The current implementation, mapping an input to values.
+   * @param candidate The implementation under test.
+   * @return The report, which is also kept for Print.
+   */
+  template <typename Input_, typename Reference_, typename Candidate_>
+  Report const& Compare(std::string name, std::span<const Case<Input_>> cases,
+                        Tolerance const& tolerance, Reference_&& reference,
+                        Candidate_&& candidate) {
+    Report report{};
+    report.name = std::move(name);
+    report.tolerance = tolerance;
+    report.inputs = cases.size();
+
+    std::vector<std::vector<double>> reference_outputs{};
+    std::vector<std::vector<double>> candidate_outputs{};
+    report.reference_time = Time(cases, reference, reference_outputs);
+    report.candidate_time = Time(cases, candidate, candidate_outputs);
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+      CompareOutputs(report, cases[i].label, reference_outputs[i],
+                     candidate_outputs[i]);
+    }
+    return reports_.emplace_back(std::move(report));
+  }
+
+  /**
+   * @return Whether every comparison so far has passed.
+   */
+  [[nodiscard]] bool IsPassing() const;
+
+  [[nodiscard]] std::vector<Report> const& GetReports() const {
+    return reports_;
+  }
+
+  /**
+   * @brief Prints every report, with its errors, timings and mismatches.
+   */
+  void Print(std::ostream& os) const;
+
+  /**
+   * @return The number of representable doubles between a and b; 0 if they
+   * are equal or both NaN, and the maximum if only one is NaN.
+   */
+  [[nodiscard]] static std::uint64_t GetUlpDistance(double a, double b);
+};
+}  // namespace weatherer::tools
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "api/CropDataProcessor.hpp"
+#include "api/CropDatabase.hpp"
+#include "api/EnsembleProcessor.hpp"
+#include "api/FlatWeatherReader.hpp"
+#include "api/PvDataProcessor.hpp"
+#include "api/PvMetrics.hpp"
+#include "api/models/PvDayRecord.hpp"
+#include "tools/DifferentialHarness.hpp"
+#include "tools/ReferenceKernels.hpp"
+#include "tools/SyntheticResponses.hpp"
+#include "util/RequestArena.hpp"
+
+namespace {
+using Json = nlohmann::json;
+using weatherer::tools::DifferentialHarness;
+using weatherer::tools::Tolerance;
+
+template <typename Input_>
+using Cases = std::vector<DifferentialHarness::Case<Input_>>;
+
+constexpr double kPanelEff = 0.2;
+constexpr double kPanelArea = 10.0;
+
+/**
+ * @brief One location of a PV weather response, in one or both formats.
+ */
+struct WeatherInput {
+  std::string json_body;
+  // Empty if the response was only recorded as JSON.
+  std::string flat_body;
+  // The position of the location in a multi-location response.
+  std::size_t location;
+  weatherer::util::TimeFrame time_frame;
+};
+
+/**
+ * @brief One organized day of PV weather.
+ */
+struct DayInput {
+  weatherer::PvDataPtr pv_data;
+  weatherer::PvDayRecord record;
+  weatherer::Coordinates coords;
+  std::string date;
+};
+
+/**
+ * @brief One location of an ensemble forecast.
+ */
+struct EnsembleInput {
+  weatherer::EnsembleForecastPtr forecast;
+  weatherer::Coordinates coords;
+};
+
+/**
+ * @brief One location of a crop weather response, and the same response with
+ * every number narrowed to float.
+ */
+struct CropInput {
+  Json json;
+  Json narrowed;
+};
+
+/**
+ * @brief A response recorded by ReplayServer.
+ */
+struct Fixture {
+  std::string label;
+  std::string key;
+  std::string body;
+};
+
+void PrintUsage() {
+  std::cout
+      << "Usage: weatherer_diff [options]\n"
+         "  --cases <count>         Randomized locations per comparison (default: 100)\n"
+         "  --seed <value>          Seed of the randomized inputs (default: 1)\n"
+         "  --fixtures <dir>        Also compare on responses recorded by weatherer_replay\n"
+         "                          (default: the fixtures directory of the source tree)\n"
+         "  --repetitions <count>   Timed runs of each implementation (default: 3)\n"
+         "  --abs-tolerance <value> Allowed absolute error, for every comparison\n"
+         "  --ulp-tolerance <count> Allowed error in ULPs, for every comparison\n";
+}
+
+std::string ReadFile(std::filesystem::path const& path) {
+  std::ifstream file{path, std::ios::binary};
+  return std::string{std::istreambuf_iterator<char>{file},
+                     std::istreambuf_iterator<char>{}};
+}
+
+std::vector<Fixture> LoadFixtures(std::filesystem::path const& directory) {
+  std::vector<Fixture> fixtures{};
+  for (auto const& entry : std::filesystem::directory_iterator{directory}) {
+    if (entry.path().extension() != ".request") {
+      continue;
+    }
+    std::string key = ReadFile(entry.path());
+    while (!key.empty() && (key.back() == '\n' || key.back() == '\r')) {
+      key.pop_back();
+    }
+    const auto response =
+        std::filesystem::path{entry.path()}.replace_extension(".response");
+    if (std::filesystem::exists(response)) {
+      fixtures.push_back(
+          Fixture{entry.path().stem().string(), std::move(key),
+                  ReadFile(response)});
+    }
+  }
+  // Directory order is unspecified; keep reports reproducible.
+  std::ranges::sort(fixtures, {}, &Fixture::label);
+  return fixtures;
+}
+
+// Covers the days of a response; the last one is excluded, as in CollectData.
+weatherer::util::TimeFrame GetTimeFrame(Json const& location) {
+  const auto& days = location.at("daily").at("time");
+  return weatherer::util::TimeFrame{
+      weatherer::util::Date{days.front().get<std::time_t>()},
+      weatherer::util::Date{days.back().get<std::time_t>()}};
+}
+
+Json const& GetLocation(Json const& json, const std::size_t location) {
+  return json.is_array() ? json.at(location) : json;
+}
+
+// Every value of a collection, by date, in a fixed order.
+std::vector<double> Flatten(weatherer::PvCollectionPtr const& collection) {
+  std::vector<std::string> dates{};
+  for (const auto& date : *collection | std::views::keys) {
+    dates.push_back(date);
+  }
+  std::ranges::sort(dates);
+  std::vector<double> values{};
+  values.reserve(dates.size() * (2 + 4 * 24));
+  for (const auto& date : dates) {
+    const auto& pv_data = *collection->at(date);
+    values.push_back(static_cast<double>(pv_data.GetSunriseTime()));
+    values.push_back(static_cast<double>(pv_data.GetSunsetTime()));
+    for (const auto& series :
+         {pv_data.GetShortwaveRadiation(), pv_data.GetTemperature(),
+          pv_data.GetCloudCoverTotal(), pv_data.GetWindSpeed()}) {
+      values.insert(values.end(), series.begin(), series.end());
+    }
+  }
+  return values;
+}
+
+// Rounds every floating-point number to the nearest float, as a response
+// decoded from FlatBuffers would hold it.
+Json Narrow(Json json) {
+  if (json.is_structured()) {
+    for (auto& value : json) {
+      value = Narrow(std::move(value));
+    }
+  } else if (json.is_number_float()) {
+    json = static_cast<double>(static_cast<float>(json.get<double>()));
+  }
+  return json;
+}
+
+weatherer::tools::QueryParams MakePvParams(const double latitude,
+                                           const double longitude,
+                                           std::string const& start_date,
+                                           std::string const& end_date) {
+  return {{"latitude", std::to_string(latitude)},
+          {"longitude", std::to_string(longitude)},
+          {"daily", "sunrise"},
+          {"daily", "sunset"},
+          {"hourly", "temperature_2m"},
+          {"hourly", "cloud_cover"},
+          {"hourly", "wind_speed_10m"},
+          {"hourly", "shortwave_radiation"},
+          {"start_date", start_date},
+          {"end_date", end_date}};
+}
+
+weatherer::tools::QueryParams MakeCropParams(const double latitude,
+                                             const double longitude,
+                                             std::string const& date) {
+  return {{"latitude", std::to_string(latitude)},
+          {"longitude", std::to_string(longitude)},
+          {"hourly", "soil_temperature_18cm"},
+          {"daily", "temperature_2m_min"},
+          {"start_date", date},
+          {"end_date", date}};
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  using namespace weatherer;
+  using tools::SyntheticResponses;
+
+  std::size_t case_count = 100;
+  std::uint64_t seed = 1;
+#ifdef WEATHERER_FIXTURES_PATH
+  std::optional<std::filesystem::path> fixtures_dir{WEATHERER_FIXTURES_PATH};
+#else
+  std::optional<std::filesystem::path> fixtures_dir{};
+#endif
+  DifferentialHarness::Options options{};
+  std::optional<double> abs_tolerance{};
+  std::optional<std::uint64_t> ulp_tolerance{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      return 0;
+    }
+    [[unlikely]] if (i + 1 >= argc) {
+      PrintUsage();
+      return 1;
+    }
+    const std::string value{argv[++i]};
+    if (arg == "--cases") {
+      case_count = std::stoul(value);
+    } else if (arg == "--seed") {
+      seed = std::stoull(value);
+    } else if (arg == "--fixtures") {
+      fixtures_dir = value;
+    } else if (arg == "--repetitions") {
+      options.repetitions = std::stoul(value);
+    } else if (arg == "--abs-tolerance") {
+      abs_tolerance = std::stod(value);
+    } else if (arg == "--ulp-tolerance") {
+      ulp_tolerance = std::stoull(value);
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  // Tolerances given on the command line replace those of every comparison.
+  const auto tolerance = [&](Tolerance configured) {
+    configured.absolute = abs_tolerance.value_or(configured.absolute);
+    configured.ulps = ulp_tolerance.value_or(configured.ulps);
+    return configured;
+  };
+
+  Cases<WeatherInput> weather_cases{};
+  Cases<CropInput> crop_cases{};
+  Cases<EnsembleInput> ensemble_cases{};
+
+  // Randomized locations and date ranges, synthesized in both formats.
+  std::mt19937_64 random{seed};
+  std::uniform_real_distribution<double> latitudes{-55.0, 65.0};
+  std::uniform_real_distribution<double> longitudes{-180.0, 180.0};
+  std::uniform_int_distribution<std::int64_t> first_days{0, 5 * 365};
+  std::uniform_int_distribution<std::int64_t> day_counts{2, 31};
+  const util::Date epoch{"2019-01-01"};
+  for (std::size_t i = 0; i < case_count; ++i) {
+    const double latitude = latitudes(random);
+    const double longitude = longitudes(random);
+    const util::Date start =
+        epoch + first_days(random) * util::Date::kSecondsPerDay;
+    const util::Date end =
+        start + (day_counts(random) - 1) * util::Date::kSecondsPerDay;
+    auto params = MakePvParams(latitude, longitude, start.StripTime(),
+                               end.StripTime());
+    std::string json_body = SyntheticResponses::MakeWeatherResponse(params);
+    params.emplace("format", "flatbuffers");
+    std::string flat_body = SyntheticResponses::MakeWeatherResponse(params);
+
+    char label[96];
+    std::snprintf(label, sizeof(label), "synthetic %.4f,%.4f %s/%s", latitude,
+                  longitude, start.StripTime().c_str(),
+                  end.StripTime().c_str());
+    const util::TimeFrame time_frame{start, end};
+    // The ensemble of the same location and days, its sun times taken from
+    // the deterministic response.
+    const PvCollectionPtr sun_times = PvDataProcessor::OrganizeWeatherData(
+        Json::parse(json_body), time_frame);
+    ensemble_cases.push_back(
+        {label,
+         EnsembleInput{EnsembleProcessor::OrganizeEnsembleData(
+                           Json::parse(SyntheticResponses::MakeEnsembleResponse(
+                               params)),
+                           *sun_times, time_frame),
+                       Coordinates{latitude, longitude}}});
+    weather_cases.push_back({label, WeatherInput{std::move(json_body),
+                                                 std::move(flat_body), 0,
+                                                 time_frame}});
+
+    Json crop_json = Json::parse(SyntheticResponses::MakeWeatherResponse(
+        MakeCropParams(latitude, longitude, start.StripTime())));
+    Json narrowed = Narrow(crop_json);
+    crop_cases.push_back(
+        {label, CropInput{std::move(crop_json), std::move(narrowed)}});
+  }
+
+  // Recorded responses, paired with their FlatBuffers recording if there is one.
+  if (fixtures_dir) {
+    const std::vector<Fixture> fixtures = LoadFixtures(*fixtures_dir);
+    constexpr std::string_view kFlatParam = "&format=flatbuffers";
+    for (Fixture const& fixture : fixtures) {
+      if (fixture.key.find(kFlatParam) != std::string::npos) {
+        continue;
+      }
+      const bool pv = fixture.key.find("shortwave_radiation") != std::string::npos;
+      const bool crop =
+          fixture.key.find("soil_temperature_18cm") != std::string::npos;
+      if (!pv && !crop) {
+        continue;
+      }
+      const Json json = Json::parse(fixture.body);
+      const std::size_t locations = json.is_array() ? json.size() : 1;
+      std::string flat_body{};
+      if (pv) {
+        std::string flat_key = fixture.key;
+        // Parameters are sorted by name, so format follows end_date or
+        // daily and precedes hourly.
+        if (const auto hourly = flat_key.find("&hourly="); hourly != std::string::npos) {
+          flat_key.insert(hourly, kFlatParam);
+        }
+        const auto flat = std::ranges::find(fixtures, flat_key, &Fixture::key);
+        if (flat != fixtures.end()) {
+          flat_body = flat->body;
+        }
+      }
+      for (std::size_t location = 0; location < locations; ++location) {
+        const std::string label = "fixture " + fixture.label + " #" +
+                                  std::to_string(location);
+        Json const& entry = GetLocation(json, location);
+        if (pv) {
+          weather_cases.push_back(
+              {label, WeatherInput{fixture.body, flat_body, location,
+                                   GetTimeFrame(entry)}});
+        } else {
+          crop_cases.push_back({label, CropInput{entry, Narrow(entry)}});
+        }
+      }
+    }
+  }
+
+  DifferentialHarness harness{options};
+
+  // Ingest: the JSON path against the FlatBuffers path, where both exist.
+  // FlatBuffers carries floats, so values agree to float precision.
+  Cases<WeatherInput> paired_cases{};
+  std::ranges::copy_if(weather_cases, std::back_inserter(paired_cases),
+                       [](auto const& test_case) {
+                         return !test_case.input.flat_body.empty();
+                       });
+  harness.Compare<WeatherInput>(
+      "ingest/flatbuffers", paired_cases, tolerance({1e-4, 4}),
+      [](WeatherInput const& input) {
+        const util::RequestArena arena{};
+        const Json json = Json::parse(input.json_body);
+        return Flatten(PvDataProcessor::OrganizeWeatherData(
+            GetLocation(json, input.location), input.time_frame));
+      },
+      [](WeatherInput const& input) {
+        const util::RequestArena arena{};
+        const auto locations = FlatWeatherReader::Parse(
+            std::as_bytes(std::span{input.flat_body}));
+        return Flatten(PvDataProcessor::OrganizeWeatherData(
+            locations.at(input.location), input.time_frame));
+      });
+
+  // Daily yield: every organized day, the original kernel against the current
+  // models.
+  Cases<DayInput> day_cases{};
+  for (auto const& [label, input] : weather_cases) {
+    const Json json = Json::parse(input.json_body);
+    Json const& location = GetLocation(json, input.location);
+    const Coordinates coords{location.at("latitude").get<double>(),
+                             location.at("longitude").get<double>()};
+    const PvCollectionPtr collection =
+        PvDataProcessor::OrganizeWeatherData(location, input.time_frame);
+    for (auto const& [date, pv_data] : *collection) {
+      day_cases.push_back({label + " " + date,
+                           DayInput{pv_data, PvDayRecord::FromPvData(*pv_data),
+                                    coords, date}});
+    }
+  }
+  harness.Compare<DayInput>(
+      "daily_yield/pv_data", day_cases, tolerance({1e-9, 4}),
+      [](DayInput const& input) {
+        return std::vector{tools::reference::CalculateDailyEnergyYeild(
+            *input.pv_data, input.coords, input.date, kPanelEff, kPanelArea)};
+      },
+      [](DayInput const& input) {
+        return std::vector{PvMetrics::CalculateDailyEnergyYeild(
+            *input.pv_data, input.coords, input.date, kPanelEff, kPanelArea)};
+      });
+  harness.Compare<DayInput>(
+      "daily_yield/pv_day_record", day_cases, tolerance({1e-9, 4}),
+      [](DayInput const& input) {
+        return std::vector{tools::reference::CalculateDailyEnergyYeild(
+            *input.pv_data, input.coords, input.date, kPanelEff, kPanelArea)};
+      },
+      [](DayInput const& input) {
+        return std::vector{PvMetrics::CalculateDailyEnergyYeild(
+            input.record, input.coords, kPanelEff, kPanelArea)};
+      });
+
+  // Ensemble yield: every member as its own PvData day through the original
+  // kernel, against the yields computed across members at once.
+  harness.Compare<EnsembleInput>(
+      "ensemble_yield/pv_data", ensemble_cases, tolerance({1e-9, 4}),
+      [](EnsembleInput const& input) {
+        EnsembleForecast const& forecast = *input.forecast;
+        std::vector<double> yields(forecast.GetDayCount() *
+                                   forecast.GetMemberCount());
+        for (std::size_t member = 0; member < forecast.GetMemberCount();
+             ++member) {
+          for (std::size_t day = 0; day < forecast.GetDayCount(); ++day) {
+            const auto hours = [&](std::span<const double> series) {
+              std::array<double, 24> values{};
+              std::ranges::copy(series.subspan(day * 24, 24), values.begin());
+              return values;
+            };
+            const auto& [date, sunrise, sunset] = forecast.GetDays()[day];
+            const PvData pv_data{date,
+                                 sunrise,
+                                 sunset,
+                                 hours(forecast.GetShortwaveRadiation(member)),
+                                 hours(forecast.GetTemperature(member)),
+                                 hours(forecast.GetCloudCoverTotal(member)),
+                                 {}};
+            yields[day * forecast.GetMemberCount() + member] =
+                tools::reference::CalculateDailyEnergyYeild(
+                    pv_data, input.coords, date, kPanelEff, kPanelArea);
+          }
+        }
+        return yields;
+      },
+      [](EnsembleInput const& input) {
+        return PvMetrics::CalculateEnsembleDailyEnergyYeild(
+            *input.forecast, input.coords, kPanelEff, kPanelArea);
+      });
+
+  // Weather suitability: the original decisions, against the current ones on
+  // the same weather and on the weather held as floats, as the FlatBuffers
+  // path holds it.
+  const auto database = CropDatabase::GetDefault();
+  std::vector<std::string> crop_names = database->GetPlantsByZone(7);
+  const CropCollectionPtr crops = database->CollectData(crop_names);
+  const auto to_values = [](std::unordered_map<std::string, bool> const& plantability) {
+    std::vector<std::pair<std::string, bool>> sorted{plantability.begin(),
+                                                     plantability.end()};
+    std::ranges::sort(sorted);
+    std::vector<double> values{};
+    for (const bool plantable : sorted | std::views::values) {
+      values.push_back(plantable ? 1 : 0);
+    }
+    return values;
+  };
+  harness.Compare<CropInput>(
+      "weather_suitable/double", crop_cases, tolerance({0, 0}),
+      [&](CropInput const& input) {
+        return to_values(tools::reference::IsWeatherSuitable(input.json, *crops));
+      },
+      [&](CropInput const& input) {
+        return to_values(CropDataProcessor::IsWeatherSuitable(input.json, *crops));
+      });
+  harness.Compare<CropInput>(
+      "weather_suitable/float", crop_cases, tolerance({0, 0}),
+      [&](CropInput const& input) {
+        return to_values(tools::reference::IsWeatherSuitable(input.json, *crops));
+      },
+      [&](CropInput const& input) {
+        return to_values(
+            CropDataProcessor::IsWeatherSuitable(input.narrowed, *crops));
+      });
+
+  harness.Print(std::cout);
+  return harness.IsPassing() ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+#include "PlantMapBuilder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+#include "api/PlantMap.hpp"
+#include "util/ChunkOperator.hpp"
+#include "util/SpatialGrid.hpp"
+#include "util/Trace.hpp"
+
+namespace {
+struct Member {
+  std::string zipcode;
+  int zone;
+};
+
+std::string Trim(std::string value) {
+  const auto first = value.find_first_not_of(" \t\r");
+  const auto last = value.find_last_not_of(" \t\r");
+  return first == std::string::npos ? std::string{}
+                                    : value.substr(first, last - first + 1);
+}
+}  // namespace
+
+std::unordered_map<std::string, weatherer::Coordinates>
+weatherer::tools::PlantMapBuilder::ReadGazetteer(
+    std::filesystem::path const& path) {
+  std::ifstream file{path};
+  [[unlikely]] if (!file) {
+    throw std::runtime_error("Failed to open gazetteer: " + path.string());
+  }
+
+  std::string line{};
+  std::getline(file, line);
+  const std::vector<std::string> columns =
+      util::SplitString(line, std::string_view{"\t"});
+  const auto find_column = [&](std::string const& name) {
+    const auto it = std::ranges::find_if(columns, [&](std::string const& column) {
+      return Trim(column) == name;
+    });
+    [[unlikely]] if (it == columns.end()) {
+      throw std::runtime_error("Gazetteer has no " + name + " column");
+    }
+    return static_cast<std::size_t>(it - columns.begin());
+  };
+  const std::size_t geoid = find_column("GEOID");
+  const std::size_t latitude = find_column("INTPTLAT");
+  const std::size_t longitude = find_column("INTPTLONG");
+  const std::size_t required = std::max({geoid, latitude, longitude}) + 1;
+
+  std::unordered_map<std::string, Coordinates> coordinates{};
+  while (std::getline(file, line)) {
+    const std::vector<std::string> fields =
+        util::SplitString(line, std::string_view{"\t"});
+    if (fields.size() < required) {
+      continue;
+    }
+    coordinates.emplace(Trim(fields[geoid]),
+                        Coordinates{std::stod(fields[latitude]),
+                                    std::stod(fields[longitude])});
+  }
+  return coordinates;
+}
+
+weatherer::tools::PlantMapBuilder::Summary
+weatherer::tools::PlantMapBuilder::Build(
+    Options const& options, std::shared_ptr<const CropDatabase> database) {
+  util::TraceSpan span{"PlantMapBuilder::Build"};
+  [[unlikely]] if (!database) {
+    throw std::invalid_argument("Crop database must not be null");
+  }
+  const auto coordinates = ReadGazetteer(options.gazetteer);
+  const std::vector<std::string> crop_names = database->GetCropNames();
+  std::unordered_map<std::string, std::size_t> crop_indices{};
+  for (std::size_t i = 0; i < crop_names.size(); ++i) {
+    crop_indices.emplace(crop_names[i], i);
+  }
+
+  // Group the zipcodes by weather cell, and load each zone's crops once.
+  Summary summary{};
+  const util::SpatialGrid grid{};
+  std::unordered_map<util::GridCell, std::vector<Member>, util::GridCellHash>
+      cell_members{};
+  std::unordered_map<int, CropCollectionPtr> zone_crops{};
+  for (std::string const& zipcode : database->GetZipcodes()) {
+    ++summary.zipcodes;
+    const auto location = coordinates.find(zipcode);
+    if (location == coordinates.end()) {
+      ++summary.skipped;
+      continue;
+    }
+    try {
+      const int zone = database->GetHardnessZone(zipcode);
+      if (!zone_crops.contains(zone)) {
+        auto plants = database->GetPlantsByZone(zone);
+        zone_crops.emplace(zone, database->CollectData(plants));
+      }
+      cell_members[grid.Snap(location->second)].push_back(Member{zipcode, zone});
+    } catch (std::exception const&) {
+      // The zipcode has no zone, or the zone lists no crops.
+      ++summary.skipped;
+    }
+  }
+
+  std::vector<Coordinates> centers{};
+  std::vector<std::vector<Member> const*> members{};
+  centers.reserve(cell_members.size());
+  members.reserve(cell_members.size());
+  for (auto const& [cell, cell_zipcodes] : cell_members) {
+    centers.push_back(grid.GetCellCenter(cell));
+    members.push_back(&cell_zipcodes);
+  }
+  summary.cells = centers.size();
+
+  const auto batches = util::ChunkCoordinates(
+      centers, std::max<std::size_t>(options.batch_size, 1));
+  std::vector<std::size_t> batch_offsets(batches.size());
+  for (std::size_t i = 1; i < batches.size(); ++i) {
+    batch_offsets[i] = batch_offsets[i - 1] + batches[i - 1].size();
+  }
+
+  const auto generated_at = std::chrono::system_clock::to_time_t(
+      std::chrono::system_clock::now());
+  std::mutex entries_mutex{};
+  std::vector<PlantMapEntry> entries{};
+  std::atomic<std::size_t> next_batch{0};
+  std::atomic<std::size_t> failed_cells{0};
+  {
+    std::vector<std::jthread> workers{};
+    const std::size_t thread_count =
+        std::clamp<std::size_t>(options.threads, 1, std::max<std::size_t>(batches.size(), 1));
+    for (std::size_t t = 0; t < thread_count; ++t) {
+      workers.emplace_back([&] {
+        std::vector<PlantMapEntry> local{};
+        for (std::size_t b = next_batch++; b < batches.size(); b = next_batch++) {
+          std::vector<CropWeatherJsonPtr> responses{};
+          try {
+            responses = CropDataProcessor::GetBatchWeatherData(
+                batches[b], batches[b].size());
+          } catch (std::exception const&) {
+            failed_cells += batches[b].size();
+            continue;
+          }
+
+          for (std::size_t i = 0; i < responses.size(); ++i) {
+            // A cell whose weather cannot be evaluated is left out whole, and
+            // must not end the worker: an exception escaping a std::jthread
+            // terminates the process.
+            std::vector<PlantMapEntry> cell_entries{};
+            try {
+              // Every zone present in the cell is evaluated once.
+              std::unordered_map<int, std::vector<std::size_t>> zone_plantable{};
+              for (Member const& member : *members[batch_offsets[b] + i]) {
+                auto [it, inserted] = zone_plantable.try_emplace(member.zone);
+                if (inserted) {
+                  for (auto const& [crop, plantable] :
+                       CropDataProcessor::IsWeatherSuitable(
+                           *responses[i], *zone_crops.at(member.zone))) {
+                    if (plantable) {
+                      it->second.push_back(crop_indices.at(crop));
+                    }
+                  }
+                }
+                cell_entries.push_back(
+                    PlantMapEntry{member.zipcode, member.zone, it->second});
+              }
+            } catch (std::exception const&) {
+              ++failed_cells;
+              continue;
+            }
+            std::ranges::move(cell_entries, std::back_inserter(local));
+          }
+        }
+        std::lock_guard lock{entries_mutex};
+        std::ranges::move(local, std::back_inserter(entries));
+      });
+    }
+  }
+
+  summary.failed_cells = failed_cells;
+  [[unlikely]] if (summary.cells > 0 && summary.failed_cells == summary.cells) {
+    throw std::runtime_error("Failed to fetch or evaluate the weather of every cell");
+  }
+  PlantMap::Write(options.output, crop_names, entries, generated_at);
+  return summary;
+}
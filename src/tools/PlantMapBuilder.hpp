@@ -0,0 +1,70 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "api/CropDataProcessor.hpp"
+#include "api/CropDatabase.hpp"
+#include "api/models/Coordinates.hpp"
+
+namespace weatherer::tools {
+/**
+ * @brief Builds the nationwide plant map from today's weather.
+ *
+ * Every zipcode of the zipcode database is placed with the Census ZCTA
+ * gazetteer, and the zipcodes are grouped by weather grid cell, so weather is
+ * fetched once per cell (packed into multi-location requests) rather than once
+ * per zipcode. Within a cell the crops of each hardiness zone are evaluated
+ * once and the result is shared by every zipcode of that zone. Batches of
+ * cells are fetched and evaluated on a pool of worker threads.
+ */
+class PlantMapBuilder {
+ public:
+  struct Options {
+    // The Census ZCTA gazetteer (e.g. 2023_Gaz_zcta_national.txt).
+    std::filesystem::path gazetteer{};
+    std::filesystem::path output{"plant_map.bin"};
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t batch_size = CropDataProcessor::kDefaultBatchSize;
+  };
+
+  struct Summary {
+    std::size_t zipcodes = 0;
+    // Zipcodes without coordinates, zone or zone crops.
+    std::size_t skipped = 0;
+    std::size_t cells = 0;
+    // Cells whose weather could not be fetched or evaluated; their zipcodes
+    // are left out.
+    std::size_t failed_cells = 0;
+  };
+
+  // Prevent instantiation of the PlantMapBuilder class.
+  PlantMapBuilder() = delete;
+  ~PlantMapBuilder() = delete;
+
+  /**
+   * @brief Reads the internal point of every ZCTA from a Census gazetteer file.
+   * @param path The tab separated gazetteer.
+   * @return The coordinates of every zipcode.
+   * @throws std::runtime_error if the file cannot be read or lacks the
+   * GEOID, INTPTLAT or INTPTLONG columns.
+   */
+  [[nodiscard]] static std::unordered_map<std::string, Coordinates> ReadGazetteer(
+      std::filesystem::path const& path);
+
+  /**
+   * @brief Fetches today's weather and writes the plant map.
+   * @param options The input, output and parallelism of the job.
+   * @param database The crop databases.
+   * @return What was mapped and skipped.
+   * @throws std::runtime_error if no cell could be evaluated or the map cannot be written.
+   */
+  static Summary Build(
+      Options const& options,
+      std::shared_ptr<const CropDatabase> database = CropDatabase::GetDefault());
+};
+}  // namespace weatherer::tools
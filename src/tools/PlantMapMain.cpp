@@ -0,0 +1,64 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "tools/PlantMapBuilder.hpp"
+
+namespace {
+void PrintUsage() {
+  std::cout
+      << "Usage: weatherer_plant_map --gazetteer <file> [options]\n"
+         "  --gazetteer <file>   Census ZCTA gazetteer (tab separated)\n"
+         "  --output <file>      Plant map to write (default: plant_map.bin)\n"
+         "  --threads <count>    Worker threads (default: one per core)\n"
+         "  --batch-size <count> Locations per weather request (default: 50)\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  using weatherer::tools::PlantMapBuilder;
+
+  PlantMapBuilder::Options options{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      return 0;
+    }
+    [[unlikely]] if (i + 1 >= argc) {
+      PrintUsage();
+      return 1;
+    }
+    const std::string value{argv[++i]};
+    if (arg == "--gazetteer") {
+      options.gazetteer = value;
+    } else if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--threads") {
+      options.threads = std::stoul(value);
+    } else if (arg == "--batch-size") {
+      options.batch_size = std::stoul(value);
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (options.gazetteer.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const PlantMapBuilder::Summary summary = PlantMapBuilder::Build(options);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::steady_clock::now() - start);
+
+  std::cout << "Zipcodes: " << summary.zipcodes
+            << " Skipped: " << summary.skipped
+            << " Cells: " << summary.cells
+            << " Failed cells: " << summary.failed_cells
+            << " Elapsed: " << elapsed.count() << "s\n"
+            << "Wrote " << options.output.string() << "\n";
+  return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "api/CropDatabase.hpp"
+#include "api/models/Coordinates.hpp"
+#include "api/models/PvData.hpp"
+
+/**
+ * @brief The kernels as they were before they were optimized, frozen.
+ *
+ * weatherer_diff compares the current kernels against these, so a regression
+ * in the current code cannot hide by changing the reference along with it. The
+ * bodies are copied verbatim from the original implementation; only the
+ * signatures take already parsed inputs. Do not change them.
+ */
+namespace weatherer::tools::reference {
+/**
+ * @return The hour of solar noon in the range [1, 24], as
+ * PvMetrics::CalculateSolarNoonTime originally computed it.
+ */
+[[nodiscard]] int CalculateSolarNoonTime(const PvData& pv_data);
+
+/**
+ * @return The energy yield of a day in kWh, as
+ * PvMetrics::CalculateDailyEnergyYeild originally computed it.
+ */
+[[nodiscard]] double CalculateDailyEnergyYeild(PvData const& pv_data,
+                                               Coordinates const& coordinates,
+                                               std::string const& date,
+                                               double panel_eff,
+                                               double panel_area);
+
+/**
+ * @return Whether each crop can be planted, as
+ * CropDataProcessor::IsWeatherSuitable originally decided it from the first 23
+ * hourly soil temperatures.
+ */
+[[nodiscard]] std::unordered_map<std::string, bool> IsWeatherSuitable(
+    nlohmann::json const& json, CropCollection const& data);
+}  // namespace weatherer::tools::reference
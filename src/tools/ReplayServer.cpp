@@ -0,0 +1,213 @@
+#include "ReplayServer.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include <cpr/cpr.h>
+#include <httplib.h>
+
+#include "api/Endpoints.hpp"
+#include "tools/SyntheticResponses.hpp"
+
+weatherer::tools::ReplayServer::ReplayServer(Options options)
+    : options_(std::move(options)),
+      server_(std::make_unique<httplib::Server>()),
+      random_(options_.seed) {
+  [[unlikely]] if (options_.error_rate < 0 || options_.error_rate > 1) {
+    throw std::invalid_argument(
+        "Error rate must be a value between 0 and 1 (inclusive)");
+  }
+  if (options_.mode == Mode::kRecord) {
+    std::filesystem::create_directories(options_.fixtures_dir);
+  }
+
+  const std::size_t threads = options_.threads;
+  server_->new_task_queue = [threads] {
+    return new httplib::ThreadPool(threads);
+  };
+  server_->Get(".*", [this](const httplib::Request& req,
+                            httplib::Response& res) { Handle(req, res); });
+}
+
+weatherer::tools::ReplayServer::~ReplayServer() {
+  Stop();
+}
+
+void weatherer::tools::ReplayServer::Bind() {
+  port_ = options_.port == 0
+              ? server_->bind_to_any_port(options_.host)
+              : (server_->bind_to_port(options_.host, options_.port)
+                     ? options_.port
+                     : -1);
+  [[unlikely]] if (port_ < 0) {
+    throw std::runtime_error("Failed to bind replay server to " +
+                             options_.host);
+  }
+}
+
+void weatherer::tools::ReplayServer::Start() {
+  Bind();
+  thread_ = std::thread{[this] { server_->listen_after_bind(); }};
+}
+
+void weatherer::tools::ReplayServer::Listen() {
+  Bind();
+  server_->listen_after_bind();
+}
+
+void weatherer::tools::ReplayServer::Stop() {
+  server_->stop();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+std::string weatherer::tools::ReplayServer::GetBaseUrl() const {
+  return "http://" + options_.host + ":" + std::to_string(port_);
+}
+
+void weatherer::tools::ReplayServer::Handle(const httplib::Request& req,
+                                            httplib::Response& res) {
+  if (options_.latency.count() > 0) {
+    std::this_thread::sleep_for(options_.latency);
+  }
+
+  if (ShouldInjectError()) {
+    ++injected_errors_;
+    res.status = 503;
+    res.set_header("Retry-After", "1");
+    res.set_content("Injected failure", "text/plain");
+    return;
+  }
+
+  const std::string key = MakeFixtureKey(req);
+  std::optional<std::string> body = LoadFixture(key);
+
+  if (!body && options_.mode == Mode::kRecord) {
+    body = FetchUpstream(req);
+    if (body) {
+      SaveFixture(key, *body);
+      ++recorded_;
+    }
+  } else if (!body && options_.mode == Mode::kSynthesize) {
+    body = Synthesize(req);
+  }
+
+  if (!body) {
+    ++missed_;
+    res.status = 404;
+    res.set_content("No fixture recorded for " + key, "text/plain");
+    return;
+  }
+
+  ++served_;
+  res.status = 200;
+  const bool flat = req.has_param("format") &&
+                    req.get_param_value("format") == "flatbuffers";
+  res.set_content(*body, flat ? "application/octet-stream" : "application/json");
+}
+
+bool weatherer::tools::ReplayServer::ShouldInjectError() {
+  if (options_.error_rate <= 0) {
+    return false;
+  }
+  std::lock_guard lock{random_mutex_};
+  return std::bernoulli_distribution{options_.error_rate}(random_);
+}
+
+std::string weatherer::tools::ReplayServer::MakeFixtureKey(
+    const httplib::Request& req) {
+  // Parameters are kept sorted by name; repeated names keep their order.
+  std::string key = req.path;
+  char separator = '?';
+  for (const auto& [name, value] : req.params) {
+    key += separator;
+    key += name;
+    key += '=';
+    key += value;
+    separator = '&';
+  }
+  return key;
+}
+
+std::filesystem::path weatherer::tools::ReplayServer::GetFixturePath(
+    std::string const& key) const {
+  // 64-bit FNV-1a keeps fixture names short and filesystem safe.
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(hash));
+  return options_.fixtures_dir / name;
+}
+
+std::optional<std::string> weatherer::tools::ReplayServer::LoadFixture(
+    std::string const& key) const {
+  std::filesystem::path path = GetFixturePath(key);
+  std::ifstream file{path.replace_extension(".response"), std::ios::binary};
+  if (!file) {
+    return std::nullopt;
+  }
+  return std::string{std::istreambuf_iterator<char>{file},
+                     std::istreambuf_iterator<char>{}};
+}
+
+void weatherer::tools::ReplayServer::SaveFixture(std::string const& key,
+                                                 std::string const& body) const {
+  const std::filesystem::path path = GetFixturePath(key);
+  // Keep the request next to the response so fixtures can be inspected.
+  std::ofstream{std::filesystem::path{path}.replace_extension(".request")}
+      << key << "\n";
+  std::ofstream{std::filesystem::path{path}.replace_extension(".response"),
+                std::ios::binary}
+      << body;
+}
+
+std::optional<std::string> weatherer::tools::ReplayServer::FetchUpstream(
+    const httplib::Request& req) {
+  std::string_view host{};
+  if (req.path == Endpoints::kForecastPath) {
+    host = Endpoints::kDefaultForecastHost;
+  } else if (req.path == Endpoints::kHistoricalPath) {
+    host = Endpoints::kDefaultHistoricalHost;
+  } else if (req.path == Endpoints::kEnsemblePath) {
+    host = Endpoints::kDefaultEnsembleHost;
+  } else if (req.path == Endpoints::kGeocoderPath) {
+    host = Endpoints::kDefaultGeocoderHost;
+  } else {
+    return std::nullopt;
+  }
+
+  cpr::Parameters prams{};
+  for (const auto& [name, value] : req.params) {
+    prams.Add(cpr::Parameter{name, value});
+  }
+  const cpr::Response res =
+      cpr::Get(cpr::Url{std::string{host} + req.path}, prams);
+  if (res.status_code != 200) {
+    return std::nullopt;
+  }
+  return res.text;
+}
+
+std::optional<std::string> weatherer::tools::ReplayServer::Synthesize(
+    const httplib::Request& req) {
+  const QueryParams params{req.params.begin(), req.params.end()};
+  if (req.path == Endpoints::kForecastPath ||
+      req.path == Endpoints::kHistoricalPath) {
+    return SyntheticResponses::MakeWeatherResponse(params);
+  }
+  if (req.path == Endpoints::kEnsemblePath) {
+    return SyntheticResponses::MakeEnsembleResponse(params);
+  }
+  if (req.path == Endpoints::kGeocoderPath) {
+    return SyntheticResponses::MakeGeocoderResponse(params);
+  }
+  return std::nullopt;
+}
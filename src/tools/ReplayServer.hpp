@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace httplib {
+class Server;
+struct Request;
+struct Response;
+}  // namespace httplib
+
+namespace weatherer::tools {
+/**
+ * @brief Local HTTP stand-in for the Open-Meteo and Census APIs.
+ *
+ * The ReplayServer answers requests for the forecast, historical and geocoder
+ * endpoints from recorded fixtures, so that every ingest path can run offline and
+ * deterministically. In record mode, requests without a fixture are forwarded to
+ * the public service and successful responses are saved for later replay.
+ * In synthesize mode, requests without a fixture are answered with generated
+ * responses (see SyntheticResponses), which needs no recordings at all.
+ * Latency and failures can be injected to exercise callers under load.
+ *
+ * Point Weatherer at the server with Endpoints::SetBaseUrl(server.GetBaseUrl())
+ * or the WEATHERER_API_BASE_URL environment variable.
+ */
+class ReplayServer {
+ public:
+  enum class Mode { kReplay, kRecord, kSynthesize };
+
+  struct Options {
+    // Directory holding the recorded fixtures.
+    std::filesystem::path fixtures_dir{"fixtures"};
+    Mode mode = Mode::kReplay;
+    std::string host{"127.0.0.1"};
+    // A port of 0 binds to any free port.
+    int port = 0;
+    // Delay added to every response.
+    std::chrono::milliseconds latency{0};
+    // Probability [0, 1] of answering with 503 Service Unavailable.
+    double error_rate = 0.0;
+    // Seed for the error injection, making failure sequences reproducible.
+    std::uint32_t seed = 0;
+    // Number of worker threads serving requests.
+    std::size_t threads = 8;
+  };
+
+ private:
+  Options options_;
+  std::unique_ptr<httplib::Server> server_;
+  std::thread thread_;
+  int port_ = -1;
+
+  std::mutex random_mutex_;
+  std::mt19937 random_;
+
+  std::atomic<std::size_t> served_{0};
+  std::atomic<std::size_t> missed_{0};
+  std::atomic<std::size_t> recorded_{0};
+  std::atomic<std::size_t> injected_errors_{0};
+
+  /**
+   * @brief Binds the server to the configured address, recording the bound port.
+   * @throws std::runtime_error if the address cannot be bound.
+   */
+  void Bind();
+
+  void Handle(const httplib::Request& req, httplib::Response& res);
+
+  /**
+   * @brief Decides whether the current request should fail.
+   * @return True with probability Options::error_rate.
+   */
+  bool ShouldInjectError();
+
+  /**
+   * @brief Builds the canonical key of a request (path and sorted query).
+   * @param req The incoming request.
+   * @return The key identifying the fixture of the request.
+   */
+  [[nodiscard]] static std::string MakeFixtureKey(const httplib::Request& req);
+
+  /**
+   * @brief Gets the fixture path of a key, without its extension.
+   * @param key The fixture key.
+   * @return The path of the fixture inside the fixtures directory.
+   */
+  [[nodiscard]] std::filesystem::path GetFixturePath(
+      std::string const& key) const;
+
+  [[nodiscard]] std::optional<std::string> LoadFixture(
+      std::string const& key) const;
+
+  void SaveFixture(std::string const& key, std::string const& body) const;
+
+  /**
+   * @brief Fetches a request from the public service it stands in for.
+   * @param req The incoming request.
+   * @return The upstream body, or nothing if the path is unknown or the request failed.
+   */
+  [[nodiscard]] static std::optional<std::string> FetchUpstream(
+      const httplib::Request& req);
+
+  /**
+   * @brief Generates a response for a request to one of the known endpoints.
+   * @param req The incoming request.
+   * @return The generated body, or nothing if the path is unknown.
+   */
+  [[nodiscard]] static std::optional<std::string> Synthesize(
+      const httplib::Request& req);
+
+ public:
+  explicit ReplayServer(Options options);
+  ~ReplayServer();
+  ReplayServer(const ReplayServer& other) = delete;
+  ReplayServer& operator=(const ReplayServer& other) = delete;
+
+  /**
+   * @brief Binds the server and serves requests on a background thread.
+   * @throws std::runtime_error if the server cannot bind to the configured address.
+   */
+  void Start();
+
+  /**
+   * @brief Binds the server and serves requests on the calling thread until stopped.
+   * @throws std::runtime_error if the server cannot bind to the configured address.
+   */
+  void Listen();
+
+  /**
+   * @brief Stops serving. Safe to call from another thread while Listen() runs,
+   * but not from a signal handler; see util::InterruptWatcher.
+   */
+  void Stop();
+
+  [[nodiscard]] int GetPort() const { return port_; }
+
+  /**
+   * @return The base URL to hand to Endpoints::SetBaseUrl.
+   */
+  [[nodiscard]] std::string GetBaseUrl() const;
+
+  [[nodiscard]] std::size_t GetServedCount() const { return served_; }
+  [[nodiscard]] std::size_t GetMissedCount() const { return missed_; }
+  [[nodiscard]] std::size_t GetRecordedCount() const { return recorded_; }
+  [[nodiscard]] std::size_t GetInjectedErrorCount() const {
+    return injected_errors_;
+  }
+};
+}  // namespace weatherer::tools
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "tools/ReplayServer.hpp"
+#include "util/Interrupt.hpp"
+
+namespace {
+void PrintUsage() {
+  std::cout
+      << "Usage: weatherer_replay [options]\n"
+         "  --fixtures <dir>     Fixture directory (default: fixtures)\n"
+         "  --mode <mode>        replay, record or synthesize (default: replay)\n"
+         "  --host <host>        Address to bind (default: 127.0.0.1)\n"
+         "  --port <port>        Port to bind (default: 8080)\n"
+         "  --latency-ms <ms>    Delay added to every response (default: 0)\n"
+         "  --error-rate <rate>  Probability of answering 503 (default: 0)\n"
+         "  --seed <seed>        Seed for the injected failures (default: 0)\n"
+         "  --threads <count>    Worker threads (default: 8)\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  using weatherer::tools::ReplayServer;
+
+  ReplayServer::Options options{};
+  options.port = 8080;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      return 0;
+    }
+    [[unlikely]] if (i + 1 >= argc) {
+      PrintUsage();
+      return 1;
+    }
+    const std::string value{argv[++i]};
+    if (arg == "--fixtures") {
+      options.fixtures_dir = value;
+    } else if (arg == "--mode") {
+      options.mode = value == "record"       ? ReplayServer::Mode::kRecord
+                     : value == "synthesize" ? ReplayServer::Mode::kSynthesize
+                                             : ReplayServer::Mode::kReplay;
+    } else if (arg == "--host") {
+      options.host = value;
+    } else if (arg == "--port") {
+      options.port = std::stoi(value);
+    } else if (arg == "--latency-ms") {
+      options.latency = std::chrono::milliseconds{std::stoll(value)};
+    } else if (arg == "--error-rate") {
+      options.error_rate = std::stod(value);
+    } else if (arg == "--seed") {
+      options.seed = static_cast<std::uint32_t>(std::stoul(value));
+    } else if (arg == "--threads") {
+      options.threads = std::stoul(value);
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  ReplayServer server{options};
+  const weatherer::util::InterruptWatcher interrupt{[&server] { server.Stop(); }};
+
+  std::cout << "Serving fixtures from " << options.fixtures_dir.string()
+            << " on " << options.host << ":" << options.port << std::endl;
+  server.Listen();
+
+  std::cout << "Served: " << server.GetServedCount()
+            << " Missed: " << server.GetMissedCount()
+            << " Recorded: " << server.GetRecordedCount()
+            << " Injected errors: " << server.GetInjectedErrorCount() << "\n";
+  return 0;
+}
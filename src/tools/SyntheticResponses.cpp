@@ -0,0 +1,507 @@
+#include "SyntheticResponses.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "api/FlatWeatherReader.hpp"
+#include "util/ChunkOperator.hpp"
+
+namespace {
+using Json = nlohmann::json;
+
+// Mixes a location and a day into a reproducible pseudo random value in [0, 1).
+double Noise(const double latitude, const double longitude,
+             const std::int64_t day, const std::uint64_t salt) {
+  std::uint64_t x = static_cast<std::uint64_t>(std::llround(latitude * 1e4)) *
+                        0x9E3779B97F4A7C15ull ^
+                    static_cast<std::uint64_t>(std::llround(longitude * 1e4)) *
+                        0xC2B2AE3D27D4EB4Full ^
+                    static_cast<std::uint64_t>(day) * 0x165667B19E3779F9ull ^
+                    salt;
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDull;
+  x ^= x >> 33;
+  return static_cast<double>(x >> 11) / static_cast<double>(1ull << 53);
+}
+
+std::vector<std::string> GetValues(weatherer::tools::QueryParams const& params,
+                                   std::string const& name) {
+  std::vector<std::string> values{};
+  const auto [begin, end] = params.equal_range(name);
+  for (auto it = begin; it != end; ++it) {
+    for (auto& value : weatherer::util::SplitString(it->second, ",")) {
+      values.push_back(std::move(value));
+    }
+  }
+  return values;
+}
+
+std::chrono::sys_days ParseDay(std::string const& date) {
+  int year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  [[unlikely]] if (std::sscanf(date.c_str(), "%d-%u-%u", &year, &month,
+                               &day) != 3) {
+    throw std::invalid_argument("Invalid date: " + date);
+  }
+  return std::chrono::sys_days{std::chrono::year{year} /
+                               std::chrono::month{month} /
+                               std::chrono::day{day}};
+}
+
+double HourlyValue(std::string const& variable, const double latitude,
+                   const double longitude, const std::int64_t day,
+                   const int hour) {
+  using std::numbers::pi;
+  const double day_of_year = static_cast<double>(day % 365);
+  const double season = std::sin(2 * pi * (day_of_year - 110) / 365.0);
+  const double cloud = std::round(Noise(latitude, longitude, day, 1) * 100);
+
+  if (variable == "cloud_cover") {
+    return cloud;
+  }
+  if (variable == "shortwave_radiation") {
+    const double daylight = std::sin(pi * (hour - 6) / 12.0);
+    return daylight <= 0 ? 0
+                         : std::round((700 + 250 * season) * daylight *
+                                      (1 - 0.7 * cloud / 100));
+  }
+  if (variable == "wind_speed_10m") {
+    return std::round((3 + 20 * Noise(latitude, longitude, day, 2)) * 10) / 10;
+  }
+  // Temperatures, including soil temperatures.
+  const double base = 12 + 12 * season - 0.4 * std::abs(latitude - 35);
+  const double amplitude = variable.starts_with("soil") ? 2 : 6;
+  return std::round((base + amplitude * std::sin(pi * (hour - 9) / 12.0) +
+                     4 * (Noise(latitude, longitude, day, 3) - 0.5)) *
+                    10) /
+         10;
+}
+
+// Daily aggregates such as temperature_2m_min.
+double DailyMinimum(std::string const& variable, const double latitude,
+                    const double longitude, const std::int64_t day) {
+  double minimum = HourlyValue(variable, latitude, longitude, day, 0);
+  for (int h = 1; h < 24; ++h) {
+    minimum = std::min(minimum,
+                       HourlyValue(variable, latitude, longitude, day, h));
+  }
+  return minimum;
+}
+
+// The value of an ensemble member: the control run (member 0) matches the
+// deterministic forecast, and every other member perturbs it.
+double MemberValue(std::string const& variable, const double latitude,
+                   const double longitude, const std::int64_t day,
+                   const int hour, const std::size_t member) {
+  const double value = HourlyValue(variable, latitude, longitude, day, hour);
+  if (member == 0) {
+    return value;
+  }
+  const double offset = Noise(latitude, longitude, day, 0x100 + member) - 0.5;
+  if (variable == "cloud_cover") {
+    return std::clamp(std::round(value + 60 * offset), 0.0, 100.0);
+  }
+  if (variable == "shortwave_radiation") {
+    return std::round(value * (1 - 0.5 * offset));
+  }
+  if (variable == "wind_speed_10m") {
+    return std::max(0.0, std::round((value + 6 * offset) * 10) / 10);
+  }
+  return std::round((value + 4 * offset) * 10) / 10;
+}
+
+// The key of a member's series; the control run keeps the plain name.
+std::string GetMemberKey(std::string const& variable,
+                         const std::size_t member) {
+  if (member == 0) {
+    return variable;
+  }
+  char suffix[16];
+  std::snprintf(suffix, sizeof(suffix), "_member%02zu", member);
+  return variable + suffix;
+}
+
+// Writes the series of every member; member_count is 1 for deterministic
+// forecasts, which hold only the control run.
+Json MakeLocation(weatherer::tools::QueryParams const& params,
+                  const double latitude, const double longitude,
+                  const std::chrono::sys_days first_day,
+                  const std::int64_t day_count,
+                  const std::size_t member_count = 1) {
+  using namespace std::chrono;
+  const std::int64_t first_day_number =
+      first_day.time_since_epoch().count();
+  const auto seconds_of = [](const sys_days day) -> std::int64_t {
+    return duration_cast<seconds>(day.time_since_epoch()).count();
+  };
+
+  Json location{{"latitude", latitude},
+                {"longitude", longitude},
+                {"generationtime_ms", 0.1},
+                {"utc_offset_seconds", 0},
+                {"timezone", "GMT"},
+                {"timezone_abbreviation", "GMT"},
+                {"elevation", 0.0}};
+
+  if (const auto hourly = GetValues(params, "hourly"); !hourly.empty()) {
+    Json series = Json::object();
+    Json time = Json::array();
+    for (std::int64_t i = 0; i < day_count * 24; ++i) {
+      time.push_back(seconds_of(first_day) + i * 3600);
+    }
+    series["time"] = std::move(time);
+    for (auto const& variable : hourly) {
+      for (std::size_t member = 0; member < member_count; ++member) {
+        Json values = Json::array();
+        for (std::int64_t d = 0; d < day_count; ++d) {
+          for (int h = 0; h < 24; ++h) {
+            const double value = MemberValue(variable, latitude, longitude,
+                                             first_day_number + d, h, member);
+            if (variable == "cloud_cover" ||
+                variable == "shortwave_radiation") {
+              values.push_back(static_cast<int>(value));
+            } else {
+              values.push_back(value);
+            }
+          }
+        }
+        series[GetMemberKey(variable, member)] = std::move(values);
+      }
+    }
+    location["hourly"] = std::move(series);
+  }
+
+  if (const auto daily = GetValues(params, "daily"); !daily.empty()) {
+    Json series = Json::object();
+    Json time = Json::array();
+    for (std::int64_t d = 0; d < day_count; ++d) {
+      time.push_back(seconds_of(first_day + days{d}));
+    }
+    series["time"] = std::move(time);
+    for (auto const& variable : daily) {
+      Json values = Json::array();
+      for (std::int64_t d = 0; d < day_count; ++d) {
+        const std::int64_t start = seconds_of(first_day + days{d});
+        if (variable == "sunrise") {
+          values.push_back(start + 6 * 3600);
+        } else if (variable == "sunset") {
+          values.push_back(start + 18 * 3600);
+        } else {
+          values.push_back(DailyMinimum(variable, latitude, longitude,
+                                        first_day_number + d));
+        }
+      }
+      series[variable] = std::move(values);
+    }
+    location["daily"] = std::move(series);
+  }
+  return location;
+}
+
+// Writes a FlatBuffers message front to back: every vtable precedes its table
+// and every referenced object follows its reference, which is patched once the
+// object is written. Fields are aligned to their size.
+class FlatBuilder {
+ private:
+  std::string buffer_{};
+
+ public:
+  [[nodiscard]] std::size_t GetSize() const { return buffer_.size(); }
+
+  [[nodiscard]] std::string Release() { return std::move(buffer_); }
+
+  void Align(const std::size_t alignment, const std::size_t extra = 0) {
+    while ((buffer_.size() + extra) % alignment != 0) {
+      buffer_.push_back('\0');
+    }
+  }
+
+  template <typename Ty_>
+  std::size_t Append(const Ty_ value) {
+    Align(sizeof(Ty_));
+    const std::size_t position = buffer_.size();
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(Ty_));
+    return position;
+  }
+
+  template <typename Ty_>
+  void Patch(const std::size_t position, const Ty_ value) {
+    std::memcpy(buffer_.data() + position, &value, sizeof(Ty_));
+  }
+
+  // Points the reference at position to the object at target.
+  void PatchReference(const std::size_t position, const std::size_t target) {
+    Patch(position, static_cast<std::uint32_t>(target - position));
+  }
+
+  // Writes a table with zeroed fields, given as field index and size in
+  // layout order, and returns the position of the table and of each field.
+  std::pair<std::size_t, std::vector<std::size_t>> AppendTable(
+      std::initializer_list<std::pair<std::uint16_t, std::size_t>> fields) {
+    std::uint16_t slots = 0;
+    for (const auto& [index, size] : fields) {
+      slots = std::max(slots, static_cast<std::uint16_t>(index + 1));
+    }
+    // Lay the fields out after the offset to the vtable.
+    std::vector<std::size_t> offsets{};
+    std::size_t table_size = 4;
+    for (const auto& [index, size] : fields) {
+      table_size = (table_size + size - 1) / size * size;
+      offsets.push_back(table_size);
+      table_size += size;
+    }
+
+    Align(2);
+    const std::size_t vtable = Append<std::uint16_t>(4 + 2 * slots);
+    Append<std::uint16_t>(static_cast<std::uint16_t>(table_size));
+    std::vector<std::uint16_t> entries(slots, 0);
+    std::size_t field = 0;
+    for (const auto& [index, size] : fields) {
+      entries[index] = static_cast<std::uint16_t>(offsets[field++]);
+    }
+    for (const std::uint16_t entry : entries) {
+      Append(entry);
+    }
+
+    Align(8);
+    const std::size_t table = Append<std::int32_t>(0);
+    Patch(table, static_cast<std::int32_t>(table - vtable));
+    buffer_.resize(table + table_size, '\0');
+    for (std::size_t& offset : offsets) {
+      offset += table;
+    }
+    return {table, std::move(offsets)};
+  }
+
+  template <typename Ty_>
+  std::size_t AppendVector(std::span<const Ty_> values) {
+    // The elements, not the length before them, are aligned to their size.
+    Align(std::max<std::size_t>(sizeof(Ty_), 4), 4);
+    const std::size_t vector =
+        Append(static_cast<std::uint32_t>(values.size()));
+    for (const Ty_ value : values) {
+      Append(value);
+    }
+    return vector;
+  }
+};
+
+// Writes one VariablesWithTime table; value_of(variable, step) yields the
+// values, stored as floats or, for timestamps, as 64-bit integers.
+template <typename Fn_>
+std::size_t AppendFlatSeries(FlatBuilder& builder,
+                             std::vector<std::string> const& variables,
+                             const std::int64_t time,
+                             const std::int32_t interval,
+                             const std::int64_t step_count, Fn_&& value_of) {
+  using weatherer::FlatWeatherReader;
+  const auto [table, fields] = builder.AppendTable(
+      {{FlatWeatherReader::kTimeField, 8},
+       {FlatWeatherReader::kTimeEndField, 8},
+       {FlatWeatherReader::kIntervalField, 4},
+       {FlatWeatherReader::kVariablesField, 4}});
+  builder.Patch(fields[0], time);
+  builder.Patch(fields[1], time + step_count * interval);
+  builder.Patch(fields[2], interval);
+
+  const std::vector<std::uint32_t> placeholders(variables.size(), 0);
+  const std::size_t references =
+      builder.AppendVector(std::span{placeholders}) + 4;
+  builder.PatchReference(fields[3], references - 4);
+
+  for (std::size_t i = 0; i < variables.size(); ++i) {
+    const bool timestamps =
+        variables[i] == "sunrise" || variables[i] == "sunset";
+    // Tagged as the API tags it; variables the reader does not know stay
+    // undefined, as they would be for an unknown enumerator.
+    const auto [variable, variable_fields] = builder.AppendTable(
+        {{timestamps ? FlatWeatherReader::kValuesInt64Field
+                     : FlatWeatherReader::kValuesField,
+          4},
+         {FlatWeatherReader::kAltitudeField, 2},
+         {FlatWeatherReader::kVariableField, 1}});
+    builder.PatchReference(references + 4 * i, variable);
+    const weatherer::FlatVariableId id =
+        FlatWeatherReader::FindVariableId(variables[i]).value_or(
+            weatherer::FlatVariableId{});
+    builder.Patch(variable_fields[1], id.altitude);
+    builder.Patch(variable_fields[2], id.variable);
+
+    std::size_t values = 0;
+    if (timestamps) {
+      std::vector<std::int64_t> series{};
+      for (std::int64_t step = 0; step < step_count; ++step) {
+        series.push_back(
+            static_cast<std::int64_t>(value_of(variables[i], step)));
+      }
+      values = builder.AppendVector(std::span<const std::int64_t>{series});
+    } else {
+      std::vector<float> series{};
+      for (std::int64_t step = 0; step < step_count; ++step) {
+        series.push_back(static_cast<float>(value_of(variables[i], step)));
+      }
+      values = builder.AppendVector(std::span<const float>{series});
+    }
+    builder.PatchReference(variable_fields[0], values);
+  }
+  return table;
+}
+
+// Writes one WeatherApiResponse message, without its size prefix.
+std::string MakeFlatLocation(weatherer::tools::QueryParams const& params,
+                             const double latitude, const double longitude,
+                             const std::chrono::sys_days first_day,
+                             const std::int64_t day_count) {
+  using namespace std::chrono;
+  using weatherer::FlatWeatherReader;
+  const std::int64_t first_day_number = first_day.time_since_epoch().count();
+  const std::int64_t first_second =
+      duration_cast<seconds>(first_day.time_since_epoch()).count();
+
+  FlatBuilder builder{};
+  const std::size_t root = builder.Append<std::uint32_t>(0);
+  const auto [table, fields] = builder.AppendTable(
+      {{FlatWeatherReader::kLatitudeField, 4},
+       {FlatWeatherReader::kLongitudeField, 4},
+       {FlatWeatherReader::kUtcOffsetSecondsField, 4},
+       {FlatWeatherReader::kDailyField, 4},
+       {FlatWeatherReader::kHourlyField, 4}});
+  builder.PatchReference(root, table);
+  builder.Patch(fields[0], static_cast<float>(latitude));
+  builder.Patch(fields[1], static_cast<float>(longitude));
+
+  if (const auto hourly = GetValues(params, "hourly"); !hourly.empty()) {
+    const std::size_t series = AppendFlatSeries(
+        builder, hourly, first_second, 3600, day_count * 24,
+        [&](std::string const& variable, const std::int64_t step) {
+          return HourlyValue(variable, latitude, longitude,
+                             first_day_number + step / 24,
+                             static_cast<int>(step % 24));
+        });
+    builder.PatchReference(fields[4], series);
+  }
+  if (const auto daily = GetValues(params, "daily"); !daily.empty()) {
+    const std::size_t series = AppendFlatSeries(
+        builder, daily, first_second, 86400, day_count,
+        [&](std::string const& variable, const std::int64_t step) -> double {
+          const std::int64_t start = first_second + step * 86400;
+          if (variable == "sunrise") {
+            return static_cast<double>(start + 6 * 3600);
+          }
+          if (variable == "sunset") {
+            return static_cast<double>(start + 18 * 3600);
+          }
+          return DailyMinimum(variable, latitude, longitude,
+                              first_day_number + step);
+        });
+    builder.PatchReference(fields[3], series);
+  }
+  return builder.Release();
+}
+
+// The locations and days of a weather request.
+struct WeatherRequest {
+  std::vector<std::string> latitudes;
+  std::vector<std::string> longitudes;
+  std::chrono::sys_days first_day;
+  std::int64_t day_count;
+};
+
+WeatherRequest ParseWeatherRequest(weatherer::tools::QueryParams const& params) {
+  using namespace std::chrono;
+
+  WeatherRequest request{GetValues(params, "latitude"),
+                         GetValues(params, "longitude"),
+                         floor<days>(system_clock::now()), 7};
+  [[unlikely]] if (request.latitudes.empty() ||
+                   request.latitudes.size() != request.longitudes.size()) {
+    throw std::invalid_argument("Mismatched latitude and longitude lists");
+  }
+
+  if (const auto start = params.find("start_date"); start != params.end()) {
+    request.first_day = ParseDay(start->second);
+    const auto end = params.find("end_date");
+    const sys_days last_day =
+        end != params.end() ? ParseDay(end->second) : request.first_day;
+    request.day_count = (last_day - request.first_day).count() + 1;
+  } else if (const auto forecast_days = params.find("forecast_days");
+             forecast_days != params.end()) {
+    request.day_count = std::stoll(forecast_days->second);
+  }
+  [[unlikely]] if (request.day_count <= 0) {
+    throw std::invalid_argument("End date precedes start date");
+  }
+  return request;
+}
+
+// Writes a JSON body: a single location yields an object, multiple locations
+// an array of them.
+std::string MakeJsonBody(weatherer::tools::QueryParams const& params,
+                         WeatherRequest const& request,
+                         const std::size_t member_count) {
+  if (request.latitudes.size() == 1) {
+    return MakeLocation(params, std::stod(request.latitudes.front()),
+                        std::stod(request.longitudes.front()),
+                        request.first_day, request.day_count, member_count)
+        .dump();
+  }
+  Json locations = Json::array();
+  for (std::size_t i = 0; i < request.latitudes.size(); ++i) {
+    locations.push_back(MakeLocation(params, std::stod(request.latitudes[i]),
+                                     std::stod(request.longitudes[i]),
+                                     request.first_day, request.day_count,
+                                     member_count));
+  }
+  return locations.dump();
+}
+}  // namespace
+
+std::string weatherer::tools::SyntheticResponses::MakeWeatherResponse(
+    QueryParams const& params) {
+  const WeatherRequest request = ParseWeatherRequest(params);
+
+  // FlatBuffers responses hold one size-prefixed message per location.
+  if (const auto format = params.find("format");
+      format != params.end() && format->second == "flatbuffers") {
+    std::string body{};
+    for (std::size_t i = 0; i < request.latitudes.size(); ++i) {
+      const std::string message = MakeFlatLocation(
+          params, std::stod(request.latitudes[i]),
+          std::stod(request.longitudes[i]), request.first_day,
+          request.day_count);
+      const auto size = static_cast<std::uint32_t>(message.size());
+      body.append(reinterpret_cast<const char*>(&size), sizeof(size));
+      body += message;
+    }
+    return body;
+  }
+  return MakeJsonBody(params, request, 1);
+}
+
+std::string weatherer::tools::SyntheticResponses::MakeEnsembleResponse(
+    QueryParams const& params) {
+  return MakeJsonBody(params, ParseWeatherRequest(params), kEnsembleMembers);
+}
+
+std::string weatherer::tools::SyntheticResponses::MakeGeocoderResponse(
+    QueryParams const& params) {
+  const auto address = params.find("address");
+  const Json match{
+      {"matchedAddress", address != params.end() ? address->second : ""},
+      {"coordinates", {{"x", -73.99676}, {"y", 40.75068}}},
+      {"addressComponents", {{"zip", "10001"}}}};
+  return Json{{"result", {{"addressMatches", Json::array({match})}}}}.dump();
+}
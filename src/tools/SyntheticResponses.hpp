@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace weatherer::tools {
+// Query parameters of a request, sorted by name (compatible with httplib::Params).
+using QueryParams = std::multimap<std::string, std::string>;
+
+/**
+ * @brief Generates deterministic, plausible API responses without the network.
+ *
+ * Produces bodies shaped like those of the Open-Meteo forecast and archive APIs
+ * (hourly and daily variables, unixtime timestamps, one object per location or an
+ * array for multi-location requests) and of the Census one-line address geocoder.
+ * Values follow simple diurnal and seasonal curves seeded by location and day, so
+ * identical requests always produce identical bodies. They are suitable for load
+ * tests and benchmarks, not for judging forecast quality.
+ *
+ * Weather responses requested with format=flatbuffers are encoded as Open-Meteo
+ * encodes them, one size-prefixed WeatherApiResponse message per location.
+ *
+ * Timestamps are generated in UTC regardless of the requested timezone.
+ */
+class SyntheticResponses {
+ public:
+  // Members of every synthetic ensemble, including the control run.
+  static constexpr std::size_t kEnsembleMembers = 31;
+
+  // Prevent instantiation of the SyntheticResponses class.
+  SyntheticResponses() = delete;
+  ~SyntheticResponses() = delete;
+
+  /**
+   * @brief Generates an Open-Meteo forecast or archive response.
+   * @param params The query parameters of the request.
+   * @return The JSON body, or the FlatBuffers body if requested.
+   * @throws std::invalid_argument if the locations or dates cannot be parsed.
+   *
+   * Honors latitude, longitude (comma separated lists), hourly, daily, start_date,
+   * end_date, forecast_days and format. Without a date range the forecast starts today.
+   */
+  [[nodiscard]] static std::string MakeWeatherResponse(QueryParams const& params);
+
+  /**
+   * @brief Generates an Open-Meteo ensemble API response.
+   * @param params The query parameters of the request.
+   * @return The JSON body.
+   * @throws std::invalid_argument if the locations or dates cannot be parsed.
+   *
+   * Honors the same parameters as MakeWeatherResponse except format, and
+   * returns kEnsembleMembers members of every hourly variable whatever the
+   * requested model. The control run equals the deterministic forecast.
+   */
+  [[nodiscard]] static std::string MakeEnsembleResponse(
+      QueryParams const& params);
+
+  /**
+   * @brief Generates a Census geocoder response matching any address.
+   * @param params The query parameters of the request.
+   * @return The JSON body, locating every address in New York, NY 10001.
+   */
+  [[nodiscard]] static std::string MakeGeocoderResponse(
+      QueryParams const& params);
+};
+}  // namespace weatherer::tools
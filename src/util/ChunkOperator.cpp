@@ -1,7 +1,11 @@
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include <string>
 
 #include "util/ChunkOperator.hpp"
+#include "util/Date.hpp"
+#include "util/RequestArena.hpp"
 
 std::vector<std::string> weatherer::util::SplitString(std::string const& str, const std::string_view delimiter) {
     std::vector<std::string> result;
@@ -17,3 +21,92 @@ std::vector<std::string> weatherer::util::SplitString(std::string const& str, co
     res.push_back(str.substr (pos_start));
     return res;
 }
+
+weatherer::util::DayBoundaries weatherer::util::DayBoundaries::FromTimestamps(
+    std::span<const std::int64_t> hourly_times,
+    std::span<const std::int64_t> day_starts) {
+  [[unlikely]] if (!std::ranges::is_sorted(hourly_times) ||
+                   !std::ranges::is_sorted(day_starts)) {
+    throw std::invalid_argument("Timestamps must be in ascending order");
+  }
+
+  DayBoundaries boundaries{RequestArena::GetCurrent()};
+  assert(boundaries.offsets_.get_allocator().resource() ==
+         RequestArena::GetCurrent());
+  boundaries.offsets_.reserve(day_starts.size() + 1);
+  for (const std::int64_t day_start : day_starts) {
+    boundaries.offsets_.push_back(static_cast<std::size_t>(
+        std::ranges::lower_bound(hourly_times, day_start) -
+        hourly_times.begin()));
+  }
+  // Samples before the first day are skipped; the last day runs to the end.
+  boundaries.offsets_.push_back(hourly_times.size());
+  return boundaries;
+}
+
+std::size_t weatherer::util::DayBoundaries::FindClockChange(
+    std::span<const std::int64_t> hourly_times, const std::size_t day) const {
+  const auto times = Slice<std::int64_t>(hourly_times, day);
+  if (times.empty() || times.size() == 24) {
+    return times.size();
+  }
+  int previous_hour = Date{static_cast<std::time_t>(times.front())}
+                          .GetCurrentLocalTime()
+                          .tm_hour;
+  for (std::size_t i = 1; i < times.size(); ++i) {
+    const int hour =
+        Date{static_cast<std::time_t>(times[i])}.GetCurrentLocalTime().tm_hour;
+    if ((hour - previous_hour + 24) % 24 != 1) {
+      return i;
+    }
+    previous_hour = hour;
+  }
+  return std::min(kDefaultClockChange, times.size());
+}
+
+weatherer::util::CoordinateList weatherer::util::JoinCoordinates(
+    std::span<const Coordinates> coords) {
+  CoordinateList list{};
+  for (auto const& coord : coords) {
+    if (!list.latitudes.empty()) {
+      list.latitudes += ',';
+      list.longitudes += ',';
+    }
+    list.latitudes += std::to_string(coord.GetLatitude());
+    list.longitudes += std::to_string(coord.GetLongitude());
+  }
+  return list;
+}
+
+std::vector<std::span<const weatherer::Coordinates>>
+weatherer::util::ChunkCoordinates(std::span<const Coordinates> coords,
+                                  const std::size_t max_batch_size,
+                                  const std::size_t max_query_length) {
+  [[unlikely]] if (max_batch_size == 0) {
+    throw std::invalid_argument("Batch size must be greater than 0");
+  }
+
+  // Each location after the first adds two URL-encoded commas (%2C).
+  constexpr std::size_t kSeparatorLength = 6;
+
+  std::vector<std::span<const Coordinates>> batches{};
+  std::size_t begin = 0;
+  std::size_t query_length = 0;
+  for (std::size_t i = 0; i < coords.size(); ++i) {
+    const std::size_t length =
+        std::to_string(coords[i].GetLatitude()).size() +
+        std::to_string(coords[i].GetLongitude()).size() + kSeparatorLength;
+    const std::size_t count = i - begin;
+    if (count > 0 && (count == max_batch_size ||
+                      query_length + length > max_query_length)) {
+      batches.push_back(coords.subspan(begin, count));
+      begin = i;
+      query_length = 0;
+    }
+    query_length += length;
+  }
+  if (begin < coords.size()) {
+    batches.push_back(coords.subspan(begin));
+  }
+  return batches;
+}
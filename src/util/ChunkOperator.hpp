@@ -1,46 +1,149 @@
 #pragma once
-#include <array>
+#include <cstdint>
+#include <memory_resource>
 #include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <stdexcept>
 
+#include "api/models/Coordinates.hpp"
+
 namespace weatherer::util {
 /**
- * @brief ChunkVector slices a vector into fixed-size chunks and returns them as arrays.
- * @tparam Ty_ The type of elements in the input vector.
- * @tparam Amt_ The size of each chunk array.
- * @param data The input vector to be chunked.
- * @param number The size of each chunk.
- * @return A vector of arrays containing the sliced chunks or an empty vector.
- * @throws std::out_of_range if the input data size is not a multiple of the specified number.
+ * @brief DayBoundaries splits an hourly series into calendar days without copying it.
  *
- * This utility function takes a vector and divides it into fixed-size chunks
- * specified by the 'number' parameter. The resulting chunks are represented
- * as arrays and stored in a vector. If the input size is not a multiple of
- * 'number', an exception is thrown. If the input vector is empty, an empty vector
- * is returned.
+ * Day boundaries are taken from the timestamps of the series rather than
+ * assuming 24 samples per day, so the 23 and 25 hour days around daylight
+ * saving transitions (timezone=auto) are sliced correctly. Each day is returned
+ * as a std::span over the original contiguous buffer.
  */
-template <typename Ty_, std::size_t Amt_>
-std::vector<std::array<Ty_, Amt_>> ChunkVector(
-    const std::vector<Ty_>& data, std::size_t number) {
-  [[unlikely]] if (data.size() % number != 0) {
-    throw std::out_of_range("Input data size is not a multiple of number");
+class DayBoundaries {
+ private:
+  // offsets_[d] is the index of the first sample of day d; the final entry
+  // is the size of the series. Allocated from the current request arena.
+  std::pmr::vector<std::size_t> offsets_;
+
+  // A pmr vector keeps the resource it was constructed with, even when another
+  // vector is move-assigned into it, so the arena is passed here.
+  explicit DayBoundaries(std::pmr::memory_resource* resource)
+      : offsets_(resource) {}
+
+ public:
+  // Where FindClockChange assumes the clocks change when the local timezone
+  // does not tell: most zones change them at 02:00.
+  static constexpr std::size_t kDefaultClockChange = 2;
+
+  /**
+   * @brief Locates the first sample of every day in an hourly series.
+   * @param hourly_times The timestamp of every sample, in ascending order.
+   * @param day_starts The timestamp at which every day starts, in ascending order.
+   * @return The boundaries of each day in day_starts.
+   * @throws std::invalid_argument if either sequence is not in ascending order.
+   */
+  [[nodiscard]] static DayBoundaries FromTimestamps(
+      std::span<const std::int64_t> hourly_times,
+      std::span<const std::int64_t> day_starts);
+
+  [[nodiscard]] std::size_t GetDayCount() const {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
   }
 
-  [[unlikely]] if (data.empty()) { return {}; }
+  /**
+   * @return The number of samples in the series the boundaries were built from.
+   */
+  [[nodiscard]] std::size_t GetSampleCount() const {
+    return offsets_.empty() ? 0 : offsets_.back();
+  }
 
-  std::vector<std::array<Ty_, Amt_>> result{};
-  result.reserve(data.size() / number);
-  for (auto const& chunk : data | std::ranges::views::chunk(Amt_)) {
-    std::array<Ty_, Amt_> chunked{};
-    std::copy(chunk.begin(), chunk.end(), chunked.begin());
-    result.push_back(chunked);
+  /**
+   * @brief Views the samples of a single day.
+   * @param series A series aligned with the timestamps the boundaries were built from.
+   * @param day The index of the day.
+   * @return The samples of the day; 23, 24 or 25 of them for hourly data.
+   * @throws std::out_of_range if day is out of range or series is misaligned.
+   */
+  template <typename Ty_>
+  [[nodiscard]] std::span<const Ty_> Slice(std::span<const Ty_> series,
+                                           const std::size_t day) const {
+    [[unlikely]] if (series.size() != GetSampleCount()) {
+      throw std::out_of_range("Series does not match the day boundaries");
+    }
+    [[unlikely]] if (day >= GetDayCount()) {
+      throw std::out_of_range("Day is out of range");
+    }
+    return series.subspan(offsets_[day], offsets_[day + 1] - offsets_[day]);
   }
 
-  return result;
-}
+  /**
+   * @brief Locates the daylight saving transition within a single day.
+   * @param hourly_times The timestamps the boundaries were built from.
+   * @param day The index of the day.
+   * @return The index, within the day, of the first sample after the clocks
+   * changed; the number of samples of the day if it has 24 of them.
+   * @throws std::out_of_range if day is out of range or hourly_times is misaligned.
+   *
+   * The change is where the local hour of consecutive samples repeats or skips
+   * one. Should the local timezone not show the change (e.g. the server runs in
+   * another zone than the location), kDefaultClockChange is assumed.
+   */
+  [[nodiscard]] std::size_t FindClockChange(
+      std::span<const std::int64_t> hourly_times, std::size_t day) const;
+
+  /**
+   * @brief Views every day of a series.
+   * @param series A series aligned with the timestamps the boundaries were built from.
+   * @return A lazy range of one std::span per day.
+   * @throws std::out_of_range if series is misaligned.
+   */
+  template <typename Ty_>
+  [[nodiscard]] auto SliceAll(std::span<const Ty_> series) const {
+    [[unlikely]] if (series.size() != GetSampleCount()) {
+      throw std::out_of_range("Series does not match the day boundaries");
+    }
+    return std::views::iota(std::size_t{0}, GetDayCount()) |
+           std::views::transform([this, series](const std::size_t day) {
+             return series.subspan(offsets_[day],
+                                   offsets_[day + 1] - offsets_[day]);
+           });
+  }
+};
 
 std::vector<std::string> SplitString(std::string const& str, std::string_view delimiter);
+
+/**
+ * @brief A list of locations formatted for a multi-location Open-Meteo request.
+ */
+struct CoordinateList {
+  // Comma separated latitudes (e.g. 52.520000,48.850000)
+  std::string latitudes;
+  // Comma separated longitudes, in the same order as latitudes.
+  std::string longitudes;
+};
+
+/**
+ * @brief Formats coordinates as comma separated latitude and longitude lists.
+ * @param coords The coordinates to format.
+ * @return The latitude and longitude lists.
+ */
+CoordinateList JoinCoordinates(std::span<const Coordinates> coords);
+
+// Upper bound for the latitude and longitude lists of one batched request.
+// Open-Meteo, like most servers, rejects URLs beyond about 8 KiB; half of that
+// leaves room for the path and the other parameters.
+inline constexpr std::size_t kMaxQueryLength = 4096;
+
+/**
+ * @brief ChunkCoordinates splits locations into batches for multi-location requests.
+ * @param coords The coordinates to split.
+ * @param max_batch_size The maximum number of locations per batch.
+ * @param max_query_length The maximum length of the latitude and longitude lists
+ * of a single batch once URL-encoded; kMaxQueryLength by default.
+ * @return Consecutive, non-empty views over coords covering every location.
+ * @throws std::invalid_argument if max_batch_size is 0.
+ */
+std::vector<std::span<const Coordinates>> ChunkCoordinates(
+    std::span<const Coordinates> coords, std::size_t max_batch_size,
+    std::size_t max_query_length = kMaxQueryLength);
 } // namespace weatherer::util
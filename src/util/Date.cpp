@@ -99,7 +99,8 @@ weatherer::util::TimeFrame::TimeFrame(std::string const& date)
 weatherer::util::TimeFrame::TimeFrame(Date const& date)
     : start_date_(date), end_date_(date) {}
 
-weatherer::util::TimeFrame::TimeFrame(const TimeFrame& other) {}
+weatherer::util::TimeFrame::TimeFrame(const TimeFrame& other)
+    : start_date_(other.start_date_), end_date_(other.end_date_) {}
 
 weatherer::util::TimeFrame::TimeFrame(TimeFrame&& other) noexcept
     : start_date_(std::move(other.start_date_)),
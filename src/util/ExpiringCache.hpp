@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace weatherer::util {
+/**
+ * @brief A thread-safe cache whose entries expire a fixed time after insertion.
+ * @tparam Key_ The type identifying an entry.
+ * @tparam Ty_ The type of the cached values; copied out on every hit.
+ *
+ * When the cache is full, expired entries are evicted first; if none have
+ * expired, the entry closest to expiry is evicted.
+ */
+template <typename Key_, typename Ty_>
+class ExpiringCache {
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    Ty_ value;
+    Clock::time_point expires_at;
+  };
+
+  std::chrono::milliseconds ttl_;
+  std::size_t capacity_;
+  mutable std::mutex mutex_;
+  std::unordered_map<Key_, Entry> entries_;
+
+  void EvictLocked(const Clock::time_point now) {
+    std::erase_if(entries_, [now](auto const& entry) {
+      return entry.second.expires_at <= now;
+    });
+    if (entries_.size() < capacity_) {
+      return;
+    }
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.expires_at < oldest->second.expires_at) {
+        oldest = it;
+      }
+    }
+    entries_.erase(oldest);
+  }
+
+ public:
+  /**
+   * @param ttl How long an entry stays valid after it is inserted.
+   * @param capacity The maximum number of entries held at once.
+   */
+  explicit ExpiringCache(const std::chrono::milliseconds ttl,
+                         const std::size_t capacity)
+      : ttl_(ttl), capacity_(capacity) {}
+
+  ExpiringCache(const ExpiringCache& other) = delete;
+  ExpiringCache& operator=(const ExpiringCache& other) = delete;
+
+  /**
+   * @param key The key of the entry.
+   * @return The cached value, or nothing if it is missing or has expired.
+   */
+  [[nodiscard]] std::optional<Ty_> Get(Key_ const& key) const {
+    std::lock_guard lock{mutex_};
+    const auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.expires_at <= Clock::now()) {
+      return std::nullopt;
+    }
+    return it->second.value;
+  }
+
+  /**
+   * @brief Inserts or replaces an entry, restarting its time to live.
+   * @param key The key of the entry.
+   * @param value The value to cache.
+   */
+  void Put(Key_ const& key, Ty_ value) {
+    if (capacity_ == 0 || ttl_.count() <= 0) {
+      return;
+    }
+    const auto now = Clock::now();
+    std::lock_guard lock{mutex_};
+    if (!entries_.contains(key) && entries_.size() >= capacity_) {
+      EvictLocked(now);
+    }
+    entries_.insert_or_assign(key, Entry{std::move(value), now + ttl_});
+  }
+
+  void Clear() {
+    std::lock_guard lock{mutex_};
+    entries_.clear();
+  }
+
+  [[nodiscard]] std::size_t GetSize() const {
+    std::lock_guard lock{mutex_};
+    return entries_.size();
+  }
+};
+}  // namespace weatherer::util
@@ -3,19 +3,25 @@
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 
+#include "Http.hpp"
+#include "Trace.hpp"
+#include "api/Endpoints.hpp"
+
 weatherer::util::LocationData
 weatherer::util::Geolocation::GetLocationData(const std::string& address) {
   using Json = nlohmann::json;
+  TraceSpan span{"Geolocation::GetLocationData"};
+  if (span.IsActive()) {
+    span.AddTag("address", address);
+  }
   cpr::Parameters prams{};
   prams.Add(cpr::Parameter{"returntype", "location"});
   prams.Add(cpr::Parameter{"searchtype", "onelineaddress"});
   prams.Add(cpr::Parameter{"benchmark", "Public_AR_Census2020"});
   prams.Add(cpr::Parameter{"address", address});
   prams.Add(cpr::Parameter{"format", "json"});
-  cpr::Response response = cpr::Get(
-      cpr::Url{
-          "https://geocoding.geo.census.gov/geocoder/locations/onelineaddress"},
-      prams);
+  cpr::Response response =
+      Http::Get(Endpoints::GetGeocoderUrl(), prams);
 
   if (response.status_code != 200) {
     throw std::runtime_error("Failed to get coordinates");
@@ -0,0 +1,98 @@
+#include "Http.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "Metrics.hpp"
+#include "RequestScheduler.hpp"
+
+namespace {
+// The metrics of one host. Looking a metric up in the registry takes its lock,
+// so each thread resolves them once and requests only update them.
+struct HostMetrics {
+  weatherer::util::Counter& response_bytes;
+  weatherer::util::Histogram& request_duration;
+  // Request counters by status code; 0 means the request got no response.
+  std::unordered_map<long, weatherer::util::Counter*> requests{};
+};
+
+HostMetrics& GetHostMetrics(std::string const& host) {
+  using weatherer::util::Metrics;
+  thread_local std::unordered_map<std::string, HostMetrics> host_metrics{};
+  auto it = host_metrics.find(host);
+  if (it == host_metrics.end()) {
+    it = host_metrics
+             .emplace(host,
+                      HostMetrics{
+                          Metrics::GetCounter(
+                              "weatherer_http_response_bytes_total",
+                              "Bytes of HTTP response bodies downloaded, by host.",
+                              {{"host", host}}),
+                          Metrics::GetHistogram(
+                              "weatherer_http_request_duration_seconds",
+                              "HTTP request latency, by host.", {{"host", host}})})
+             .first;
+  }
+  return it->second;
+}
+
+weatherer::util::Counter& GetRequestCounter(HostMetrics& metrics,
+                                            std::string const& host,
+                                            const long status_code) {
+  weatherer::util::Counter*& counter = metrics.requests[status_code];
+  if (counter == nullptr) {
+    // A status code of 0 means the request never got a response.
+    const std::string status =
+        status_code != 0 ? std::to_string(status_code) : "error";
+    counter = &weatherer::util::Metrics::GetCounter(
+        "weatherer_http_requests_total",
+        "HTTP requests by host and response status.",
+        {{"host", host}, {"status", status}});
+  }
+  return *counter;
+}
+}  // namespace
+
+cpr::Response weatherer::util::Http::Get(std::string const& url,
+                                         cpr::Parameters const& parameters) {
+  const std::string host{GetHost(url)};
+  for (std::size_t attempt = 0;; ++attempt) {
+    RequestScheduler::Acquire(host);
+    cpr::Response response = Send(url, host, parameters);
+    const auto delay =
+        RequestScheduler::GetRetryDelay(host, response, attempt);
+    if (!delay) {
+      return response;
+    }
+    std::this_thread::sleep_for(*delay);
+  }
+}
+
+cpr::Response weatherer::util::Http::Send(std::string const& url,
+                                          std::string const& host,
+                                          cpr::Parameters const& parameters) {
+  const auto start = std::chrono::steady_clock::now();
+  // Reusing a session per thread keeps connections (and TLS sessions) alive
+  // across requests instead of reconnecting every time.
+  thread_local cpr::Session session{};
+  session.SetUrl(cpr::Url{url});
+  session.SetParameters(parameters);
+  cpr::Response response = session.Get();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  HostMetrics& metrics = GetHostMetrics(host);
+  GetRequestCounter(metrics, host, response.status_code).Increment();
+  metrics.response_bytes.Increment(response.text.size());
+  metrics.request_duration.Record(elapsed);
+  return response;
+}
+
+std::string_view weatherer::util::Http::GetHost(std::string_view url) {
+  if (const auto scheme_end = url.find("://");
+      scheme_end != std::string_view::npos) {
+    url.remove_prefix(scheme_end + 3);
+  }
+  return url.substr(0, url.find_first_of("/?#"));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <cpr/cpr.h>
+
+namespace weatherer::util {
+/**
+ * @brief The single path through which the application performs HTTP requests.
+ *
+ * Every request is counted by host and status code, and its latency and
+ * response size are recorded in the metrics registry. Connections are kept
+ * alive per thread, so repeated requests to a host skip the handshakes.
+ * Requests are paced and retried by util::RequestScheduler.
+ */
+class Http {
+ private:
+  /**
+   * @brief Sends one attempt of a request and records its metrics.
+   */
+  [[nodiscard]] static cpr::Response Send(std::string const& url,
+                                          std::string const& host,
+                                          cpr::Parameters const& parameters);
+
+ public:
+  Http() = delete;
+  ~Http() = delete;
+
+  /**
+   * @brief Performs an HTTP GET request and records its metrics.
+   * @param url The URL to request.
+   * @param parameters The query parameters.
+   * @return The response of the last attempt; non-200 statuses are returned,
+   * not thrown.
+   * @throws std::runtime_error if the host's rate limit cannot grant a slot
+   * within the scheduler's maximum queue wait.
+   *
+   * Waits for a slot under the host's rate limits first, and retries
+   * rate-limited, failed and 5xx responses as the scheduler directs.
+   */
+  [[nodiscard]] static cpr::Response Get(std::string const& url,
+                                         cpr::Parameters const& parameters);
+
+  /**
+   * @param url An absolute URL, e.g. https://api.open-meteo.com/v1/forecast.
+   * @return The host and port of the URL, e.g. api.open-meteo.com.
+   */
+  [[nodiscard]] static std::string_view GetHost(std::string_view url);
+};
+}  // namespace weatherer::util
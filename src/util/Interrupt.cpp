@@ -0,0 +1,26 @@
+#include "Interrupt.hpp"
+
+#include <utility>
+
+volatile std::sig_atomic_t weatherer::util::InterruptWatcher::interrupted_ = 0;
+
+weatherer::util::InterruptWatcher::InterruptWatcher(
+    std::function<void()> on_interrupt) {
+  interrupted_ = 0;
+  std::signal(SIGINT, [](int) { interrupted_ = 1; });
+  watcher_ = std::jthread{[on_interrupt = std::move(on_interrupt)](
+                              const std::stop_token& stop) {
+    while (!stop.stop_requested()) {
+      if (interrupted_ != 0) {
+        on_interrupt();
+        return;
+      }
+      std::this_thread::sleep_for(kPollInterval_);
+    }
+  }};
+}
+
+weatherer::util::InterruptWatcher::~InterruptWatcher() {
+  std::signal(SIGINT, SIG_DFL);
+  // The jthread requests a stop and joins once destroyed.
+}
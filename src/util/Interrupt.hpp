@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <thread>
+
+namespace weatherer::util {
+/**
+ * @brief Runs a callback on an ordinary thread once SIGINT is received.
+ *
+ * The signal handler only sets a flag, which is all a handler may safely do.
+ * A watcher thread polls the flag and runs the callback, which may therefore
+ * take locks and shut sockets down (stopping a server, for instance). Only one
+ * watcher may exist at a time; the default handler is restored when it is
+ * destroyed.
+ */
+class InterruptWatcher {
+ private:
+  static volatile std::sig_atomic_t interrupted_;
+
+  static constexpr std::chrono::milliseconds kPollInterval_{100};
+
+  std::jthread watcher_;
+
+ public:
+  /**
+   * @param on_interrupt Called once, on the watcher thread, after SIGINT.
+   */
+  explicit InterruptWatcher(std::function<void()> on_interrupt);
+  ~InterruptWatcher();
+  InterruptWatcher(const InterruptWatcher& other) = delete;
+  InterruptWatcher& operator=(const InterruptWatcher& other) = delete;
+};
+}  // namespace weatherer::util
@@ -0,0 +1,118 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+weatherer::util::MappedFile::MappedFile(std::filesystem::path const& path) {
+  const auto fail = [&path] {
+    throw std::runtime_error("Failed to map file: " + path.string());
+  };
+#ifdef _WIN32
+  const HANDLE file =
+      CreateFileW(path.c_str(), GENERIC_READ,
+                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  [[unlikely]] if (file == INVALID_HANDLE_VALUE) {
+    fail();
+  }
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    fail();
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  // Empty files cannot be mapped; they simply expose no bytes.
+  if (size_ == 0) {
+    CloseHandle(file);
+    return;
+  }
+  mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  [[unlikely]] if (mapping_ == nullptr) {
+    fail();
+  }
+  data_ = static_cast<const std::byte*>(
+      MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, size_));
+  [[unlikely]] if (data_ == nullptr) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+    fail();
+  }
+#else
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  [[unlikely]] if (file < 0) {
+    fail();
+  }
+  struct stat info{};
+  if (fstat(file, &info) != 0) {
+    close(file);
+    fail();
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  // Empty files cannot be mapped; they simply expose no bytes.
+  if (size_ == 0) {
+    close(file);
+    return;
+  }
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+  close(file);
+  [[unlikely]] if (data == MAP_FAILED) {
+    fail();
+  }
+  data_ = static_cast<const std::byte*>(data);
+#endif
+}
+
+weatherer::util::MappedFile::~MappedFile() { Release(); }
+
+weatherer::util::MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+#ifdef _WIN32
+      ,
+      mapping_(std::exchange(other.mapping_, nullptr))
+#endif
+{
+}
+
+weatherer::util::MappedFile& weatherer::util::MappedFile::operator=(
+    MappedFile&& other) noexcept {
+  if (this == &other)
+    return *this;
+  Release();
+  data_ = std::exchange(other.data_, nullptr);
+  size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+  mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+  return *this;
+}
+
+void weatherer::util::MappedFile::Release() noexcept {
+#ifdef _WIN32
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  mapping_ = nullptr;
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<std::byte*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace weatherer::util {
+/**
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * The mapping shares the operating system page cache, so several processes
+ * mapping the same file read the same physical pages. Bytes appended to the
+ * file after it was mapped are not visible; map it again to observe them.
+ */
+class MappedFile {
+ private:
+  const std::byte* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  void* mapping_ = nullptr;
+#endif
+
+  void Release() noexcept;
+
+ public:
+  /**
+   * @param path The file to map.
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(std::filesystem::path const& path);
+  ~MappedFile();
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(const MappedFile& other) = delete;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  [[nodiscard]] std::span<const std::byte> GetBytes() const {
+    return {data_, size_};
+  }
+
+  [[nodiscard]] std::size_t GetSize() const { return size_; }
+};
+}  // namespace weatherer::util
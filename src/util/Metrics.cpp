@@ -0,0 +1,236 @@
+#include "Metrics.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+std::mutex weatherer::util::Metrics::mutex_{};
+std::map<std::string, weatherer::util::Metrics::Family, std::less<>>
+    weatherer::util::Metrics::families_{};
+
+namespace {
+std::string EscapeLabelValue(std::string_view value) {
+  std::string escaped{};
+  escaped.reserve(value.size());
+  for (const char c : value) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// Renders labels as the body of a Prometheus label set, without braces.
+std::string RenderLabels(weatherer::util::MetricLabels const& labels) {
+  std::string rendered{};
+  for (auto const& [key, value] : labels) {
+    if (!rendered.empty()) {
+      rendered += ',';
+    }
+    rendered += key + "=\"" + EscapeLabelValue(value) + '"';
+  }
+  return rendered;
+}
+
+std::string WrapLabels(std::string const& labels) {
+  return labels.empty() ? std::string{} : "{" + labels + "}";
+}
+}  // namespace
+
+std::size_t weatherer::util::Histogram::GetBucketIndex(
+    const std::uint64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<std::size_t>(value);
+  }
+  // The highest set bit selects the power of two, the bits below it the linear
+  // sub-bucket within it.
+  const std::size_t exponent = std::bit_width(value) - 1;
+  const std::size_t shift = exponent - kSubBucketBits;
+  const std::size_t sub_bucket = (value >> shift) & (kSubBuckets - 1);
+  return (shift + 1) * kSubBuckets + sub_bucket;
+}
+
+std::uint64_t weatherer::util::Histogram::GetBucketUpperBound(
+    const std::size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const std::size_t shift = index / kSubBuckets - 1;
+  const std::uint64_t sub_bucket = index % kSubBuckets;
+  const std::uint64_t lower = (kSubBuckets + sub_bucket) << shift;
+  return lower + ((std::uint64_t{1} << shift) - 1);
+}
+
+void weatherer::util::Histogram::Record(const std::uint64_t value,
+                                        const std::uint64_t count) {
+  buckets_[GetBucketIndex(value)].fetch_add(count, std::memory_order_relaxed);
+  count_.fetch_add(count, std::memory_order_relaxed);
+  sum_.fetch_add(value * count, std::memory_order_relaxed);
+}
+
+std::uint64_t weatherer::util::Histogram::GetQuantile(
+    const double quantile) const {
+  const std::uint64_t total = GetCount();
+  if (total == 0) {
+    return 0;
+  }
+  const auto rank = static_cast<std::uint64_t>(
+      std::clamp(quantile, 0.0, 1.0) * static_cast<double>(total - 1));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen > rank) {
+      return GetBucketUpperBound(i);
+    }
+  }
+  // Only reachable while a concurrent Record is half-way through.
+  return GetBucketUpperBound(kBucketCount - 1);
+}
+
+weatherer::util::Metrics::Family& weatherer::util::Metrics::GetFamily(
+    const std::string_view name, const std::string_view help,
+    const Type type) {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_
+             .emplace(std::string{name},
+                      Family{std::string{help}, type, {}, {}, {}})
+             .first;
+  }
+  [[unlikely]] if (it->second.type != type) {
+    throw std::invalid_argument("Metric " + std::string{name} +
+                                " is already registered with another type");
+  }
+  return it->second;
+}
+
+weatherer::util::Counter& weatherer::util::Metrics::GetCounter(
+    const std::string_view name, const std::string_view help,
+    MetricLabels const& labels) {
+  std::lock_guard lock{mutex_};
+  auto& series = GetFamily(name, help, Type::kCounter)
+                     .counters[RenderLabels(labels)];
+  if (!series) {
+    series = std::make_unique<Counter>();
+  }
+  return *series;
+}
+
+weatherer::util::Gauge& weatherer::util::Metrics::GetGauge(
+    const std::string_view name, const std::string_view help,
+    MetricLabels const& labels) {
+  std::lock_guard lock{mutex_};
+  auto& series =
+      GetFamily(name, help, Type::kGauge).gauges[RenderLabels(labels)];
+  if (!series) {
+    series = std::make_unique<Gauge>();
+  }
+  return *series;
+}
+
+weatherer::util::Histogram& weatherer::util::Metrics::GetHistogram(
+    const std::string_view name, const std::string_view help,
+    MetricLabels const& labels) {
+  std::lock_guard lock{mutex_};
+  auto& series = GetFamily(name, help, Type::kHistogram)
+                     .histograms[RenderLabels(labels)];
+  if (!series) {
+    series = std::make_unique<Histogram>();
+  }
+  return *series;
+}
+
+void weatherer::util::Metrics::WritePrometheus(std::ostream& os) {
+  constexpr double kNanosecondsPerSecond = 1e9;
+  constexpr std::array kQuantiles{0.5, 0.9, 0.99, 0.999};
+
+  std::lock_guard lock{mutex_};
+  for (auto const& [name, family] : families_) {
+    os << "# HELP " << name << ' ' << family.help << '\n';
+    if (family.type == Type::kCounter) {
+      os << "# TYPE " << name << " counter\n";
+      for (auto const& [labels, counter] : family.counters) {
+        os << name << WrapLabels(labels) << ' ' << counter->GetValue() << '\n';
+      }
+      continue;
+    }
+    if (family.type == Type::kGauge) {
+      os << "# TYPE " << name << " gauge\n";
+      for (auto const& [labels, gauge] : family.gauges) {
+        os << name << WrapLabels(labels) << ' ' << gauge->GetValue() << '\n';
+      }
+      continue;
+    }
+
+    os << "# TYPE " << name << " summary\n";
+    for (auto const& [labels, histogram] : family.histograms) {
+      const std::string separator = labels.empty() ? "" : ",";
+      for (const double quantile : kQuantiles) {
+        os << name << '{' << labels << separator << "quantile=\"" << quantile
+           << "\"} "
+           << static_cast<double>(histogram->GetQuantile(quantile)) /
+                  kNanosecondsPerSecond
+           << '\n';
+      }
+      os << name << "_sum" << WrapLabels(labels) << ' '
+         << static_cast<double>(histogram->GetSum()) / kNanosecondsPerSecond
+         << '\n';
+      os << name << "_count" << WrapLabels(labels) << ' '
+         << histogram->GetCount() << '\n';
+    }
+  }
+}
+
+weatherer::util::MetricsDumper::MetricsDumper(
+    std::string path, const std::chrono::milliseconds interval)
+    : path_(std::move(path)), interval_(interval) {
+  thread_ = std::jthread{[this](const std::stop_token stop_token) {
+    std::unique_lock lock{mutex_};
+    while (!stop_token.stop_requested()) {
+      // Returns early once a stop is requested.
+      wakeup_.wait_for(lock, stop_token, interval_, [] { return false; });
+      if (!stop_token.stop_requested()) {
+        Dump();
+      }
+    }
+  }};
+}
+
+weatherer::util::MetricsDumper::~MetricsDumper() {
+  thread_.request_stop();
+  thread_.join();
+  Dump();
+}
+
+void weatherer::util::MetricsDumper::Dump() const {
+  if (path_ == "-") {
+    Metrics::WritePrometheus(std::cout);
+    std::cout.flush();
+    return;
+  }
+
+  // Write next to the target and rename over it, so readers see whole files.
+  const std::string temp_path = path_ + ".tmp";
+  {
+    std::ofstream file{temp_path, std::ios::trunc};
+    if (!file) {
+      return;
+    }
+    Metrics::WritePrometheus(file);
+  }
+  std::error_code error{};
+  std::filesystem::rename(temp_path, path_, error);
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace weatherer::util {
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief A monotonically increasing, lock-free counter.
+ */
+class Counter {
+ private:
+  std::atomic<std::uint64_t> value_{0};
+
+ public:
+  void Increment(const std::uint64_t amount = 1) {
+    value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::uint64_t GetValue() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief A lock-free value that can go up and down, such as a queue depth.
+ */
+class Gauge {
+ private:
+  std::atomic<std::int64_t> value_{0};
+
+ public:
+  void Add(const std::int64_t amount) {
+    value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  void Set(const std::int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::int64_t GetValue() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief A lock-free, log-linear latency histogram in the style of HdrHistogram.
+ *
+ * Durations are recorded in nanoseconds. Each power of two is split into
+ * kSubBuckets linear buckets, bounding the relative error of any reported
+ * quantile to 1 / kSubBuckets across the full 64-bit range.
+ */
+class Histogram {
+ public:
+  static constexpr std::size_t kSubBucketBits = 4;
+  static constexpr std::size_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr std::size_t kBucketCount =
+      (64 - kSubBucketBits) * kSubBuckets + kSubBuckets;
+
+ private:
+  std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+
+  [[nodiscard]] static std::size_t GetBucketIndex(std::uint64_t value);
+  [[nodiscard]] static std::uint64_t GetBucketUpperBound(std::size_t index);
+
+ public:
+  /**
+   * @brief Records count observations of value nanoseconds.
+   * @param value The observed duration in nanoseconds.
+   * @param count The number of observations it stands for.
+   */
+  void Record(std::uint64_t value, std::uint64_t count = 1);
+
+  void Record(const std::chrono::nanoseconds duration,
+              const std::uint64_t count = 1) {
+    Record(static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0)),
+           count);
+  }
+
+  /**
+   * @param quantile The quantile to estimate, in [0, 1].
+   * @return The upper bound of the bucket containing the quantile, in
+   * nanoseconds, or 0 when nothing was recorded.
+   */
+  [[nodiscard]] std::uint64_t GetQuantile(double quantile) const;
+
+  [[nodiscard]] std::uint64_t GetCount() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::uint64_t GetSum() const {
+    return sum_.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief Records the lifetime of a scope into a histogram.
+ */
+class ScopedTimer {
+ private:
+  Histogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  explicit ScopedTimer(Histogram& histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedTimer() { histogram_.Record(std::chrono::steady_clock::now() - start_); }
+
+  ScopedTimer(const ScopedTimer& other) = delete;
+  ScopedTimer& operator=(const ScopedTimer& other) = delete;
+};
+
+/**
+ * @brief Process-wide registry of named metrics.
+ *
+ * Lookups take a lock, so hot paths should keep the returned reference (e.g. in
+ * a function-local static); updating a metric never locks. Metrics live for the
+ * lifetime of the process.
+ */
+class Metrics {
+ private:
+  enum class Type { kCounter, kGauge, kHistogram };
+
+  struct Family {
+    std::string help;
+    Type type;
+    // Keyed by the rendered label set, e.g. {host="a",status="200"}.
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+  };
+
+  static std::mutex mutex_;
+  static std::map<std::string, Family, std::less<>> families_;
+
+  [[nodiscard]] static Family& GetFamily(std::string_view name,
+                                         std::string_view help, Type type);
+
+ public:
+  // Prevent instantiation of the Metrics class.
+  Metrics() = delete;
+  ~Metrics() = delete;
+
+  /**
+   * @brief Gets or creates a counter.
+   * @param name The metric name, e.g. weatherer_http_requests_total.
+   * @param help The description emitted with the metric.
+   * @param labels The labels distinguishing this series within the metric.
+   * @return The counter, valid for the lifetime of the process.
+   * @throws std::invalid_argument if name is registered with another type.
+   */
+  [[nodiscard]] static Counter& GetCounter(std::string_view name,
+                                           std::string_view help,
+                                           MetricLabels const& labels = {});
+
+  /**
+   * @brief Gets or creates a gauge.
+   * @param name The metric name, e.g. weatherer_http_queue_depth.
+   * @param help The description emitted with the metric.
+   * @param labels The labels distinguishing this series within the metric.
+   * @return The gauge, valid for the lifetime of the process.
+   * @throws std::invalid_argument if name is registered with another type.
+   */
+  [[nodiscard]] static Gauge& GetGauge(std::string_view name,
+                                       std::string_view help,
+                                       MetricLabels const& labels = {});
+
+  /**
+   * @brief Gets or creates a latency histogram.
+   * @param name The metric name, e.g. weatherer_parse_duration_seconds.
+   * @param help The description emitted with the metric.
+   * @param labels The labels distinguishing this series within the metric.
+   * @return The histogram, valid for the lifetime of the process.
+   * @throws std::invalid_argument if name is registered with another type.
+   */
+  [[nodiscard]] static Histogram& GetHistogram(std::string_view name,
+                                               std::string_view help,
+                                               MetricLabels const& labels = {});
+
+  /**
+   * @brief Writes every metric in the Prometheus text exposition format.
+   *
+   * Histograms are exposed as summaries in seconds, with the 0.5, 0.9, 0.99 and
+   * 0.999 quantiles.
+   *
+   * @param os The output stream to write to.
+   */
+  static void WritePrometheus(std::ostream& os);
+};
+
+/**
+ * @brief Periodically writes the metrics in the Prometheus text format.
+ *
+ * A final snapshot is written when the dumper is destroyed. Files are replaced
+ * atomically, so a scraper (e.g. the node_exporter textfile collector) never
+ * reads a partial snapshot.
+ */
+class MetricsDumper {
+ private:
+  std::string path_;
+  std::chrono::milliseconds interval_;
+  std::mutex mutex_;
+  std::condition_variable_any wakeup_;
+  std::jthread thread_;
+
+  void Dump() const;
+
+ public:
+  /**
+   * @param path The file to write, or "-" for stdout.
+   * @param interval The time between snapshots.
+   */
+  MetricsDumper(std::string path, std::chrono::milliseconds interval);
+  ~MetricsDumper();
+  MetricsDumper(const MetricsDumper& other) = delete;
+  MetricsDumper& operator=(const MetricsDumper& other) = delete;
+};
+}  // namespace weatherer::util
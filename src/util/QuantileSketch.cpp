@@ -0,0 +1,147 @@
+#include "QuantileSketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+weatherer::util::QuantileSketch::QuantileSketch(const std::size_t k,
+                                                const std::uint64_t seed)
+    : k_(k), random_state_(seed != 0 ? seed : 1) {
+  [[unlikely]] if (k_ < 8) {
+    throw std::invalid_argument("Sketch accuracy k must be at least 8");
+  }
+  Grow();
+}
+
+std::size_t weatherer::util::QuantileSketch::GetCapacity(
+    const std::size_t level) const {
+  // Capacities shrink geometrically (by 2/3) from the top level down.
+  constexpr double kDecay = 2.0 / 3.0;
+  const auto depth = static_cast<double>(compactors_.size() - level - 1);
+  return static_cast<std::size_t>(
+             std::ceil(std::pow(kDecay, depth) * static_cast<double>(k_))) +
+         1;
+}
+
+void weatherer::util::QuantileSketch::Grow() {
+  compactors_.emplace_back();
+  max_size_ = 0;
+  for (std::size_t level = 0; level < compactors_.size(); ++level) {
+    max_size_ += GetCapacity(level);
+  }
+}
+
+bool weatherer::util::QuantileSketch::FlipCoin() {
+  // xorshift64; quality is ample for choosing which half to keep.
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 7;
+  random_state_ ^= random_state_ << 17;
+  return (random_state_ & 1) != 0;
+}
+
+void weatherer::util::QuantileSketch::Compress() {
+  for (std::size_t level = 0; level < compactors_.size(); ++level) {
+    if (compactors_[level].size() < GetCapacity(level)) {
+      continue;
+    }
+    if (level + 1 >= compactors_.size()) {
+      Grow();
+    }
+
+    std::vector<double>& compactor = compactors_[level];
+    std::ranges::sort(compactor);
+    // With an odd count the smallest value stays behind; of the rest, a random
+    // half (odd or even positions) moves up a level with twice the weight.
+    const std::size_t kept = compactor.size() % 2;
+    std::vector<double>& next = compactors_[level + 1];
+    for (std::size_t i = kept + (FlipCoin() ? 1 : 0); i < compactor.size();
+         i += 2) {
+      next.push_back(compactor[i]);
+    }
+    compactor.resize(kept);
+
+    size_ = 0;
+    for (auto const& levels : compactors_) {
+      size_ += levels.size();
+    }
+    return;
+  }
+}
+
+void weatherer::util::QuantileSketch::Add(const double value) {
+  compactors_.front().push_back(value);
+  ++size_;
+  ++count_;
+  if (size_ >= max_size_) {
+    Compress();
+  }
+}
+
+void weatherer::util::QuantileSketch::Add(std::span<const double> values) {
+  for (const double value : values) {
+    Add(value);
+  }
+}
+
+void weatherer::util::QuantileSketch::Merge(QuantileSketch const& other) {
+  while (compactors_.size() < other.compactors_.size()) {
+    Grow();
+  }
+  for (std::size_t level = 0; level < other.compactors_.size(); ++level) {
+    compactors_[level].insert(compactors_[level].end(),
+                              other.compactors_[level].begin(),
+                              other.compactors_[level].end());
+  }
+  size_ += other.size_;
+  count_ += other.count_;
+  while (size_ >= max_size_) {
+    const std::size_t before = size_;
+    Compress();
+    [[unlikely]] if (size_ == before) {
+      break;
+    }
+  }
+}
+
+double weatherer::util::QuantileSketch::GetQuantile(
+    const double quantile) const {
+  return GetQuantiles(std::span{&quantile, 1}).front();
+}
+
+std::vector<double> weatherer::util::QuantileSketch::GetQuantiles(
+    std::span<const double> quantiles) const {
+  [[unlikely]] if (size_ == 0) {
+    throw std::out_of_range("Cannot estimate quantiles of an empty sketch");
+  }
+
+  std::vector<std::pair<double, std::uint64_t>> weighted{};
+  weighted.reserve(size_);
+  std::uint64_t total_weight = 0;
+  for (std::size_t level = 0; level < compactors_.size(); ++level) {
+    const std::uint64_t weight = std::uint64_t{1} << level;
+    for (const double value : compactors_[level]) {
+      weighted.emplace_back(value, weight);
+      total_weight += weight;
+    }
+  }
+  std::ranges::sort(weighted, {}, &std::pair<double, std::uint64_t>::first);
+
+  std::vector<double> results{};
+  results.reserve(quantiles.size());
+  for (const double quantile : quantiles) {
+    const double target =
+        std::clamp(quantile, 0.0, 1.0) * static_cast<double>(total_weight);
+    std::uint64_t seen = 0;
+    double result = weighted.back().first;
+    for (auto const& [value, weight] : weighted) {
+      seen += weight;
+      if (static_cast<double>(seen) >= target) {
+        result = value;
+        break;
+      }
+    }
+    results.push_back(result);
+  }
+  return results;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace weatherer::util {
+/**
+ * @brief A mergeable streaming quantile sketch (KLL, Karnin-Lang-Liberty 2016).
+ *
+ * Memory stays O(k) however many values are added, and the rank error of any
+ * quantile is roughly 1.7 / k of the count with high probability (about 1% for
+ * the default k of 200). Sketches built on separate threads or shards can be
+ * merged, which makes the sketch suitable for parallel aggregation.
+ */
+class QuantileSketch {
+ private:
+  std::size_t k_;
+  // compactors_[h] holds values that each stand for 2^h added values.
+  std::vector<std::vector<double>> compactors_{};
+  std::size_t size_ = 0;
+  std::size_t max_size_ = 0;
+  std::uint64_t count_ = 0;
+  std::uint64_t random_state_;
+
+  [[nodiscard]] std::size_t GetCapacity(std::size_t level) const;
+
+  void Grow();
+
+  /**
+   * @brief Halves the lowest full compactor, promoting every other value.
+   */
+  void Compress();
+
+  [[nodiscard]] bool FlipCoin();
+
+ public:
+  static constexpr std::size_t kDefaultK = 200;
+
+  /**
+   * @param k The accuracy parameter; larger is more accurate and larger.
+   * @param seed Seed of the coin flips, making the sketch reproducible.
+   * @throws std::invalid_argument if k is less than 8.
+   */
+  explicit QuantileSketch(std::size_t k = kDefaultK, std::uint64_t seed = 1);
+
+  void Add(double value);
+
+  void Add(std::span<const double> values);
+
+  /**
+   * @brief Adds every value of another sketch to this one.
+   * @param other The sketch to merge; it must not be this sketch.
+   */
+  void Merge(QuantileSketch const& other);
+
+  /**
+   * @param quantile The quantile to estimate, in [0, 1].
+   * @return The estimated value at the quantile.
+   * @throws std::out_of_range if the sketch is empty.
+   */
+  [[nodiscard]] double GetQuantile(double quantile) const;
+
+  /**
+   * @param quantiles The quantiles to estimate, each in [0, 1].
+   * @return The estimated values, in the same order; cheaper than one call each.
+   * @throws std::out_of_range if the sketch is empty.
+   */
+  [[nodiscard]] std::vector<double> GetQuantiles(
+      std::span<const double> quantiles) const;
+
+  /**
+   * @return The number of values added, including through merges.
+   */
+  [[nodiscard]] std::uint64_t GetCount() const { return count_; }
+
+  /**
+   * @return The number of values retained by the sketch.
+   */
+  [[nodiscard]] std::size_t GetRetainedCount() const { return size_; }
+};
+}  // namespace weatherer::util
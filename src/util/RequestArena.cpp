@@ -0,0 +1,24 @@
+#include "RequestArena.hpp"
+
+thread_local std::pmr::memory_resource*
+    weatherer::util::RequestArena::current_ = nullptr;
+
+weatherer::util::RequestArena::RequestArena(const std::size_t initial_size)
+    : resource_(initial_size, GetThreadPool()), previous_(current_) {
+  current_ = &resource_;
+}
+
+weatherer::util::RequestArena::~RequestArena() {
+  current_ = previous_;
+}
+
+std::pmr::memory_resource* weatherer::util::RequestArena::GetThreadPool() {
+  // Arena blocks up to 1 MiB are recycled; larger ones go straight to the heap.
+  thread_local std::pmr::unsynchronized_pool_resource pool{
+      std::pmr::pool_options{16, 1024 * 1024}};
+  return &pool;
+}
+
+std::pmr::memory_resource* weatherer::util::RequestArena::GetCurrent() {
+  return current_ != nullptr ? current_ : std::pmr::get_default_resource();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace weatherer::util {
+/**
+ * @brief A monotonic arena for the short-lived allocations of one request.
+ *
+ * Constructing a RequestArena installs it as the current arena of the calling
+ * thread until it is destroyed. Only scratch buffers draw from GetCurrent():
+ * the hourly and daily series decoded from a weather response, and the day
+ * offsets of util::DayBoundaries. The per-day objects built from them are
+ * ordinary heap allocations, as they outlive the request. Allocation is a
+ * pointer bump and deallocation is free, and since each thread draws its
+ * arena blocks from its own pool, concurrent requests do not contend on the
+ * global heap. Without an installed arena GetCurrent() falls back to the
+ * default resource.
+ *
+ * Everything allocated from an arena must be released before the arena is
+ * destroyed, so only install one around work whose results do not escape it.
+ * Arenas nest; the innermost one is current.
+ */
+class RequestArena {
+ private:
+  static thread_local std::pmr::memory_resource* current_;
+
+  std::pmr::monotonic_buffer_resource resource_;
+  std::pmr::memory_resource* previous_;
+
+  /**
+   * @return The calling thread's pool that arenas grow from; blocks returned to
+   * it are reused by the thread's next arena instead of going back to the heap.
+   */
+  [[nodiscard]] static std::pmr::memory_resource* GetThreadPool();
+
+ public:
+  // Enough for the scratch buffers of a month of hourly weather.
+  static constexpr std::size_t kDefaultInitialSize = 64 * 1024;
+
+  explicit RequestArena(std::size_t initial_size = kDefaultInitialSize);
+  ~RequestArena();
+  RequestArena(const RequestArena& other) = delete;
+  RequestArena& operator=(const RequestArena& other) = delete;
+
+  [[nodiscard]] std::pmr::memory_resource* GetResource() { return &resource_; }
+
+  /**
+   * @return The innermost arena installed on the calling thread, or the
+   * default memory resource if there is none.
+   */
+  [[nodiscard]] static std::pmr::memory_resource* GetCurrent();
+};
+}  // namespace weatherer::util
@@ -0,0 +1,246 @@
+#include "RequestScheduler.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "Metrics.hpp"
+
+struct weatherer::util::RequestScheduler::Quota {
+  std::vector<TokenBucket> buckets;
+  // Set by a 429 or 503 with a Retry-After; no request is sent before it.
+  std::chrono::steady_clock::time_point paused_until{};
+};
+
+struct weatherer::util::RequestScheduler::HostState {
+  std::shared_ptr<Quota> quota;
+  Gauge& queue_depth;
+  Histogram& queue_wait;
+};
+
+std::mutex weatherer::util::RequestScheduler::mutex_{};
+
+weatherer::util::SchedulerPolicy weatherer::util::RequestScheduler::policy_{};
+
+std::map<std::string,
+         std::shared_ptr<weatherer::util::RequestScheduler::Quota>,
+         std::less<>>
+    weatherer::util::RequestScheduler::quotas_ = [] {
+      using std::chrono::hours;
+      using std::chrono::minutes;
+      // Open-Meteo's free tier; the forecast, archive and ensemble APIs share it.
+      const auto open_meteo = MakeQuota({{600, minutes{1}},
+                                         {5'000, hours{1}},
+                                         {10'000, hours{24}}});
+      return std::map<std::string, std::shared_ptr<Quota>, std::less<>>{
+          {"api.open-meteo.com", open_meteo},
+          {"archive-api.open-meteo.com", open_meteo},
+          {"ensemble-api.open-meteo.com", open_meteo}};
+    }();
+
+std::map<std::string,
+         std::shared_ptr<weatherer::util::RequestScheduler::HostState>,
+         std::less<>>
+    weatherer::util::RequestScheduler::hosts_{};
+
+std::shared_ptr<weatherer::util::RequestScheduler::Quota>
+weatherer::util::RequestScheduler::MakeQuota(
+    std::vector<RateLimit> const& limits) {
+  auto quota = std::make_shared<Quota>();
+  const auto now = std::chrono::steady_clock::now();
+  for (RateLimit const& limit : limits) {
+    [[unlikely]] if (limit.requests == 0 || limit.period.count() <= 0) {
+      throw std::invalid_argument("Rate limits must allow some requests");
+    }
+    quota->buckets.emplace_back(limit, now);
+  }
+  return quota;
+}
+
+weatherer::util::TokenBucket::TokenBucket(
+    RateLimit const& limit, const std::chrono::steady_clock::time_point now)
+    : updated_(now) {
+  const std::size_t burst = std::clamp<std::size_t>(
+      limit.burst != 0 ? limit.burst : limit.requests / 10, 1, limit.requests);
+  capacity_ = static_cast<double>(burst);
+  tokens_ = capacity_;
+  // Refill only what the burst leaves of the limit, so no window exceeds it.
+  tokens_per_second_ =
+      static_cast<double>(std::max<std::size_t>(limit.requests - burst, 1)) /
+      static_cast<double>(limit.period.count());
+}
+
+std::chrono::steady_clock::time_point weatherer::util::TokenBucket::Reserve(
+    const std::chrono::steady_clock::time_point now) {
+  if (now > updated_) {
+    const std::chrono::duration<double> elapsed = now - updated_;
+    tokens_ = std::min(capacity_, tokens_ + elapsed.count() * tokens_per_second_);
+    updated_ = now;
+  }
+  tokens_ -= 1;
+  if (tokens_ >= 0) {
+    return now;
+  }
+  return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>{-tokens_ / tokens_per_second_});
+}
+
+void weatherer::util::TokenBucket::Cancel() {
+  tokens_ = std::min(capacity_, tokens_ + 1);
+}
+
+std::shared_ptr<weatherer::util::RequestScheduler::HostState>
+weatherer::util::RequestScheduler::GetHostState(const std::string_view host) {
+  if (const auto it = hosts_.find(host); it != hosts_.end()) {
+    return it->second;
+  }
+  auto quota = quotas_.find(host);
+  if (quota == quotas_.end()) {
+    quota = quotas_.emplace(std::string{host}, MakeQuota({})).first;
+  }
+  const MetricLabels labels{{"host", std::string{host}}};
+  auto state = std::make_shared<HostState>(HostState{
+      quota->second,
+      Metrics::GetGauge("weatherer_http_queue_depth",
+                        "HTTP requests waiting for a rate limit slot, by host.",
+                        labels),
+      Metrics::GetHistogram(
+          "weatherer_http_queue_wait_seconds",
+          "Time HTTP requests waited for a rate limit slot, by host.",
+          labels)});
+  hosts_.emplace(std::string{host}, state);
+  return state;
+}
+
+std::optional<std::chrono::seconds>
+weatherer::util::RequestScheduler::GetRetryAfter(
+    cpr::Response const& response) {
+  const auto header = response.header.find("Retry-After");
+  if (header == response.header.end()) {
+    return std::nullopt;
+  }
+  // Only the delay-seconds form; an HTTP date falls back to the backoff.
+  std::string_view value = header->second;
+  value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+  long long seconds = 0;
+  const auto [end, error] =
+      std::from_chars(value.data(), value.data() + value.size(), seconds);
+  if (error != std::errc{} || end == value.data() || seconds < 0) {
+    return std::nullopt;
+  }
+  return std::chrono::seconds{seconds};
+}
+
+void weatherer::util::RequestScheduler::SetLimits(
+    std::vector<std::string> const& hosts,
+    std::vector<RateLimit> const& limits) {
+  const std::shared_ptr<Quota> quota = MakeQuota(limits);
+  std::lock_guard lock{mutex_};
+  for (std::string const& host : hosts) {
+    quotas_.insert_or_assign(host, quota);
+    if (const auto state = hosts_.find(host); state != hosts_.end()) {
+      state->second->quota = quota;
+    }
+  }
+}
+
+void weatherer::util::RequestScheduler::SetPolicy(
+    SchedulerPolicy const& policy) {
+  std::lock_guard lock{mutex_};
+  policy_ = policy;
+}
+
+weatherer::util::SchedulerPolicy weatherer::util::RequestScheduler::GetPolicy() {
+  std::lock_guard lock{mutex_};
+  return policy_;
+}
+
+std::chrono::nanoseconds weatherer::util::RequestScheduler::Acquire(
+    const std::string_view host) {
+  const auto now = std::chrono::steady_clock::now();
+  auto ready = now;
+  std::shared_ptr<HostState> state{};
+  {
+    std::lock_guard lock{mutex_};
+    state = GetHostState(host);
+    Quota& quota = *state->quota;
+    ready = std::max(ready, quota.paused_until);
+    for (TokenBucket& bucket : quota.buckets) {
+      ready = std::max(ready, bucket.Reserve(now));
+    }
+    [[unlikely]] if (policy_.max_queue_wait &&
+                     ready - now > *policy_.max_queue_wait) {
+      for (TokenBucket& bucket : quota.buckets) {
+        bucket.Cancel();
+      }
+      throw std::runtime_error("The rate limit of " + std::string{host} +
+                               " is exhausted");
+    }
+  }
+
+  const auto wait = ready - now;
+  if (wait > std::chrono::steady_clock::duration::zero()) {
+    state->queue_depth.Add(1);
+    std::this_thread::sleep_until(ready);
+    state->queue_depth.Add(-1);
+  }
+  state->queue_wait.Record(wait);
+  return wait;
+}
+
+std::optional<std::chrono::nanoseconds>
+weatherer::util::RequestScheduler::GetRetryDelay(const std::string_view host,
+                                                 cpr::Response const& response,
+                                                 const std::size_t attempt) {
+  const long status = response.status_code;
+  // A status code of 0 means the request never got a response.
+  const bool retryable = status == 0 || status == 429 || status >= 500;
+  const SchedulerPolicy policy = GetPolicy();
+  if (!retryable || attempt + 1 >= policy.max_attempts) {
+    return std::nullopt;
+  }
+
+  std::chrono::nanoseconds delay{};
+  if (const auto retry_after = GetRetryAfter(response)) {
+    if (policy.max_queue_wait && *retry_after > *policy.max_queue_wait) {
+      return std::nullopt;
+    }
+    delay = *retry_after;
+    if (status == 429 || status == 503) {
+      // Hold back every request to the host, not only this one.
+      std::lock_guard lock{mutex_};
+      Quota& quota = *GetHostState(host)->quota;
+      quota.paused_until = std::max(quota.paused_until,
+                                    std::chrono::steady_clock::now() + delay);
+    }
+  } else {
+    // Full jitter: spreading retries over the whole interval keeps clients
+    // that failed together from retrying together.
+    const std::chrono::nanoseconds ceiling = std::min<std::chrono::nanoseconds>(
+        policy.max_backoff, policy.base_backoff * (std::int64_t{1}
+                                                   << std::min<std::size_t>(attempt, 20)));
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    delay = std::chrono::nanoseconds{
+        std::uniform_int_distribution<std::int64_t>{0, ceiling.count()}(random)};
+  }
+
+  Metrics::GetCounter("weatherer_http_retries_total",
+                      "HTTP requests retried, by host and response status.",
+                      {{"host", std::string{host}},
+                       {"status", status != 0 ? std::to_string(status) : "error"}})
+      .Increment();
+  return delay;
+}
+
+std::size_t weatherer::util::RequestScheduler::GetQueueDepth(
+    const std::string_view host) {
+  std::shared_ptr<HostState> state{};
+  {
+    std::lock_guard lock{mutex_};
+    state = GetHostState(host);
+  }
+  return static_cast<std::size_t>(
+      std::max<std::int64_t>(state->queue_depth.GetValue(), 0));
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+namespace weatherer::util {
+/**
+ * @brief A limit on the number of requests sent to a host.
+ */
+struct RateLimit {
+  // At most this many requests are sent in any window of period.
+  std::size_t requests;
+  std::chrono::seconds period;
+  // The number of requests that may be sent back to back after an idle
+  // spell, or 0 for a tenth of requests. The steady rate is lowered by the
+  // same amount, so bursts never push a window over the limit.
+  std::size_t burst = 0;
+};
+
+/**
+ * @brief How requests are queued and retried.
+ */
+struct SchedulerPolicy {
+  // Attempts per request, including the first one.
+  std::size_t max_attempts = 5;
+  // Retry n waits a random time up to base_backoff * 2^n, capped at max_backoff.
+  std::chrono::milliseconds base_backoff{500};
+  std::chrono::milliseconds max_backoff{30'000};
+  // Longer waits for a slot, or for a Retry-After, fail instead of queueing.
+  // Unset, requests wait as long as the rate limit requires, which suits batch
+  // jobs; interactive servers set it (see server::QueryServer::Options).
+  std::optional<std::chrono::seconds> max_queue_wait{};
+};
+
+/**
+ * @brief A token bucket that hands out reservations instead of refusals.
+ *
+ * A reservation always takes a token, letting the balance go negative; the
+ * token it took becomes available once the bucket has refilled to cover it.
+ * Callers therefore queue in reservation order, and the bucket never runs
+ * ahead of its rate however many callers are waiting. Not thread-safe.
+ */
+class TokenBucket {
+ private:
+  double capacity_;
+  double tokens_per_second_;
+  double tokens_;
+  std::chrono::steady_clock::time_point updated_;
+
+ public:
+  explicit TokenBucket(RateLimit const& limit,
+                       std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief Takes a token.
+   * @param now The current time.
+   * @return The time at which the token is available; now if it already is.
+   */
+  [[nodiscard]] std::chrono::steady_clock::time_point Reserve(
+      std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief Returns a token taken by Reserve that will not be used.
+   */
+  void Cancel();
+};
+
+/**
+ * @brief Paces and retries the requests made through util::Http.
+ *
+ * Hosts that share a quota share a set of token buckets, one per rate limit.
+ * A request to a limited host waits, in order of arrival, until every bucket
+ * of its host grants it a token, so a batch runs just under the limit instead
+ * of failing on it. Responses with status 429 or 5xx, and failed connections,
+ * are retried after a jittered exponential backoff. A Retry-After header given
+ * in seconds takes its place, and on a 429 or 503 it also holds back every
+ * other request to the host until then. All member functions are safe to call
+ * concurrently.
+ *
+ * Open-Meteo's free-tier limits apply to its hosts by default.
+ */
+class RequestScheduler {
+ private:
+  struct Quota;
+  struct HostState;
+
+  static std::mutex mutex_;
+  static SchedulerPolicy policy_;
+  // Hosts sharing a quota map to the same one.
+  static std::map<std::string, std::shared_ptr<Quota>, std::less<>> quotas_;
+  static std::map<std::string, std::shared_ptr<HostState>, std::less<>> hosts_;
+
+  /**
+   * @throws std::invalid_argument if a limit allows no requests.
+   */
+  [[nodiscard]] static std::shared_ptr<Quota> MakeQuota(
+      std::vector<RateLimit> const& limits);
+
+  /**
+   * @brief Gets or creates the state of a host; requires mutex_ to be held.
+   */
+  [[nodiscard]] static std::shared_ptr<HostState> GetHostState(
+      std::string_view host);
+
+  /**
+   * @return The Retry-After of a response in seconds, if it has one.
+   */
+  [[nodiscard]] static std::optional<std::chrono::seconds> GetRetryAfter(
+      cpr::Response const& response);
+
+ public:
+  // Prevent instantiation of the RequestScheduler class.
+  RequestScheduler() = delete;
+  ~RequestScheduler() = delete;
+
+  /**
+   * @brief Sets the rate limits of a quota shared by one or more hosts.
+   * @param hosts The hosts drawing on the quota, e.g. api.open-meteo.com.
+   * @param limits The limits of the quota; empty to remove them.
+   */
+  static void SetLimits(std::vector<std::string> const& hosts,
+                        std::vector<RateLimit> const& limits);
+
+  static void SetPolicy(SchedulerPolicy const& policy);
+
+  [[nodiscard]] static SchedulerPolicy GetPolicy();
+
+  /**
+   * @brief Waits until a request may be sent to a host.
+   * @param host The host of the request.
+   * @return The time spent waiting.
+   * @throws std::runtime_error if the wait would exceed the maximum queue wait.
+   */
+  static std::chrono::nanoseconds Acquire(std::string_view host);
+
+  /**
+   * @brief Decides whether a response is retried, and after how long.
+   * @param host The host of the request.
+   * @param response The response of the attempt.
+   * @param attempt The zero-based number of the attempt.
+   * @return The delay before the next attempt, or std::nullopt to give up
+   * and return the response.
+   */
+  [[nodiscard]] static std::optional<std::chrono::nanoseconds> GetRetryDelay(
+      std::string_view host, cpr::Response const& response,
+      std::size_t attempt);
+
+  /**
+   * @return The number of requests waiting for a slot at a host.
+   */
+  [[nodiscard]] static std::size_t GetQueueDepth(std::string_view host);
+};
+}  // namespace weatherer::util
@@ -0,0 +1,157 @@
+#include "SeriesCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+static_assert(std::endian::native == std::endian::little,
+              "SeriesCodec stores its words in native little-endian order.");
+
+namespace {
+// Holds one group of up to 64 bit values plus slack for unaligned 8-byte accesses.
+using GroupBuffer = std::array<std::byte, 72>;
+
+std::uint64_t ZigZag(const std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+         static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t UnZigZag(const std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^
+         -static_cast<std::int64_t>(value & 1);
+}
+
+std::uint64_t LoadWord(const std::byte* data) {
+  std::uint64_t word{};
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+void StoreWord(std::byte* data, const std::uint64_t word) {
+  std::memcpy(data, &word, sizeof(word));
+}
+}  // namespace
+
+std::size_t weatherer::util::SeriesCodec::GetMaxEncodedSize(
+    const std::size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+  const std::size_t groups = (count - 1 + kGroupSize_ - 1) / kGroupSize_;
+  return kHeaderSize_ + groups * 64;
+}
+
+void weatherer::util::SeriesCodec::Encode(std::span<const double> values,
+                                          const double scale,
+                                          std::vector<std::byte>& out) {
+  if (values.empty()) {
+    return;
+  }
+
+  std::vector<std::uint64_t> deltas(values.size() - 1);
+  std::int64_t previous = 0;
+  std::uint64_t all_bits = 0;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const double scaled = values[i] * scale;
+    [[unlikely]] if (!std::isfinite(scaled) ||
+                     std::abs(scaled) > std::numeric_limits<std::int32_t>::max()) {
+      throw std::invalid_argument("Value cannot be encoded: " +
+                                  std::to_string(values[i]));
+    }
+    const std::int64_t quantized = std::llround(scaled);
+    if (i > 0) {
+      deltas[i - 1] = ZigZag(quantized - previous);
+      all_bits |= deltas[i - 1];
+    }
+    previous = quantized;
+  }
+  const auto width = static_cast<std::uint8_t>(std::bit_width(all_bits));
+  const auto first = static_cast<std::int32_t>(std::llround(values.front() * scale));
+
+  const std::size_t offset = out.size();
+  const std::size_t groups = (deltas.size() + kGroupSize_ - 1) / kGroupSize_;
+  out.resize(offset + kHeaderSize_ + groups * width);
+  out[offset] = static_cast<std::byte>(width);
+  std::memcpy(out.data() + offset + 1, &first, sizeof(first));
+
+  std::byte* group_out = out.data() + offset + kHeaderSize_;
+  for (std::size_t group = 0; group < groups; ++group) {
+    GroupBuffer buffer{};
+    for (std::size_t i = 0; i < kGroupSize_; ++i) {
+      const std::size_t index = group * kGroupSize_ + i;
+      if (index >= deltas.size()) {
+        break;
+      }
+      const std::size_t bit = i * width;
+      std::byte* word = buffer.data() + bit / 8;
+      StoreWord(word, LoadWord(word) | (deltas[index] << (bit % 8)));
+      // A 64 bit wide value shifted by up to 7 bits spills into the next word.
+      if (bit % 8 != 0 && width + bit % 8 > 64) {
+        word[8] |= static_cast<std::byte>(deltas[index] >> (64 - bit % 8));
+      }
+    }
+    std::memcpy(group_out, buffer.data(), width);
+    group_out += width;
+  }
+}
+
+std::size_t weatherer::util::SeriesCodec::Decode(std::span<const std::byte> in,
+                                                 const double scale,
+                                                 std::span<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  [[unlikely]] if (in.size() < kHeaderSize_) {
+    throw std::runtime_error("Truncated encoded series.");
+  }
+  const auto width = static_cast<std::size_t>(in[0]);
+  [[unlikely]] if (width > 64) {
+    throw std::runtime_error("Malformed encoded series.");
+  }
+  std::int32_t first{};
+  std::memcpy(&first, in.data() + 1, sizeof(first));
+
+  const std::size_t delta_count = values.size() - 1;
+  const std::size_t groups = (delta_count + kGroupSize_ - 1) / kGroupSize_;
+  const std::size_t size = kHeaderSize_ + groups * width;
+  [[unlikely]] if (in.size() < size) {
+    throw std::runtime_error("Truncated encoded series.");
+  }
+
+  const std::uint64_t mask =
+      width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+  const std::byte* group_in = in.data() + kHeaderSize_;
+  std::int64_t current = first;
+  values[0] = static_cast<double>(current) / scale;
+  for (std::size_t group = 0; group < groups; ++group) {
+    GroupBuffer buffer{};
+    std::memcpy(buffer.data(), group_in, width);
+    group_in += width;
+
+    // Unpack a whole group first; the eight extractions are independent.
+    std::array<std::int64_t, kGroupSize_> deltas{};
+    for (std::size_t i = 0; i < kGroupSize_; ++i) {
+      const std::size_t bit = i * width;
+      const std::byte* word = buffer.data() + bit / 8;
+      // The ninth byte only contributes to values spanning past the word;
+      // shifting in two steps keeps the shift in range when bit is aligned.
+      const std::uint64_t packed =
+          (LoadWord(word) >> (bit % 8)) |
+          ((static_cast<std::uint64_t>(word[8]) << 1) << (63 - bit % 8));
+      deltas[i] = UnZigZag(packed & mask);
+    }
+
+    const std::size_t count =
+        std::min(kGroupSize_, delta_count - group * kGroupSize_);
+    for (std::size_t i = 0; i < count; ++i) {
+      current += deltas[i];
+      values[group * kGroupSize_ + i + 1] = static_cast<double>(current) / scale;
+    }
+  }
+  return size;
+}
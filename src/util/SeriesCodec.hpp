@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace weatherer::util {
+/**
+ * @brief Compact fixed-precision encoding of numeric series.
+ *
+ * Weather series are reported at a fixed precision (whole W/m^2, 0.1 degrees
+ * Celsius, whole percent) and neighbouring hours are strongly correlated. A
+ * series is therefore quantized to integer multiples of 1 / scale, stored as
+ * its first value followed by the zig-zag encoded differences between
+ * neighbours, and the differences are bit-packed at the smallest width that
+ * holds all of them. A typical day of hourly values shrinks from 192 to
+ * 20-35 bytes. The encoding is lossy: decoding returns the quantized values,
+ * which equal the input only where it already was a multiple of 1 / scale.
+ *
+ * Layout: one width byte, the first value as a little-endian int32, then the
+ * differences in groups of eight, each group taking exactly width bytes. Fixed
+ * size groups let every value of a group be unpacked independently, without
+ * branching on the value or its position.
+ */
+class SeriesCodec {
+ private:
+  static constexpr std::size_t kGroupSize_ = 8;
+  static constexpr std::size_t kHeaderSize_ = 1 + sizeof(std::int32_t);
+
+ public:
+  // Prevent instantiation of the SeriesCodec class.
+  SeriesCodec() = delete;
+  ~SeriesCodec() = delete;
+
+  /**
+   * @param count The number of values in the series.
+   * @return An upper bound for the encoded size of the series.
+   */
+  [[nodiscard]] static std::size_t GetMaxEncodedSize(std::size_t count);
+
+  /**
+   * @brief Encodes a series and appends it to a buffer.
+   * @param values The series to encode.
+   * @param scale The number of quanta per unit; values are rounded to 1 / scale.
+   * @param out The buffer to append to.
+   * @throws std::invalid_argument if a value is not finite or does not fit
+   * in 32 bits once quantized.
+   */
+  static void Encode(std::span<const double> values, double scale,
+                     std::vector<std::byte>& out);
+
+  /**
+   * @brief Decodes a series produced by Encode.
+   * @param in The encoded bytes, starting at the series.
+   * @param scale The scale the series was encoded with.
+   * @param values Receives the decoded values; its size is the encoded count.
+   * @return The number of bytes consumed.
+   * @throws std::runtime_error if the input is truncated or malformed.
+   */
+  static std::size_t Decode(std::span<const std::byte> in, double scale,
+                            std::span<double> values);
+};
+}  // namespace weatherer::util
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace weatherer::util {
+/**
+ * @brief Coalesces concurrent calls that share the same key into one execution.
+ * @tparam Key_ The type used to identify identical requests.
+ * @tparam Ty_ The type of the shared result.
+ *
+ * The first caller for a given key runs the supplied function; every caller that
+ * arrives with the same key while that call is still in flight waits for it and
+ * receives a copy of the same result (or the same exception). Once the call
+ * completes the key is released, so later callers trigger a fresh execution.
+ * Results are therefore shared between overlapping callers only, not cached.
+ */
+template <typename Key_, typename Ty_>
+class SingleFlight {
+ private:
+  std::mutex mutex_;
+  std::unordered_map<Key_, std::shared_future<Ty_>> in_flight_;
+  std::atomic<std::size_t> executed_{0};
+  std::atomic<std::size_t> deduplicated_{0};
+
+ public:
+  SingleFlight() = default;
+  ~SingleFlight() = default;
+  SingleFlight(const SingleFlight& other) = delete;
+  SingleFlight& operator=(const SingleFlight& other) = delete;
+
+  /**
+   * @brief Runs fn for key, or joins an identical call that is already running.
+   * @param key The normalized request key.
+   * @param fn The callable producing the result; invoked at most once per flight.
+   * @return The result produced by the flight this caller joined.
+   * @throws Any exception thrown by fn, rethrown to every caller of the flight.
+   */
+  template <typename Fn_>
+  Ty_ Do(Key_ const& key, Fn_&& fn) {
+    std::promise<Ty_> promise{};
+    {
+      std::unique_lock lock{mutex_};
+      if (const auto it = in_flight_.find(key); it != in_flight_.end()) {
+        const std::shared_future<Ty_> flight = it->second;
+        lock.unlock();
+        deduplicated_.fetch_add(1, std::memory_order_relaxed);
+        return flight.get();
+      }
+      in_flight_.emplace(key, promise.get_future().share());
+    }
+
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    try {
+      Ty_ result = std::forward<Fn_>(fn)();
+      promise.set_value(result);
+      Release(key);
+      return result;
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+      Release(key);
+      throw;
+    }
+  }
+
+  /**
+   * @return The number of calls that actually executed their function.
+   */
+  [[nodiscard]] std::size_t GetExecutedCount() const {
+    return executed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @return The number of calls that joined an in-flight execution instead.
+   */
+  [[nodiscard]] std::size_t GetDeduplicatedCount() const {
+    return deduplicated_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Release(Key_ const& key) {
+    std::lock_guard lock{mutex_};
+    in_flight_.erase(key);
+  }
+};
+}  // namespace weatherer::util
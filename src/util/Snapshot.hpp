@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace weatherer::util {
+/**
+ * @brief Publishes immutable versions of a value to concurrent readers.
+ * @tparam Ty_ The type of the value; copied to build each new version.
+ *
+ * Readers load the current version and keep it alive for as long as they hold
+ * it. Loading is a single atomic operation, so readers never wait for a writer
+ * building a version, and never observe one while it is modified: versions are
+ * never modified once published. Writers build the next version off to the
+ * side, from a copy of the current one, and swap it in atomically. Concurrent
+ * writers retry on the version that won, so no update is lost.
+ */
+template <typename Ty_>
+class Snapshot {
+ private:
+  std::atomic<std::shared_ptr<const Ty_>> current_{};
+
+ public:
+  Snapshot() = default;
+  explicit Snapshot(std::shared_ptr<const Ty_> initial)
+      : current_(std::move(initial)) {}
+  ~Snapshot() = default;
+
+  // Copies share the current version, then evolve independently.
+  Snapshot(const Snapshot& other) : current_(other.Load()) {}
+  Snapshot(Snapshot&& other) noexcept
+      : current_(other.current_.exchange(nullptr, std::memory_order_acq_rel)) {}
+
+  Snapshot& operator=(const Snapshot& other) {
+    if (this != &other) {
+      Publish(other.Load());
+    }
+    return *this;
+  }
+
+  Snapshot& operator=(Snapshot&& other) noexcept {
+    if (this != &other) {
+      Publish(other.current_.exchange(nullptr, std::memory_order_acq_rel));
+    }
+    return *this;
+  }
+
+  /**
+   * @return The current version, or nullptr if none was published.
+   */
+  [[nodiscard]] std::shared_ptr<const Ty_> Load() const {
+    return current_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Replaces the current version.
+   * @param next The new version, which must not be modified afterwards.
+   */
+  void Publish(std::shared_ptr<const Ty_> next) {
+    current_.store(std::move(next), std::memory_order_release);
+  }
+
+  /**
+   * @brief Publishes a modified copy of the current version.
+   * @param fn Modifies the copy; called again on the newer version if another
+   * writer publishes first, so it must not have other side effects.
+   * @return The version published.
+   *
+   * Without a current version, fn modifies a default-constructed value.
+   */
+  template <typename Fn_>
+  std::shared_ptr<const Ty_> Update(Fn_&& fn) {
+    std::shared_ptr<const Ty_> current = Load();
+    while (true) {
+      auto draft = current ? std::make_shared<Ty_>(*current)
+                           : std::make_shared<Ty_>();
+      fn(*draft);
+      std::shared_ptr<const Ty_> next = std::move(draft);
+      if (current_.compare_exchange_weak(current, next,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+        return next;
+      }
+    }
+  }
+};
+}  // namespace weatherer::util
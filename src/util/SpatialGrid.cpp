@@ -0,0 +1,39 @@
+#include "SpatialGrid.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+weatherer::util::SpatialGrid::SpatialGrid(const double resolution)
+    : resolution_(resolution) {
+  [[unlikely]] if (!(resolution_ > 0)) {
+    throw std::invalid_argument("Grid resolution must be greater than 0");
+  }
+}
+
+weatherer::util::GridCell weatherer::util::SpatialGrid::Snap(
+    Coordinates const& coords) const {
+  return GridCell{
+      static_cast<std::int32_t>(std::floor(coords.GetLatitude() / resolution_)),
+      static_cast<std::int32_t>(
+          std::floor(coords.GetLongitude() / resolution_))};
+}
+
+weatherer::Coordinates weatherer::util::SpatialGrid::GetCellCenter(
+    GridCell const& cell) const {
+  return Coordinates{(cell.lat_index + 0.5) * resolution_,
+                     (cell.lon_index + 0.5) * resolution_};
+}
+
+weatherer::Coordinates weatherer::util::SpatialGrid::SnapToCenter(
+    Coordinates const& coords) const {
+  return GetCellCenter(Snap(coords));
+}
+
+weatherer::util::SiteClusters weatherer::util::SpatialGrid::Cluster(
+    std::span<const Coordinates> sites) const {
+  SiteClusters clusters{};
+  for (std::size_t i = 0; i < sites.size(); ++i) {
+    clusters[Snap(sites[i])].push_back(i);
+  }
+  return clusters;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "api/models/Coordinates.hpp"
+
+namespace weatherer::util {
+/**
+ * @brief Identifies a single cell of a regular latitude/longitude grid.
+ */
+struct GridCell {
+  std::int32_t lat_index;
+  std::int32_t lon_index;
+
+  bool operator==(const GridCell& rhs) const = default;
+};
+
+struct GridCellHash {
+  std::size_t operator()(const GridCell& cell) const noexcept {
+    return std::hash<std::uint64_t>{}(
+        (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.lat_index))
+         << 32) |
+        static_cast<std::uint32_t>(cell.lon_index));
+  }
+};
+
+using SiteClusters =
+    std::unordered_map<GridCell, std::vector<std::size_t>, GridCellHash>;
+
+/**
+ * @brief Snaps coordinates onto a regular grid approximating a weather model grid.
+ *
+ * Open-Meteo resolves every request to the nearest cell of the underlying weather
+ * model (roughly 1-11 km depending on the model), so sites that fall inside the
+ * same cell receive the same series. The SpatialGrid maps coordinates onto cells
+ * of a fixed angular resolution, allowing such sites to share a single request
+ * whose location is the cell center.
+ */
+class SpatialGrid {
+ private:
+  double resolution_;
+
+ public:
+  /**
+   * @brief Default cell size in degrees (~11 km), matching the coarsest
+   * forecast models used by Open-Meteo.
+   */
+  static constexpr double kDefaultResolution = 0.1;
+
+  /**
+   * @param resolution The cell size in degrees.
+   * @throws std::invalid_argument if the resolution is not strictly positive.
+   */
+  explicit SpatialGrid(double resolution = kDefaultResolution);
+
+  /**
+   * @brief Finds the grid cell containing the specified coordinates.
+   * @param coords The coordinates to snap.
+   * @return The containing grid cell.
+   */
+  [[nodiscard]] GridCell Snap(Coordinates const& coords) const;
+
+  /**
+   * @brief Gets the center of a grid cell.
+   * @param cell The grid cell.
+   * @return The coordinates of the cell center.
+   */
+  [[nodiscard]] Coordinates GetCellCenter(GridCell const& cell) const;
+
+  /**
+   * @brief Snaps coordinates to the center of their containing cell.
+   * @param coords The coordinates to snap.
+   * @return The coordinates of the containing cell's center.
+   */
+  [[nodiscard]] Coordinates SnapToCenter(Coordinates const& coords) const;
+
+  /**
+   * @brief Groups sites by the grid cell they fall into.
+   * @param sites The site coordinates.
+   * @return A map from grid cell to the indices (into sites) of its members.
+   */
+  [[nodiscard]] SiteClusters Cluster(std::span<const Coordinates> sites) const;
+
+  [[nodiscard]] double GetResolution() const { return resolution_; }
+};
+}  // namespace weatherer::util
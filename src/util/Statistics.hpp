@@ -1,18 +1,244 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
 #include <numeric>
 #include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace weatherer::util {
+/**
+ * @brief Reductions over contiguous series.
+ *
+ * The reductions keep kLanes independent accumulators, which lets the compiler
+ * vectorize them without relaxing floating point semantics (no -ffast-math or
+ * /fp:fast needed). Results may differ from a strictly sequential sum in the
+ * last bits. Series must not contain NaN.
+ */
 class Statistics {
-public:
+ private:
+  static constexpr std::size_t kLanes = 8;
+
+ public:
   Statistics() = delete;
   ~Statistics() = delete;
 
+  template <typename Ty_, size_t Amt_,
+            typename = std::enable_if<std::is_arithmetic_v<Ty_>>>
+  [[nodiscard]] static constexpr double Sum(std::span<Ty_, Amt_> data) {
+    std::array<double, kLanes> lanes{};
+    const std::size_t blocked = data.size() - data.size() % kLanes;
+    for (std::size_t i = 0; i < blocked; i += kLanes) {
+      for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        lanes[lane] += static_cast<double>(data[i + lane]);
+      }
+    }
+    for (std::size_t i = blocked; i < data.size(); ++i) {
+      lanes[i - blocked] += static_cast<double>(data[i]);
+    }
+    return std::accumulate(lanes.begin(), lanes.end(), 0.0);
+  }
+
   template <typename Ty_, size_t Amt_,
             typename = std::enable_if<std::is_arithmetic_v<Ty_>>>
   [[nodiscard]] static constexpr double Mean(std::span<Ty_, Amt_> data) {
-    return std::accumulate(data.begin(), data.end(), 0.0) / data.size();
+    return Sum(data) / data.size();
+  }
+
+  /**
+   * @throws std::invalid_argument if data is empty.
+   */
+  template <typename Ty_, size_t Amt_,
+            typename = std::enable_if<std::is_arithmetic_v<Ty_>>>
+  [[nodiscard]] static constexpr std::remove_cv_t<Ty_> Min(
+      std::span<Ty_, Amt_> data) {
+    return Reduce(data, [](auto lhs, auto rhs) { return rhs < lhs ? rhs : lhs; });
+  }
+
+  /**
+   * @throws std::invalid_argument if data is empty.
+   */
+  template <typename Ty_, size_t Amt_,
+            typename = std::enable_if<std::is_arithmetic_v<Ty_>>>
+  [[nodiscard]] static constexpr std::remove_cv_t<Ty_> Max(
+      std::span<Ty_, Amt_> data) {
+    return Reduce(data, [](auto lhs, auto rhs) { return lhs < rhs ? rhs : lhs; });
+  }
+
+  /**
+   * @brief Minimum of every window of consecutive values, in O(n).
+   * @param data The series.
+   * @param window The number of values per window.
+   * @return Element i is the minimum of data[i, i + window); empty if the
+   * series is shorter than one window.
+   * @throws std::invalid_argument if window is zero.
+   *
+   * Keeps a monotonic queue of candidate indices, so every value is pushed
+   * and popped at most once whatever the window size.
+   */
+  template <typename Ty_, size_t Amt_,
+            typename = std::enable_if<std::is_arithmetic_v<Ty_>>>
+  [[nodiscard]] static std::vector<std::remove_cv_t<Ty_>> SlidingMin(
+      std::span<Ty_, Amt_> data, const std::size_t window) {
+    [[unlikely]] if (window == 0) {
+      throw std::invalid_argument("Sliding window must not be empty");
+    }
+    if (data.size() < window) {
+      return {};
+    }
+    std::vector<std::remove_cv_t<Ty_>> minima(data.size() - window + 1);
+    // candidates[head, tail) holds indices whose values increase strictly.
+    std::vector<std::size_t> candidates(data.size());
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      while (tail > head && !(data[candidates[tail - 1]] < data[i])) {
+        --tail;
+      }
+      candidates[tail++] = i;
+      if (candidates[head] + window <= i) {
+        ++head;
+      }
+      if (i + 1 >= window) {
+        minima[i + 1 - window] = data[candidates[head]];
+      }
+    }
+    return minima;
+  }
+
+  /**
+   * @brief Interpolates a quantile linearly between the closest ranks.
+   * @param sorted The series, in ascending order.
+   * @param quantile Between 0 (the minimum) and 1 (the maximum).
+   * @return The quantile of the series.
+   * @throws std::invalid_argument if sorted is empty or quantile is out of range.
+   */
+  [[nodiscard]] static double SortedQuantile(std::span<const double> sorted,
+                                             const double quantile) {
+    [[unlikely]] if (sorted.empty()) {
+      throw std::invalid_argument("Quantile of an empty series");
+    }
+    [[unlikely]] if (!(quantile >= 0 && quantile <= 1)) {
+      throw std::invalid_argument("Quantile must be between 0 and 1");
+    }
+    const double rank = quantile * static_cast<double>(sorted.size() - 1);
+    const auto lower = static_cast<std::size_t>(rank);
+    if (lower + 1 >= sorted.size()) {
+      return sorted.back();
+    }
+    const double fraction = rank - static_cast<double>(lower);
+    return sorted[lower] + fraction * (sorted[lower + 1] - sorted[lower]);
+  }
+
+ private:
+  // Folds data with a commutative, associative and idempotent operation.
+  template <typename Ty_, size_t Amt_, typename Op_>
+  [[nodiscard]] static constexpr std::remove_cv_t<Ty_> Reduce(
+      std::span<Ty_, Amt_> data, Op_ op) {
+    [[unlikely]] if (data.empty()) {
+      throw std::invalid_argument("Cannot reduce an empty series");
+    }
+    using Value = std::remove_cv_t<Ty_>;
+    if (data.size() < kLanes) {
+      return std::accumulate(data.begin() + 1, data.end(), data.front(), op);
+    }
+    std::array<Value, kLanes> lanes{};
+    std::copy_n(data.begin(), kLanes, lanes.begin());
+    const std::size_t blocked = data.size() - data.size() % kLanes;
+    for (std::size_t i = kLanes; i < blocked; i += kLanes) {
+      for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        lanes[lane] = op(lanes[lane], data[i + lane]);
+      }
+    }
+    // Idempotence makes overlapping the tail with the last block harmless.
+    for (std::size_t i = blocked; i < data.size(); ++i) {
+      lanes[i - blocked] = op(lanes[i - blocked], data[i]);
+    }
+    return std::accumulate(lanes.begin() + 1, lanes.end(), lanes.front(), op);
+  }
+};
+
+/**
+ * @brief Streaming count, mean, variance, minimum and maximum (Welford).
+ *
+ * Partial results computed on separate threads or shards combine exactly with
+ * Merge (Chan et al.), so a series can be split arbitrarily and reduced in
+ * parallel.
+ */
+class RunningMoments {
+ private:
+  std::size_t count_ = 0;
+  double mean_ = 0;
+  // Sum of squared differences from the mean.
+  double m2_ = 0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+
+ public:
+  void Add(const double value) {
+    ++count_;
+    const double delta = value - mean_;
+    mean_ += delta / static_cast<double>(count_);
+    m2_ += delta * (value - mean_);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  template <typename Ty_, size_t Amt_>
+  void Add(std::span<Ty_, Amt_> values) {
+    for (const auto value : values) {
+      Add(static_cast<double>(value));
+    }
+  }
+
+  /**
+   * @brief Combines the moments of another, disjoint part of the series.
+   * @param other The moments of the other part.
+   */
+  void Merge(RunningMoments const& other) {
+    if (other.count_ == 0) {
+      return;
+    }
+    if (count_ == 0) {
+      *this = other;
+      return;
+    }
+    const auto count = static_cast<double>(count_);
+    const auto other_count = static_cast<double>(other.count_);
+    const double total = count + other_count;
+    const double delta = other.mean_ - mean_;
+    mean_ += delta * other_count / total;
+    m2_ += other.m2_ + delta * delta * count * other_count / total;
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  [[nodiscard]] std::size_t GetCount() const { return count_; }
+  [[nodiscard]] double GetMean() const { return mean_; }
+  [[nodiscard]] double GetMin() const { return min_; }
+  [[nodiscard]] double GetMax() const { return max_; }
+
+  /**
+   * @return The population variance, or 0 for fewer than two values.
+   */
+  [[nodiscard]] double GetVariance() const {
+    return count_ < 2 ? 0.0 : m2_ / static_cast<double>(count_);
+  }
+
+  /**
+   * @return The unbiased sample variance, or 0 for fewer than two values.
+   */
+  [[nodiscard]] double GetSampleVariance() const {
+    return count_ < 2 ? 0.0 : m2_ / static_cast<double>(count_ - 1);
+  }
+
+  [[nodiscard]] double GetStandardDeviation() const {
+    return std::sqrt(GetVariance());
   }
 };
 }  // namespace weatherer::util
@@ -0,0 +1,26 @@
+#include "StringPool.hpp"
+
+#include <mutex>
+
+std::shared_mutex weatherer::util::StringPool::mutex_{};
+
+std::unordered_set<std::string, weatherer::util::StringPool::Hash,
+                   std::equal_to<>>
+    weatherer::util::StringPool::strings_{};
+
+std::string_view weatherer::util::StringPool::Intern(
+    const std::string_view str) {
+  {
+    std::shared_lock lock{mutex_};
+    if (const auto it = strings_.find(str); it != strings_.end()) {
+      return *it;
+    }
+  }
+  std::unique_lock lock{mutex_};
+  return *strings_.emplace(str).first;
+}
+
+std::size_t weatherer::util::StringPool::GetSize() {
+  std::shared_lock lock{mutex_};
+  return strings_.size();
+}
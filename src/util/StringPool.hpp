@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace weatherer::util {
+/**
+ * @brief A process-wide pool of interned, immutable strings.
+ *
+ * Interning a string stores one copy of it for the lifetime of the process and
+ * returns a view of that copy; interning equal text again returns the same
+ * view without allocating. Objects built for every request can therefore hold
+ * views of recurring text, such as crop names, instead of owning copies. All
+ * member functions are safe to call concurrently.
+ */
+class StringPool {
+ private:
+  struct Hash {
+    using is_transparent = void;
+    [[nodiscard]] std::size_t operator()(const std::string_view str) const {
+      return std::hash<std::string_view>{}(str);
+    }
+  };
+
+  static std::shared_mutex mutex_;
+  // Node-based, so interned strings never move once inserted.
+  static std::unordered_set<std::string, Hash, std::equal_to<>> strings_;
+
+ public:
+  // Prevent instantiation of the StringPool class.
+  StringPool() = delete;
+  ~StringPool() = delete;
+
+  /**
+   * @brief Interns a string.
+   * @param str The text to intern.
+   * @return A view of the pooled copy of str, valid for the lifetime of the
+   * process.
+   */
+  [[nodiscard]] static std::string_view Intern(std::string_view str);
+
+  /**
+   * @return The number of distinct strings in the pool.
+   */
+  [[nodiscard]] static std::size_t GetSize();
+};
+}  // namespace weatherer::util
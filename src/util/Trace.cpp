@@ -0,0 +1,63 @@
+#include "Trace.hpp"
+
+#include <nlohmann/json.hpp>
+
+std::atomic<bool> weatherer::util::Tracer::enabled_{false};
+std::mutex weatherer::util::Tracer::buffers_mutex_{};
+std::vector<std::shared_ptr<weatherer::util::Tracer::ThreadBuffer>>
+    weatherer::util::Tracer::buffers_{};
+
+weatherer::util::Tracer::ThreadBuffer&
+weatherer::util::Tracer::GetThreadBuffer() {
+  // Buffers are shared with the registry so spans outlive their threads.
+  thread_local const std::shared_ptr<ThreadBuffer> buffer = [] {
+    auto created = std::make_shared<ThreadBuffer>();
+    std::lock_guard lock{buffers_mutex_};
+    created->thread_id = static_cast<std::uint32_t>(buffers_.size() + 1);
+    buffers_.push_back(created);
+    return created;
+  }();
+  return *buffer;
+}
+
+void weatherer::util::Tracer::Record(TraceEvent event) {
+  ThreadBuffer& buffer = GetThreadBuffer();
+  event.thread_id = buffer.thread_id;
+  // Only contended while the trace is being written.
+  std::lock_guard lock{buffer.mutex};
+  buffer.events.push_back(std::move(event));
+}
+
+void weatherer::util::Tracer::WriteChromeTrace(std::ostream& os) {
+  using Json = nlohmann::json;
+
+  Json events = Json::array();
+  std::lock_guard registry_lock{buffers_mutex_};
+  for (auto const& buffer : buffers_) {
+    std::lock_guard lock{buffer->mutex};
+    for (TraceEvent const& event : buffer->events) {
+      Json args = Json::object();
+      for (auto const& [key, value] : event.tags) {
+        args[std::string{key}] = value;
+      }
+      events.push_back(Json{{"name", event.name},
+                            {"cat", "weatherer"},
+                            {"ph", "X"},
+                            {"ts", event.start_us},
+                            {"dur", event.duration_us},
+                            {"pid", 1},
+                            {"tid", event.thread_id},
+                            {"args", std::move(args)}});
+    }
+  }
+  os << Json{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}}
+            .dump();
+}
+
+void weatherer::util::Tracer::Clear() {
+  std::lock_guard registry_lock{buffers_mutex_};
+  for (auto const& buffer : buffers_) {
+    std::lock_guard lock{buffer->mutex};
+    buffer->events.clear();
+  }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace weatherer::util {
+/**
+ * @brief A completed span, as recorded by a TraceSpan.
+ */
+struct TraceEvent {
+  // Span names are string literals, so only a pointer is stored.
+  const char* name;
+  std::vector<std::pair<std::string_view, std::string>> tags;
+  std::int64_t start_us;
+  std::int64_t duration_us;
+  std::uint32_t thread_id;
+};
+
+/**
+ * @brief Process-wide collector of trace spans.
+ *
+ * Spans are buffered per thread and only merged when the trace is written, so
+ * recording never contends with other threads. While tracing is disabled a span
+ * costs a single relaxed atomic load. The trace is written in the Chrome
+ * trace-event format, which chrome://tracing and https://ui.perfetto.dev open.
+ */
+class Tracer {
+ private:
+  struct ThreadBuffer {
+    std::uint32_t thread_id;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+  };
+
+  static std::atomic<bool> enabled_;
+  static std::mutex buffers_mutex_;
+  static std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  /**
+   * @return The buffer of the calling thread, registering it on first use.
+   */
+  static ThreadBuffer& GetThreadBuffer();
+
+ public:
+  // Prevent instantiation of the Tracer class.
+  Tracer() = delete;
+  ~Tracer() = delete;
+
+  static void Enable() { enabled_.store(true, std::memory_order_relaxed); }
+
+  static void Disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+  [[nodiscard]] static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @return Microseconds on a monotonic clock, the time base of every span.
+   */
+  [[nodiscard]] static std::int64_t NowMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /**
+   * @brief Appends a completed span to the calling thread's buffer.
+   * @param event The completed span.
+   */
+  static void Record(TraceEvent event);
+
+  /**
+   * @brief Writes every recorded span as Chrome trace-event JSON.
+   * @param os The output stream to write to.
+   */
+  static void WriteChromeTrace(std::ostream& os);
+
+  /**
+   * @brief Discards every recorded span.
+   */
+  static void Clear();
+};
+
+/**
+ * @brief Records the lifetime of a scope as a span, when tracing is enabled.
+ *
+ * Usage: TraceSpan span{"PvDataProcessor::IngestData"}; span.AddTag("site", ...);
+ */
+class TraceSpan {
+ private:
+  const char* name_;
+  bool active_;
+  std::int64_t start_us_ = 0;
+  std::vector<std::pair<std::string_view, std::string>> tags_{};
+
+ public:
+  explicit TraceSpan(const char* name)
+      : name_(name), active_(Tracer::IsEnabled()) {
+    if (active_) {
+      start_us_ = Tracer::NowMicroseconds();
+    }
+  }
+
+  ~TraceSpan() {
+    if (active_) {
+      Tracer::Record(TraceEvent{name_, std::move(tags_), start_us_,
+                                Tracer::NowMicroseconds() - start_us_, 0});
+    }
+  }
+
+  TraceSpan(const TraceSpan& other) = delete;
+  TraceSpan& operator=(const TraceSpan& other) = delete;
+
+  /**
+   * @brief Attaches a key/value pair to the span, e.g. the site or request.
+   * @param key The tag name; must be a string literal.
+   * @param value The tag value.
+   */
+  void AddTag(const std::string_view key, std::string value) {
+    if (active_) {
+      tags_.emplace_back(key, std::move(value));
+    }
+  }
+
+  [[nodiscard]] bool IsActive() const { return active_; }
+};
+}  // namespace weatherer::util